@@ -45,6 +45,18 @@ Requires:   qt5-plugin-platform-offscreen
 %description label-tool
 %{summary}.
 
+%package wordgraph-tool
+Summary:    Word prediction graph compiler for minui.
+
+%description wordgraph-tool
+%{summary}.
+
+%package blit-benchmark
+Summary:    Image blit benchmark for minui.
+
+%description blit-benchmark
+%{summary}.
+
 %prep
 %setup -q -n %{name}-%{version}
 
@@ -88,6 +100,16 @@ touch %{buildroot}%{_datadir}/%{name}/images/default
 %{_bindir}/sailfish-minui-label-tool
 %{_datadir}/qt5/mkspecs/features/sailfish-minui-resources.prf
 
+%files wordgraph-tool
+%defattr(-,root,root,-)
+%license LICENSE.BSD
+%{_bindir}/sailfish-minui-wordgraph-tool
+
+%files blit-benchmark
+%defattr(-,root,root,-)
+%license LICENSE.BSD
+%{_bindir}/sailfish-minui-blit-benchmark
+
 %package gallery
 Summary:    Preview application for Sailfish MinUI toolkit components
 Requires:   %{name}-gallery-resources
@@ -120,9 +142,7 @@ Provides:   %{name}-resources \
 %{_datadir}/%{name}/images/%{-z*}/icon-m-shift-caps.png \
 %{_datadir}/%{name}/images/%{-z*}/icon-m-accept.png \
 %{_datadir}/%{name}/images/%{-z*}/icon-m-cancel.png \
-%{_datadir}/%{name}/images/%{-z*}/icon-m-spacebar-left.png \
-%{_datadir}/%{name}/images/%{-z*}/icon-m-spacebar-middle.png \
-%{_datadir}/%{name}/images/%{-z*}/icon-m-spacebar-right.png \
+%{_datadir}/%{name}/images/%{-z*}/icon-m-spacebar.png \
 %{_datadir}/%{name}/images/%{-z*}/icon-splus-hide-password.png \
 %{_datadir}/%{name}/images/%{-z*}/icon-splus-show-password.png \
 %{_datadir}/%{name}/images/%{-z*}/graphic-busyindicator-medium-*.png \
@@ -191,9 +191,9 @@ protected:
     {
         bool enabled;
         if (m_passwordField.hasActiveInputFocus()) {
-            enabled = m_passwordField.text().length() > 0;
+            enabled = m_passwordField.length() > 0;
         } else {
-            enabled = m_textField.text().length() > 0;
+            enabled = m_textField.length() > 0;
         }
         m_keypad.setAcceptEnabled(enabled);
         m_keyboard.setEnterEnabled(enabled);
@@ -43,6 +43,7 @@
 
 #include <functional>
 #include <string>
+#include <tuple>
 #include <utility>
 
 namespace Sailfish { namespace MinDBus {
@@ -121,6 +122,25 @@ bool demarshallArguments(DBusMessageIter *iterator, Argument &argument, Argument
     }
 }
 
+template <std::size_t Index = 0, typename... Types>
+inline typename std::enable_if<Index == sizeof...(Types), bool>::type demarshallTuple(
+        DBusMessageIter *, std::tuple<Types...> &)
+{
+    return true;
+}
+
+template <std::size_t Index = 0, typename... Types>
+inline typename std::enable_if<Index < sizeof...(Types), bool>::type demarshallTuple(
+        DBusMessageIter *iterator, std::tuple<Types...> &tuple)
+{
+    if (demarshall(iterator, std::get<Index>(tuple))) {
+        dbus_message_iter_next(iterator);
+        return demarshallTuple<Index + 1>(iterator, tuple);
+    } else {
+        return false;
+    }
+}
+
 inline void invoke(DBusMessage *, const std::function<void()> &handler)
 {
     handler();
@@ -65,6 +65,8 @@ private:
     int m_ref = 2;
 };
 
+template <typename... Arguments> class PendingReply;
+
 template <typename... Arguments> class PendingCall : public AbstractPendingCall
 {
 public:
@@ -83,6 +85,11 @@ public:
 protected:
     void notify(DBusMessage *message) override
     {
+        if (m_awaiter) {
+            m_awaiter->finish(message);
+            return;
+        }
+
         switch (dbus_message_get_type(message)) {
         case DBUS_MESSAGE_TYPE_METHOD_RETURN:
             if (m_finished) {
@@ -102,10 +109,122 @@ protected:
     }
 
 private:
+    friend class PendingReply<Arguments...>;
+
     std::function<void(Arguments...)> m_finished;
     std::function<void(const char *name, const char *message)> m_error;
+    PendingReply<Arguments...> *m_awaiter = nullptr;
 };
 
+/*
+    The result of awaiting a method call from a coroutine.
+
+    The reply message is retained for the lifetime of the reply so string arguments and error
+    descriptions remain valid for as long as the reply does.
+*/
+template <typename... Arguments> struct Reply
+{
+    Message message;
+    std::tuple<typename std::decay<Arguments>::type...> arguments;
+    const char *errorName = nullptr;
+    const char *errorMessage = nullptr;
+
+    bool isError() const { return errorName; }
+};
+
+/*
+    An awaiter for a PendingCall.
+
+    The coroutine is resumed directly from the pending call notification with a Reply holding
+    either the demarshalled return values or the error name and message.  If the awaiter is
+    destroyed before a reply arrives the call is canceled.
+*/
+template <typename... Arguments> class PendingReply
+{
+public:
+    explicit PendingReply(PendingCall<Arguments...> *call) : m_call(call)
+    {
+        if (!m_call) {
+            m_reply.errorName = DBUS_ERROR_FAILED;
+            m_reply.errorMessage = "The method call could not be sent";
+        }
+    }
+
+    PendingReply(PendingReply &&reply) : m_call(reply.m_call), m_reply(reply.m_reply)
+    {
+        reply.m_call = nullptr;
+    }
+
+    ~PendingReply()
+    {
+        if (m_call) {
+            m_call->m_awaiter = nullptr;
+            m_call->cancel();
+        }
+    }
+
+    bool await_ready() const { return !m_call; }
+
+    template <typename Handle> void await_suspend(Handle handle)
+    {
+        m_continuation = handle.address();
+        m_resume = &resume<Handle>;
+        m_call->m_awaiter = this;
+    }
+
+    Reply<Arguments...> await_resume() { return m_reply; }
+
+private:
+    friend class PendingCall<Arguments...>;
+
+    template <typename Handle> static void resume(void *address) { Handle::from_address(address).resume(); }
+
+    void finish(DBusMessage *message)
+    {
+        m_call = nullptr;
+        m_reply.message.reset(dbus_message_ref(message));
+
+        switch (dbus_message_get_type(message)) {
+        case DBUS_MESSAGE_TYPE_METHOD_RETURN: {
+            DBusMessageIter iterator;
+            if (!(dbus_message_iter_init(message, &iterator)
+                    ? demarshallTuple(&iterator, m_reply.arguments)
+                    : sizeof...(Arguments) == 0)) {
+                m_reply.errorName = DBUS_ERROR_INVALID_SIGNATURE;
+                m_reply.errorMessage = "The reply arguments do not match the expected signature";
+            }
+            break;
+        }
+        case DBUS_MESSAGE_TYPE_ERROR:
+            m_reply.errorName = dbus_message_get_error_name(message);
+            if (!dbus_message_get_args(message, nullptr, DBUS_TYPE_STRING, &m_reply.errorMessage, DBUS_TYPE_INVALID)) {
+                m_reply.errorMessage = "";
+            }
+            break;
+        default:
+            m_reply.errorName = DBUS_ERROR_FAILED;
+            m_reply.errorMessage = "Unexpected reply message type";
+            break;
+        }
+
+        m_resume(m_continuation);
+    }
+
+    PendingCall<Arguments...> *m_call;
+    Reply<Arguments...> m_reply;
+    void *m_continuation = nullptr;
+    void (*m_resume)(void *address) = nullptr;
+};
+
+/*
+    Returns an awaiter for a pending method \a call, this allows the result of Object::call() to
+    be awaited directly from a MinUi::Task coroutine.
+*/
+template <typename... Arguments> PendingReply<Arguments...> awaitable(PendingCall<Arguments...> *call)
+{
+    return PendingReply<Arguments...>(call);
+}
+
 }}
 
 #endif
@@ -0,0 +1,213 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include <sailfish-minui/surface.h>
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Sailfish::MinUi;
+
+namespace {
+
+int64_t elapsed(const timespec &start, const timespec &end)
+{
+    return ((end.tv_sec - start.tv_sec) * INT64_C(1000000000)) + (end.tv_nsec - start.tv_nsec);
+}
+
+template <typename Draw>
+void measure(const char *name, int frames, Draw draw)
+{
+    std::vector<int64_t> times;
+    for (int frame = 0; frame < frames; ++frame) {
+        timespec start;
+        timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        draw();
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        times.push_back(elapsed(start, end));
+    }
+
+    std::sort(times.begin(), times.end());
+
+    int64_t total = 0;
+    for (const int64_t time : times) {
+        total += time;
+    }
+
+    const auto percentile = [&times](int percent) {
+        return times[std::min(times.size() - 1, (times.size() * percent) / 100)];
+    };
+
+    printf("  %-12s mean %9.1f us, p50 %9.1f us, p99 %9.1f us\n",
+           name,
+           total / 1000.0 / times.size(),
+           percentile(50) / 1000.0,
+           percentile(99) / 1000.0);
+}
+
+/*
+    Times converting an opaque RGBX image the size of the screen to each framebuffer pixel
+    format, as Image does once when it is loaded.  For the format of the framebuffer it also
+    times drawing the image with blitRgb(), which converts every pixel as it is drawn, and with
+    blitSurface() after conversion.
+*/
+bool benchmark(int frames)
+{
+    const int width = gr_fb_width();
+    const int height = gr_fb_height();
+
+    gr_surface image = createSurface(width, height, 4);
+    if (!image) {
+        fprintf(stderr, "Failed to allocate a %dx%d image\n", width, height);
+        return false;
+    }
+    for (int i = 0; i < width * height * 4; ++i) {
+        image->data[i] = i % 4 == 3 ? 255 : (i * 2654435761u) >> 24;
+    }
+
+    static const PixelFormat formats[] = {
+        PixelFormat::RGBX8888,
+        PixelFormat::BGRA8888,
+        PixelFormat::ABGR8888,
+        PixelFormat::RGB565
+    };
+
+    const PixelFormat framebufferFormat = nativePixelFormat();
+    printf("%dx%d, %d frames, framebuffer %s\n",
+           width, height, frames, pixelFormatName(framebufferFormat));
+
+    setClipRect({ 0, 0, width, height });
+
+    for (const PixelFormat format : formats) {
+        printf("%s\n", pixelFormatName(format));
+
+        measure("convert", frames, [&]() {
+            res_free_surface(convertSurface(image, format, false));
+        });
+
+        if (format == framebufferFormat) {
+            gr_surface native = convertSurface(image, format, false);
+
+            measure("blitRgb", frames, [&]() {
+                blitRgb(image, 0, 0, width, height, 0, 0);
+            });
+            measure("blitSurface", frames, [&]() {
+                blitSurface(native, 0, 0, width, height, 0, 0);
+            });
+
+            res_free_surface(native);
+        }
+    }
+
+    if (framebufferFormat == PixelFormat::Unknown) {
+        printf("The framebuffer pixel format is unknown, set SAILFISH_MINUI_PIXEL_FORMAT to time\n"
+               "blitRgb() and blitSurface().\n");
+    }
+
+    res_free_surface(image);
+
+    return true;
+}
+
+void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "\n"
+            "Times converting a screen sized image to each framebuffer pixel format, and\n"
+            "compares drawing it with gr_blit_rgb(), converting its pixels as they are\n"
+            "drawn, against gr_blit() of the image converted to the framebuffer pixel\n"
+            "format when it was loaded.  The images are drawn to the back buffer, which is\n"
+            "never flipped to the display.\n"
+            "\n"
+            "Options:\n"
+            "  -f, --frames COUNT  The number of frames to time.  The default is 100.\n"
+            "  -h, --help          Show this help.\n",
+            name);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    static const option options[] = {
+        { "frames", required_argument, nullptr, 'f' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    int frames = 100;
+
+    for (int option; (option = getopt_long(argc, argv, "f:h", options, nullptr)) != -1;) {
+        switch (option) {
+        case 'f':
+            frames = atoi(optarg);
+            if (frames <= 0) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            break;
+        case 'h':
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind != argc) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (gr_init() < 0) {
+        fprintf(stderr, "Failed to initialize graphics\n");
+        return EXIT_FAILURE;
+    }
+
+    const bool result = benchmark(frames);
+
+    gr_exit();
+
+    return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,26 @@
+TEMPLATE = app
+TARGET = sailfish-minui-blit-benchmark
+
+include ($$PWD/../../sailfish-minui-common.pri)
+
+CONFIG -= qt
+CONFIG += c++11
+
+DESTDIR = $$SAILFISH_BUILD_ROOT/bin
+
+SOURCES += \
+    main.cpp
+
+# The benchmark times internal drawing functions of the library, so it includes the private
+# headers from the source tree on the include path of sailfish-minui-common.pri and links the
+# static library rather than using the installed headers.
+LIBS += \
+    -L$$SAILFISH_BUILD_ROOT/lib -lsailfish-minui \
+    -lpthread
+
+PKGCONFIG += minui
+
+target.path = /usr/bin
+
+INSTALLS += \
+    target
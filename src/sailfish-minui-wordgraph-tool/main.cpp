@@ -0,0 +1,356 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include <sailfish-minui/wordgraph.h>
+#include <sailfish-minui/wordpredictor.h>
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Sailfish::MinUi;
+
+namespace {
+
+enum {
+    WeightLevels = 255
+};
+
+struct Word
+{
+    std::string text;
+    uint64_t weight;
+};
+
+struct TrieNode
+{
+    std::map<uint8_t, int> children;
+    uint32_t weight = 0;
+};
+
+// A node of the minimized graph is identified by its weight and its labelled edges to
+// other minimized nodes.
+typedef std::pair<uint32_t, std::vector<std::pair<uint8_t, uint32_t>>> Signature;
+
+struct Compiler
+{
+    std::vector<TrieNode> trie;
+    std::map<Signature, uint32_t> signatures;
+    std::vector<WordGraphNode> nodes;
+    std::vector<WordGraphEdge> edges;
+
+    uint32_t minimize(int index)
+    {
+        Signature signature;
+        signature.first = trie[index].weight;
+        for (const auto &child : trie[index].children) {
+            signature.second.emplace_back(child.first, minimize(child.second));
+        }
+
+        const auto it = signatures.find(signature);
+        if (it != signatures.end()) {
+            return it->second;
+        }
+
+        WordGraphNode node;
+        node.firstEdge = edges.size();
+        node.edgeCount = signature.second.size();
+        node.weight = signature.first;
+        node.maximumWeight = signature.first;
+        for (const auto &edge : signature.second) {
+            edges.push_back({ edge.second, edge.first, { 0, 0, 0 } });
+            node.maximumWeight = std::max(node.maximumWeight, nodes[edge.second].maximumWeight);
+        }
+
+        const uint32_t id = nodes.size();
+        nodes.push_back(node);
+        signatures.emplace(std::move(signature), id);
+        return id;
+    }
+};
+
+bool readWords(const char *path, std::vector<Word> *words)
+{
+    FILE * const file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Failed to open %s\n", path);
+        return false;
+    }
+
+    std::map<std::string, uint64_t> counts;
+    std::vector<std::string> order;
+    bool counted = false;
+
+    char line[1024];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file)) {
+        ++lineNumber;
+
+        char *save = nullptr;
+        const char * const text = strtok_r(line, " \t\r\n", &save);
+        if (!text || text[0] == '#') {
+            continue;
+        }
+
+        std::string word(text);
+        if (word.size() > WordPredictor::MaximumWordLength) {
+            fprintf(stderr, "%s:%d: ignoring over long word %s\n", path, lineNumber, text);
+            continue;
+        }
+        for (char &character : word) {
+            if (character >= 'A' && character <= 'Z') {
+                character = character - 'A' + 'a';
+            }
+        }
+
+        uint64_t count = 0;
+        if (const char * const field = strtok_r(nullptr, " \t\r\n", &save)) {
+            char *end = nullptr;
+            count = strtoull(field, &end, 10);
+            if (*end != '\0' || count == 0) {
+                fprintf(stderr, "%s:%d: invalid count %s\n", path, lineNumber, field);
+                fclose(file);
+                return false;
+            }
+            counted = true;
+        }
+
+        const auto it = counts.find(word);
+        if (it == counts.end()) {
+            order.push_back(word);
+            counts.emplace(word, count);
+        } else {
+            it->second += count;
+        }
+    }
+    fclose(file);
+
+    // Without counts the list is taken to be ordered from the most to the least frequent.
+    for (size_t i = 0; i < order.size(); ++i) {
+        const uint64_t count = counted ? counts[order[i]] : order.size() - i;
+        words->push_back({ order[i], std::max<uint64_t>(count, 1) });
+    }
+
+    return true;
+}
+
+bool compile(const std::vector<Word> &words, const char *path)
+{
+    // Weights are quantized to a logarithmic scale, word frequencies are roughly Zipfian so
+    // this preserves the useful part of the ranking while giving far more suffixes identical
+    // weights for the graph to share.
+    uint64_t maximumCount = 1;
+    for (const Word &word : words) {
+        maximumCount = std::max(maximumCount, word.weight);
+    }
+    const double scale = maximumCount > 1 ? (WeightLevels - 1) / log(double(maximumCount)) : 0;
+
+    Compiler compiler;
+    compiler.trie.emplace_back();
+    for (const Word &word : words) {
+        int index = 0;
+        for (const char character : word.text) {
+            const auto it = compiler.trie[index].children.find(uint8_t(character));
+            if (it != compiler.trie[index].children.end()) {
+                index = it->second;
+            } else {
+                const int child = compiler.trie.size();
+                compiler.trie[index].children.emplace(uint8_t(character), child);
+                compiler.trie.emplace_back();
+                index = child;
+            }
+        }
+        compiler.trie[index].weight = 1 + uint32_t(log(double(word.weight)) * scale);
+    }
+
+    // Nodes are written children first so the root is the last node.
+    WordGraphHeader header;
+    memcpy(header.magic, wordGraphMagic, sizeof(header.magic));
+    header.version = WordGraphHeader::Version;
+    header.root = compiler.minimize(0);
+    header.nodeCount = compiler.nodes.size();
+    header.edgeCount = compiler.edges.size();
+
+    FILE * const file = fopen(path, "wb");
+    if (!file) {
+        fprintf(stderr, "Failed to create %s\n", path);
+        return false;
+    }
+
+    const bool written = fwrite(&header, sizeof(header), 1, file) == 1
+            && fwrite(compiler.nodes.data(), sizeof(WordGraphNode), compiler.nodes.size(), file)
+                == compiler.nodes.size()
+            && fwrite(compiler.edges.data(), sizeof(WordGraphEdge), compiler.edges.size(), file)
+                == compiler.edges.size();
+    if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "Failed to write %s\n", path);
+        return false;
+    }
+
+    printf("%zu words, %zu trie nodes, %u graph nodes, %u edges\n",
+           words.size(), compiler.trie.size(), header.nodeCount, header.edgeCount);
+
+    return true;
+}
+
+int64_t elapsed(const timespec &start, const timespec &end)
+{
+    return ((end.tv_sec - start.tv_sec) * INT64_C(1000000000)) + (end.tv_nsec - start.tv_nsec);
+}
+
+/*
+    Types every word into a predictor and times the candidate lookup after each character.
+*/
+bool benchmark(const std::vector<Word> &words, const char *path)
+{
+    WordPredictor predictor;
+    if (!predictor.load(path)) {
+        return false;
+    }
+
+    std::vector<int64_t> times;
+    for (const Word &word : words) {
+        predictor.reset();
+        for (const char character : word.text) {
+            timespec start;
+            timespec end;
+            clock_gettime(CLOCK_MONOTONIC, &start);
+            predictor.append(character);
+            clock_gettime(CLOCK_MONOTONIC, &end);
+            times.push_back(elapsed(start, end));
+        }
+    }
+
+    if (times.empty()) {
+        fprintf(stderr, "No words to benchmark\n");
+        return false;
+    }
+
+    std::sort(times.begin(), times.end());
+
+    int64_t total = 0;
+    for (const int64_t time : times) {
+        total += time;
+    }
+
+    const auto percentile = [&times](int percent) {
+        return times[std::min(times.size() - 1, (times.size() * percent) / 100)];
+    };
+
+    printf("%zu keystrokes, mean %.2f us, p50 %.2f us, p99 %.2f us, max %.2f us\n",
+           times.size(),
+           total / 1000.0 / times.size(),
+           percentile(50) / 1000.0,
+           percentile(99) / 1000.0,
+           times.back() / 1000.0);
+
+    return percentile(99) < 100000;
+}
+
+void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] WORDLIST\n"
+            "\n"
+            "Compiles a list of words, one per line optionally followed by a count of its\n"
+            "occurrences, into a word graph for Sailfish::MinUi::WordPredictor.  Without\n"
+            "counts words are ranked by their order in the list.\n"
+            "\n"
+            "Options:\n"
+            "  -o, --output FILE     Write the word graph to FILE.\n"
+            "  -b, --benchmark FILE  Time predicting each word in the list with the word\n"
+            "                        graph FILE, failing if a keystroke takes 100us or more\n"
+            "                        at the 99th percentile.\n"
+            "  -h, --help            Show this help.\n",
+            name);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    static const option options[] = {
+        { "output", required_argument, nullptr, 'o' },
+        { "benchmark", required_argument, nullptr, 'b' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    const char *output = nullptr;
+    const char *graph = nullptr;
+
+    for (int option; (option = getopt_long(argc, argv, "o:b:h", options, nullptr)) != -1;) {
+        switch (option) {
+        case 'o':
+            output = optarg;
+            break;
+        case 'b':
+            graph = optarg;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (optind != argc - 1 || (!output && !graph)) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<Word> words;
+    if (!readWords(argv[optind], &words)) {
+        return EXIT_FAILURE;
+    } else if (output && !compile(words, output)) {
+        return EXIT_FAILURE;
+    } else if (graph && !benchmark(words, graph)) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
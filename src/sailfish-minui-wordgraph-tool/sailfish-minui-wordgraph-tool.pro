@@ -0,0 +1,20 @@
+TEMPLATE = app
+TARGET = sailfish-minui-wordgraph-tool
+
+include ($$PWD/../../sailfish-minui-common.pri)
+
+CONFIG -= qt
+CONFIG += c++11
+
+DESTDIR = $$SAILFISH_BUILD_ROOT/bin
+
+SOURCES += \
+    main.cpp
+
+LIBS += \
+    -L$$SAILFISH_BUILD_ROOT/lib -lsailfish-minui
+
+target.path = /usr/bin
+
+INSTALLS += \
+    target
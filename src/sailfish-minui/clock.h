@@ -0,0 +1,73 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_CLOCK_H
+#define SAILFISH_MINUI_CLOCK_H
+
+#include <stdint.h>
+
+namespace Sailfish { namespace MinUi {
+
+class Clock
+{
+public:
+    virtual ~Clock() {}
+
+    virtual int64_t currentTime() const = 0;
+    virtual bool setCurrentTime(int64_t time) { (void)time; return false; }
+};
+
+class MonotonicClock : public Clock
+{
+public:
+    int64_t currentTime() const override;
+};
+
+class VirtualClock : public Clock
+{
+public:
+    explicit VirtualClock(int64_t time = 0) : m_time(time) {}
+
+    int64_t currentTime() const override { return m_time; }
+    bool setCurrentTime(int64_t time) override { m_time = time; return true; }
+
+private:
+    int64_t m_time;
+};
+
+}}
+
+#endif
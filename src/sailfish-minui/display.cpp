@@ -35,7 +35,9 @@
 ****************************************************************************************/
 
 #include "display.h"
+#include "item.h"
 #include "logging.h"
+#include "renderthread.h"
 #include <minui/minui.h>
 
 namespace Sailfish { namespace MinUi {
@@ -109,10 +111,20 @@ void Display::setState(State state)
     if (m_state != state) {
         log_debug("Display state:" << state);
         bool wasPoweredOn = isPoweredOn();
+        bool wasDrawable = isDrawable();
         m_state = state;
         bool poweredOn = isPoweredOn();
+        if (!wasDrawable && isDrawable() && m_window) {
+            // Windows don't draw while the display isn't drawable, so render the frame they
+            // owe before the panel is powered on rather than showing what was there before.
+            m_window->prerender();
+        }
         if (wasPoweredOn != poweredOn) {
             log_debug("Display poweredOn:" << poweredOn);
+            if (RenderThread * const thread = RenderThread::instance()) {
+                // Don't blank the framebuffer while a frame is being flipped.
+                thread->finish();
+            }
             gr_fb_blank(!poweredOn);
         }
     }
@@ -38,6 +38,8 @@
 #define SAILFISH_MINUI_DISPLAY_H_
 
 namespace Sailfish { namespace MinUi {
+class Window;
+
 class Display
 {
 public:
@@ -67,9 +69,12 @@ public:
     void blank();
     void unblank();
 private:
+    friend class Window;
+
     explicit Display();
     ~Display();
     State m_state;
+    Window *m_window = nullptr;
     static Display *s_instance;
 };
 }}
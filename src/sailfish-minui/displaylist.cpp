@@ -0,0 +1,629 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "displaylist.h"
+#include "logging.h"
+
+#include <minui/minui.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <mutex>
+
+namespace Sailfish { namespace MinUi {
+
+// Frames may be recorded on the event loop thread while another is replayed on a render thread.
+static thread_local DisplayList *recordingList = nullptr;
+static int rendererCount = 0;
+static std::mutex freedMutex;
+
+struct FreedRange
+{
+    const unsigned char *begin;
+    const unsigned char *end;
+};
+
+// Surfaces freed since the last frame was compared.
+static std::vector<FreedRange> freedRanges;
+
+static uint32_t hashBytes(uint32_t hash, const void *data, size_t size)
+{
+    // FNV-1a.
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+template <typename T> static uint32_t hashValue(uint32_t hash, const T &value)
+{
+    return hashBytes(hash, &value, sizeof(value));
+}
+
+static bool operator ==(const ClipRect &left, const ClipRect &right)
+{
+    return left.left == right.left
+            && left.top == right.top
+            && left.right == right.right
+            && left.bottom == right.bottom;
+}
+
+static int64_t area(const ClipRect &rect)
+{
+    return int64_t(rect.right - rect.left) * (rect.bottom - rect.top);
+}
+
+static ClipRect united(const ClipRect &first, const ClipRect &second)
+{
+    return {
+        std::min(first.left, second.left),
+        std::min(first.top, second.top),
+        std::max(first.right, second.right),
+        std::max(first.bottom, second.bottom)
+    };
+}
+
+/*!
+    \class Sailfish::MinUi::DisplayList
+    \brief A recorded frame of draw commands.
+
+    While a display list is recording, the draw functions in surface.h append commands to it rather
+    than drawing, so the commands of one frame can be compared with the last and replayed within
+    the damaged rectangles only.  Surfaces are recorded by their header, not by pointer, so views of
+    surfaces created on the stack may be recorded, but a surface's pixels must not change after it
+    has been drawn, and it must be released with freeSurface().  Alpha masks are recorded by pointer
+    and must be released with freeAlphaMask().
+*/
+/*
+    Returns the display list which is currently recording or null if draws are immediate.
+*/
+DisplayList *DisplayList::recording()
+{
+    return recordingList;
+}
+
+/*
+    Clears the display list and directs subsequent draws to it.
+*/
+void DisplayList::record()
+{
+    clear();
+    recordingList = this;
+}
+
+/*
+    Directs subsequent draws to the framebuffer.
+*/
+void DisplayList::stopRecording()
+{
+    recordingList = nullptr;
+}
+
+/*
+    Removes all commands from a display list, retaining its storage for reuse.
+*/
+void DisplayList::clear()
+{
+    m_commands.clear();
+    m_text.clear();
+}
+
+/*
+    Exchanges the commands of a display list with those of an \a other list.
+*/
+void DisplayList::swap(DisplayList &other)
+{
+    m_commands.swap(other.m_commands);
+    m_text.swap(other.m_text);
+}
+
+/*
+    Appends a \a command with the geometry and color already set, and the given \a text for text
+    commands.
+
+    The clip and bounds are taken from the current clip rectangle and commands with nothing
+    within the clip are discarded.
+*/
+void DisplayList::append(Command &command, const char *text)
+{
+    command.clip = clipRect();
+    command.bounds = command.type == Clear
+            ? command.clip
+            : command.clip.intersected({
+                    command.x, command.y, command.x + command.width, command.y + command.height });
+    if (command.bounds.isEmpty()) {
+        return;
+    }
+
+    uint32_t hash = 2166136261u;
+    hash = hashValue(hash, command.type);
+    hash = hashValue(hash, command.bold);
+    hash = hashValue(hash, command.color);
+    hash = hashValue(hash, command.bounds);
+    hash = hashValue(hash, command.x);
+    hash = hashValue(hash, command.y);
+    hash = hashValue(hash, command.sourceX);
+    hash = hashValue(hash, command.sourceY);
+    hash = hashValue(hash, command.width);
+    hash = hashValue(hash, command.height);
+    hash = hashValue(hash, command.surface.data);
+    hash = hashValue(hash, command.surface.row_bytes);
+    hash = hashValue(hash, command.mask);
+
+    if (text) {
+        command.textOffset = m_text.size();
+        m_text.append(text, command.textLength);
+        m_text.push_back('\0');
+        hash = hashBytes(hash, text, command.textLength);
+    }
+
+    command.hash = hash;
+    m_commands.push_back(command);
+}
+
+/*
+    Returns true if a \a command of this list draws exactly the same as \a otherCommand of the
+    \a other list.
+*/
+bool DisplayList::equals(
+        const Command &command, const DisplayList &other, const Command &otherCommand) const
+{
+    return command.hash == otherCommand.hash
+            && command.type == otherCommand.type
+            && command.bold == otherCommand.bold
+            && memcmp(command.color, otherCommand.color, sizeof(command.color)) == 0
+            && command.clip == otherCommand.clip
+            && command.bounds == otherCommand.bounds
+            && command.x == otherCommand.x
+            && command.y == otherCommand.y
+            && command.sourceX == otherCommand.sourceX
+            && command.sourceY == otherCommand.sourceY
+            && command.width == otherCommand.width
+            && command.height == otherCommand.height
+            && command.surface.width == otherCommand.surface.width
+            && command.surface.height == otherCommand.surface.height
+            && command.surface.row_bytes == otherCommand.surface.row_bytes
+            && command.surface.pixel_bytes == otherCommand.surface.pixel_bytes
+            && command.surface.data == otherCommand.surface.data
+            && command.mask == otherCommand.mask
+            && command.textLength == otherCommand.textLength
+            && memcmp(text(command), other.text(otherCommand), command.textLength) == 0;
+}
+
+/*
+    Draws the commands of a display list which intersect \a rect, clipped to \a rect.
+
+    The list must start with a command which clears the rectangle as anything drawn with
+    transparency would otherwise be blended with what was already there.
+*/
+void DisplayList::replay(const ClipRect &rect) const
+{
+    const ClipRect clip = clipRect();
+
+    for (const Command &command : m_commands) {
+        if (!command.bounds.intersects(rect)) {
+            continue;
+        }
+
+        setClipRect(command.clip.intersected(rect));
+
+        switch (command.type) {
+        case Clear:
+            // gr_clear() overwrites rather than blending so fill opaquely.
+            setDrawColor(command.color[0], command.color[1], command.color[2], 255);
+            fillRect(command.bounds.left, command.bounds.top, command.bounds.right, command.bounds.bottom);
+            break;
+        case Fill:
+            setDrawColor(command.color[0], command.color[1], command.color[2], command.color[3]);
+            fillRect(command.x, command.y, command.x + command.width, command.y + command.height);
+            break;
+        case TextIcon:
+            setDrawColor(command.color[0], command.color[1], command.color[2], command.color[3]);
+            drawTextIcon(command.x, command.y, &command.surface);
+            break;
+        case BlitRgb:
+            blitRgb(
+                        &command.surface,
+                        command.sourceX,
+                        command.sourceY,
+                        command.width,
+                        command.height,
+                        command.x,
+                        command.y);
+            break;
+        case Blit:
+            blitSurface(
+                        &command.surface,
+                        command.sourceX,
+                        command.sourceY,
+                        command.width,
+                        command.height,
+                        command.x,
+                        command.y);
+            break;
+        case Mask:
+            setDrawColor(command.color[0], command.color[1], command.color[2], command.color[3]);
+            drawAlphaMask(command.x, command.y, command.mask);
+            break;
+        case Text:
+            setDrawColor(command.color[0], command.color[1], command.color[2], command.color[3]);
+            drawText(command.x, command.y, text(command), command.bold);
+            break;
+        }
+    }
+
+    setClipRect(clip);
+}
+
+/*
+    Appends a line of text describing each command of a display list for \a frame to
+    \a output.
+*/
+void DisplayList::serialize(std::string *output, int frame) const
+{
+    static const char * const names[] = { "clear", "fill", "texticon", "blitrgb", "blit", "mask", "text" };
+
+    char line[256];
+    snprintf(line, sizeof(line), "frame %d commands %zu\n", frame, m_commands.size());
+    output->append(line);
+
+    for (const Command &command : m_commands) {
+        snprintf(
+                    line,
+                    sizeof(line),
+                    "%s %d %d %d %d color %u %u %u %u clip %d %d %d %d surface %p source %d %d",
+                    names[command.type],
+                    command.x,
+                    command.y,
+                    command.width,
+                    command.height,
+                    command.color[0],
+                    command.color[1],
+                    command.color[2],
+                    command.color[3],
+                    command.clip.left,
+                    command.clip.top,
+                    command.clip.right,
+                    command.clip.bottom,
+                    static_cast<const void *>(command.surface.data),
+                    command.sourceX,
+                    command.sourceY);
+        output->append(line);
+        if (command.type == Text) {
+            output->append(" text ");
+            output->append(text(command), command.textLength);
+        }
+        output->push_back('\n');
+    }
+}
+
+/*!
+    \class Sailfish::MinUi::DamageRegion
+    \brief A small set of rectangles needing to be redrawn.
+
+    When there are more rectangles than fit, a new rectangle is merged with the existing rectangle
+    whose bounds grow the least from the merge.
+*/
+/*
+    Adds a \a rect to a damage region.
+*/
+void DamageRegion::add(const ClipRect &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (rects[i].contains(rect)) {
+            return;
+        } else if (rect.contains(rects[i])) {
+            rects[i] = rect;
+            return;
+        }
+    }
+
+    if (count < MaximumRectCount) {
+        rects[count++] = rect;
+        return;
+    }
+
+    int best = 0;
+    int64_t bestGrowth = INT64_MAX;
+    for (int i = 0; i < count; ++i) {
+        const int64_t growth = area(united(rects[i], rect)) - area(rects[i]);
+        if (growth < bestGrowth) {
+            best = i;
+            bestGrowth = growth;
+        }
+    }
+    rects[best] = united(rects[best], rect);
+}
+
+/*
+    Adds all the rectangles of another damage \a region to a damage region.
+*/
+void DamageRegion::add(const DamageRegion &region)
+{
+    for (int i = 0; i < region.count; ++i) {
+        add(region.rects[i]);
+    }
+}
+
+/*!
+    \class Sailfish::MinUi::DisplayListRenderer
+    \brief Draws frames from display lists, replaying only what has changed.
+
+    Each frame is recorded and compared with the previous frame, and only the rectangles covered by
+    commands which were added, removed or changed are replayed.  Commands are matched in order, so a
+    change in the stacking of overlapping commands is also damage.  The framebuffer drawn to was
+    last drawn two frames ago when page flipping, so the damage of the previous frame is replayed as
+    well.
+*/
+/*
+    Constructs a display list renderer.
+
+    If the SAILFISH_MINUI_DISPLAY_LIST_LOG environment variable names a file the display list
+    of every frame drawn is appended to it.
+*/
+DisplayListRenderer::DisplayListRenderer()
+{
+    {
+        std::lock_guard<std::mutex> lock(freedMutex);
+        ++rendererCount;
+    }
+
+    if (const char * const path = getenv("SAILFISH_MINUI_DISPLAY_LIST_LOG")) {
+        m_logFd = ::open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (m_logFd < 0) {
+            log_warning("Unable to open display list log " << path << ". " << strerror(errno));
+        }
+    }
+}
+
+/*
+    Destroys a display list renderer.
+*/
+DisplayListRenderer::~DisplayListRenderer()
+{
+    if (m_current == recordingList) {
+        recordingList = nullptr;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(freedMutex);
+        if (--rendererCount == 0) {
+            freedRanges.clear();
+        }
+    }
+
+    if (m_logFd >= 0) {
+        ::close(m_logFd);
+    }
+}
+
+/*
+    Starts recording a frame covering \a bounds.
+*/
+void DisplayListRenderer::begin(const ClipRect &bounds)
+{
+    setBounds(bounds);
+    m_current->record();
+}
+
+/*
+    Finishes recording a \a frame and draws its damaged rectangles.
+*/
+void DisplayListRenderer::end(int frame)
+{
+    DisplayList::stopRecording();
+    render(frame);
+}
+
+/*
+    Draws the damaged rectangles of a \a frame recorded elsewhere into a \a snapshot covering
+    \a bounds.
+
+    The commands of the snapshot are taken and it's left with those of an earlier frame.
+*/
+void DisplayListRenderer::draw(DisplayList *snapshot, const ClipRect &bounds, int frame)
+{
+    setBounds(bounds);
+    m_current->swap(*snapshot);
+    render(frame);
+}
+
+void DisplayListRenderer::setBounds(const ClipRect &bounds)
+{
+    if (!(bounds == m_bounds)) {
+        m_bounds = bounds;
+        invalidateAll();
+    }
+}
+
+void DisplayListRenderer::render(int frame)
+{
+    setClipRect(m_bounds);
+
+    compare();
+
+    DamageRegion replay = m_damage;
+    if (m_fullDamageFrames > 0) {
+        --m_fullDamageFrames;
+        replay.count = 0;
+        replay.add(m_bounds);
+    } else {
+        replay.add(m_previousDamage);
+    }
+
+    for (int i = 0; i < replay.count; ++i) {
+        m_current->replay(replay.rects[i].intersected(m_bounds));
+    }
+
+    if (m_logFd >= 0) {
+        m_log.clear();
+        m_current->serialize(&m_log, frame);
+        char line[64];
+        for (int i = 0; i < m_damage.count; ++i) {
+            const ClipRect &rect = m_damage.rects[i];
+            snprintf(line, sizeof(line), "damage %d %d %d %d\n", rect.left, rect.top, rect.right, rect.bottom);
+            m_log.append(line);
+        }
+        if (::write(m_logFd, m_log.data(), m_log.size()) != ssize_t(m_log.size())) {
+            log_warning("Unable to write display list log. " << strerror(errno));
+            ::close(m_logFd);
+            m_logFd = -1;
+        }
+    }
+
+    m_previousDamage = m_damage;
+    std::swap(m_current, m_previous);
+}
+
+/*
+    Causes the next frames to be drawn in full, for when the contents of the framebuffers are
+    unknown.
+*/
+void DisplayListRenderer::invalidateAll()
+{
+    m_fullDamageFrames = 2;
+}
+
+/*
+    Notes that a \a surface has been freed so that commands drawing a surface later allocated at
+    the same address aren't mistaken for an unchanged command.
+*/
+void DisplayListRenderer::surfaceFreed(const GRSurface *surface)
+{
+    std::lock_guard<std::mutex> lock(freedMutex);
+    if (rendererCount > 0 && surface->data) {
+        freedRanges.push_back({ surface->data, surface->data + (surface->row_bytes * surface->height) });
+    }
+}
+
+/*
+    Notes that a \a mask has been freed, the same as for surfaceFreed().
+*/
+void DisplayListRenderer::maskFreed(const AlphaMask *mask)
+{
+    std::lock_guard<std::mutex> lock(freedMutex);
+    if (rendererCount > 0) {
+        const unsigned char * const begin = reinterpret_cast<const unsigned char *>(mask);
+        freedRanges.push_back({ begin, begin + mask->size });
+    }
+}
+
+/*
+    Returns true if a \a command draws a surface or mask in memory that was freed since the last
+    frame.
+*/
+bool DisplayListRenderer::wasFreed(const Command &command) const
+{
+    const unsigned char * const memory = command.mask
+            ? reinterpret_cast<const unsigned char *>(command.mask)
+            : command.surface.data;
+    if (memory) {
+        for (const FreedRange &range : freedRanges) {
+            if (memory >= range.begin && memory < range.end) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/*
+    Finds the damage between the previous and current display lists.
+
+    Commands of the current list are matched in order against the earliest identical command of
+    the previous list after the last match, and the bounds of all commands of either list which
+    aren't matched are damaged.  Every pixel outside the damage is drawn by the same commands in
+    the same order in both frames and so is unchanged.
+*/
+void DisplayListRenderer::compare()
+{
+    const std::vector<Command> &previous = m_previous->commands();
+    const std::vector<Command> &current = m_current->commands();
+
+    m_damage.count = 0;
+
+    m_previousOrder.resize(previous.size());
+    for (size_t i = 0; i < previous.size(); ++i) {
+        m_previousOrder[i] = (uint64_t(previous[i].hash) << 32) | i;
+    }
+    std::sort(m_previousOrder.begin(), m_previousOrder.end());
+    m_previousMatched.assign(previous.size(), false);
+
+    std::lock_guard<std::mutex> lock(freedMutex);
+
+    int64_t lastMatch = -1;
+    for (const Command &command : current) {
+        bool matched = false;
+        if (!wasFreed(command)) {
+            auto it = std::lower_bound(
+                        m_previousOrder.begin(),
+                        m_previousOrder.end(),
+                        (uint64_t(command.hash) << 32) | uint64_t(lastMatch + 1));
+            for (; it != m_previousOrder.end() && (*it >> 32) == command.hash; ++it) {
+                const uint32_t index = *it & 0xffffffff;
+                if (m_current->equals(command, *m_previous, previous[index])) {
+                    m_previousMatched[index] = true;
+                    lastMatch = index;
+                    matched = true;
+                    break;
+                }
+            }
+        }
+        if (!matched) {
+            m_damage.add(command.bounds);
+        }
+    }
+
+    for (size_t i = 0; i < previous.size(); ++i) {
+        if (!m_previousMatched[i]) {
+            m_damage.add(previous[i].bounds);
+        }
+    }
+
+    freedRanges.clear();
+}
+
+} }
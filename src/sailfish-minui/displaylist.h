@@ -0,0 +1,156 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_DISPLAYLIST_H
+#define SAILFISH_MINUI_DISPLAYLIST_H
+
+#include "surface.h"
+
+#include <string>
+#include <vector>
+
+namespace Sailfish { namespace MinUi {
+
+class DisplayList
+{
+public:
+    enum CommandType : uint8_t {
+        Clear,
+        Fill,
+        TextIcon,
+        BlitRgb,
+        Blit,
+        Mask,
+        Text
+    };
+
+    struct Command
+    {
+        CommandType type;
+        bool bold;
+        uint8_t color[4];
+        ClipRect clip;      // The clip rectangle when the command was recorded.
+        ClipRect bounds;    // The area affected, within the clip.
+        int x;
+        int y;
+        int sourceX;
+        int sourceY;
+        int width;
+        int height;
+        GRSurface surface;
+        const AlphaMask *mask;
+        uint32_t textOffset;
+        uint32_t textLength;
+        uint32_t hash;
+    };
+
+    static DisplayList *recording();
+    void record();
+    static void stopRecording();
+
+    void clear();
+    void swap(DisplayList &other);
+    void append(Command &command, const char *text = nullptr);
+
+    const std::vector<Command> &commands() const { return m_commands; }
+    const char *text(const Command &command) const { return m_text.data() + command.textOffset; }
+
+    bool equals(const Command &command, const DisplayList &other, const Command &otherCommand) const;
+
+    void replay(const ClipRect &rect) const;
+
+    void serialize(std::string *output, int frame) const;
+
+private:
+    std::vector<Command> m_commands;
+    std::string m_text;
+};
+
+struct DamageRegion
+{
+    enum {
+        MaximumRectCount = 8
+    };
+
+    ClipRect rects[MaximumRectCount];
+    int count = 0;
+
+    void add(const ClipRect &rect);
+    void add(const DamageRegion &region);
+};
+
+class DisplayListRenderer
+{
+public:
+    DisplayListRenderer();
+    ~DisplayListRenderer();
+
+    void begin(const ClipRect &bounds);
+    void end(int frame);
+
+    void draw(DisplayList *snapshot, const ClipRect &bounds, int frame);
+
+    void invalidateAll();
+
+    const DamageRegion &damage() const { return m_damage; }
+
+    static void surfaceFreed(const GRSurface *surface);
+    static void maskFreed(const AlphaMask *mask);
+
+private:
+    typedef DisplayList::Command Command;
+
+    inline void setBounds(const ClipRect &bounds);
+    inline void render(int frame);
+    inline void compare();
+    inline bool wasFreed(const Command &command) const;
+
+    DisplayList m_lists[2];
+    DisplayList *m_current = &m_lists[0];
+    DisplayList *m_previous = &m_lists[1];
+    ClipRect m_bounds = { 0, 0, 0, 0 };
+    DamageRegion m_damage;
+    DamageRegion m_previousDamage;
+    std::vector<uint64_t> m_previousOrder;
+    std::vector<bool> m_previousMatched;
+    std::string m_log;
+    int m_logFd = -1;
+    int m_fullDamageFrames = 2;
+};
+
+} }
+
+#endif
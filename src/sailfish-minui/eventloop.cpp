@@ -35,10 +35,14 @@
 ****************************************************************************************/
 
 #include "eventloop.h"
+#include "inputrecorder.h"
+#include "logging.h"
 #include "ui.h"
+#include "watchdog.h"
 
 #include <algorithm>
 
+#include <errno.h>
 #include <limits.h>
 #include <signal.h>
 #include <string.h>
@@ -46,6 +50,7 @@
 #include <unistd.h>
 
 #include <linux/input.h>
+#include <poll.h>
 #include <sys/epoll.h>
 #include <sys/eventfd.h>
 
@@ -64,7 +69,37 @@ static void terminateSignalHandler(int signal)
     assert(size == sizeof(eventData));
 }
 
-static int64_t currentTime()
+/*!
+    \class Sailfish::MinUi::Clock
+    \brief A source of time for an event loop.
+
+    The event loop measures timer intervals with a clock which is CLOCK_MONOTONIC by default,
+    an alternative can be installed with \l EventLoop::setClock().
+*/
+
+/*!
+    \fn int64_t Sailfish::MinUi::Clock::currentTime() const
+
+    Returns the current time in milliseconds.
+*/
+
+/*!
+    \fn bool Sailfish::MinUi::Clock::setCurrentTime(int64_t time)
+
+    Sets the current \a time in milliseconds.
+
+    Returns true if the clock can be stepped, real time clocks can't and return false.
+*/
+
+/*!
+    \class Sailfish::MinUi::MonotonicClock
+    \brief A clock which reads CLOCK_MONOTONIC.
+*/
+
+/*!
+    Returns the current monotonic time in milliseconds.
+*/
+int64_t MonotonicClock::currentTime() const
 {
     timespec time;
     clock_gettime(CLOCK_MONOTONIC, &time);
@@ -72,6 +107,16 @@ static int64_t currentTime()
     return (time.tv_sec * INT64_C(1000)) + (time.tv_nsec / 1000000);
 }
 
+/*!
+    \class Sailfish::MinUi::VirtualClock
+    \brief A clock which only moves when it is told to.
+
+    A virtual clock installed on an event loop with \l EventLoop::setClock() allows time to be
+    stepped with \l EventLoop::advance() so timers, animations and timeouts can be run
+    deterministically and much faster than real time.  Time doesn't pass while the event loop
+    is blocked in \l EventLoop::execute() so timers will only expire when the clock is stepped.
+*/
+
 static EventLoop *globalEventLoop = nullptr;
 
 /*!
@@ -86,7 +131,11 @@ static EventLoop *globalEventLoop = nullptr;
     Constructs a new event loop.
 */
 EventLoop::EventLoop()
-    : m_window(nullptr)
+    : m_clock(&m_monotonicClock)
+    , m_watchdog(nullptr)
+    , m_recorder(nullptr)
+    , m_window(nullptr)
+    , m_notifierFd(::epoll_create1(EPOLL_CLOEXEC))
     , m_result(0)
     , m_executing(false)
 {
@@ -96,6 +145,14 @@ EventLoop::EventLoop()
 
     ev_init(ev_input_callback, this);
 
+    // Notifiers are watched through a nested epoll set as minui has no means to stop watching
+    // a descriptor and a closed and recycled descriptor would otherwise never be watched again.
+    if (m_notifierFd >= 0) {
+        ev_add_fd(m_notifierFd, ev_notifier_callback, this);
+    } else {
+        log_err("Failed to create the notifier epoll set. " << strerror(errno));
+    }
+
     assert(terminateSignalFd == -1);
     terminateSignalFd = ::eventfd(0, EFD_NONBLOCK);
 
@@ -123,6 +180,10 @@ EventLoop::~EventLoop()
         terminateSignalFd = 0;
     }
 
+    if (m_notifierFd >= 0) {
+        close(m_notifierFd);
+    }
+
     globalEventLoop = nullptr;
 }
 
@@ -147,43 +208,23 @@ int EventLoop::execute()
     m_executing = true;
 
     while (m_executing) {
-        int64_t timeout = -1;
-
-        if (m_timers.size() > 0) {
-            auto timer = m_timers.front();
-            int64_t expires = timer.expiration - currentTime();
-
-            if (expires <= 0) {
-                // Move the timer to the next expiration point.
-                m_timers.erase(m_timers.begin());
-
-                timer.expiration += timer.interval;
-
-                insertTimer(timer);
-
-                if (timer.data) {
-                    timerExpired(timer.data);
-                } else if (timer.callback) {
-                    timer.callback();
-                }
-
-                timeout = 0;
-            } else if (timeout < 0 || timeout > expires) {
-                timeout = expires;
-            }
-        }
+        int64_t timeout = runExpiredTimer();
 
         if (m_executing && m_singleShots.size() > 0) {
             auto singleShot = m_singleShots.front();
             m_singleShots.erase(m_singleShots.begin());
 
+            Watchdog::Scope scope(m_watchdog, Watchdog::SingleShot);
             singleShot();
 
             timeout = 0;
         }
 
-        if (m_executing && dispatch())
-            timeout = 0;
+        if (m_executing) {
+            Watchdog::Scope scope(m_watchdog, Watchdog::Dispatch);
+            if (dispatch())
+                timeout = 0;
+        }
 
         if (m_executing && ev_wait(std::min<int64_t>(timeout, INT_MAX)) == 0) {
             ev_dispatch();
@@ -206,6 +247,87 @@ void EventLoop::exit(int result)
     }
 }
 
+/*!
+    Sets the \a clock used to measure timer intervals, or restores the monotonic clock if
+    \a clock is null.
+
+    Timers which are already running are moved to the new clock retaining the time remaining
+    until they expire.  The event loop doesn't take ownership of the clock.
+*/
+void EventLoop::setClock(Clock *clock)
+{
+    const int64_t previous = currentTime();
+
+    m_clock = clock ? clock : &m_monotonicClock;
+
+    const int64_t offset = currentTime() - previous;
+    for (Timer &timer : m_timers) {
+        timer.expiration += offset;
+    }
+}
+
+/*!
+    Sets a \a watchdog which times the callbacks dispatched by the event loop, or removes the
+    watchdog if \a watchdog is null.
+
+    The event loop doesn't take ownership of the watchdog.
+*/
+void EventLoop::setWatchdog(Watchdog *watchdog)
+{
+    m_watchdog = watchdog;
+}
+
+/*!
+    Steps the clock forward by \a interval milliseconds running everything that becomes due
+    along the way without sleeping.
+
+    Timers which expire at or before the target time are run in order of expiration with the
+    clock set to the time each one expires, and queued single shots, pending dispatches, ready
+    notifiers and window updates are processed after each one.  Each timer runs at most once
+    per step so a repeating timer with an interval shorter than the step fires once rather
+    than catching up, and one with an interval of 0 can't prevent the clock reaching the
+    target.  An interval of 0 processes only what is already due.
+
+    Input from devices is not read while stepping, it remains queued until the event loop is
+    next executed.
+
+    This requires a clock which can be stepped such as a \l VirtualClock.
+*/
+void EventLoop::advance(int64_t interval)
+{
+    const int64_t target = currentTime() + interval;
+
+    if (!m_clock->setCurrentTime(currentTime())) {
+        log_warning("EventLoop: advance() requires a clock which can be stepped.");
+        return;
+    }
+
+    // Timers are identified by their ID or for those created with context data the data.
+    std::vector<std::pair<int, void *>> expired;
+
+    for (;;) {
+        processPendingEvents();
+
+        const auto timer = std::find_if(m_timers.begin(), m_timers.end(), [&expired](const Timer &timer) {
+            return std::find(expired.begin(), expired.end(), std::make_pair(timer.id, timer.data)) == expired.end();
+        });
+
+        if (timer == m_timers.end() || timer->expiration > target) {
+            break;
+        } else if (timer->expiration > currentTime()) {
+            m_clock->setCurrentTime(timer->expiration);
+        }
+
+        expired.emplace_back(timer->id, timer->data);
+
+        runTimer(timer);
+    }
+
+    m_clock->setCurrentTime(target);
+
+    processPendingEvents();
+}
+
 /*!
     Creates a new timer which executes \a callback every \a interval milliseconds.
 
@@ -233,6 +355,14 @@ void EventLoop::cancelTimer(int id)
     m_timers.erase(end, m_timers.end());
 }
 
+/*!
+    Queues a \a callback to be invoked once on the next iteration of the event loop.
+*/
+void EventLoop::singleShot(const std::function<void()> &callback)
+{
+    m_singleShots.push_back(callback);
+}
+
 /*!
     Creates a timer which will invoke \l timerExpired() passing \a data as an argument every
     \a interval milliseconds.
@@ -285,8 +415,7 @@ bool EventLoop::addNotifierCallback(int descriptor, const std::function<Notifier
 */
 bool EventLoop::addNotifier(int descriptor, void *data, const std::function<NotifierCallbackType> &callback)
 {
-    // If a watch was removed and then re-added later or the fd was recycled restore the removed
-    // watch instead of creating a new one.
+    // If the descriptor is already watched replace the existing notifier.
     for (auto &notifier : m_notifiers) {
         if (notifier.fd == descriptor) {
             notifier.data = data;
@@ -295,7 +424,12 @@ bool EventLoop::addNotifier(int descriptor, void *data, const std::function<Noti
         }
     }
 
-    if (ev_add_fd(descriptor, ev_notifier_callback, this) == 0) {
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = descriptor;
+
+    if (::epoll_ctl(m_notifierFd, EPOLL_CTL_ADD, descriptor, &event) == 0) {
         m_notifiers.push_back({ descriptor, data, callback });
         return true;
     }
@@ -305,18 +439,48 @@ bool EventLoop::addNotifier(int descriptor, void *data, const std::function<Noti
 
 /*!
     Removes a notifier for a socket \a descriptor.
+
+    The notifier should be removed before the descriptor is closed.
 */
 void EventLoop::removeNotifier(int descriptor)
 {
-    for (auto &notifier : m_notifiers) {
-        if (notifier.fd == descriptor) {
-            notifier.data = nullptr;
-            notifier.callback = nullptr;
-            break;
-        }
+    auto end = std::remove_if(m_notifiers.begin(), m_notifiers.end(), [descriptor](const Notifier &notifier) {
+        return notifier.fd == descriptor;
+    });
+
+    if (end != m_notifiers.end()) {
+        m_notifiers.erase(end, m_notifiers.end());
+
+        // This fails harmlessly if the descriptor was already closed.
+        ::epoll_ctl(m_notifierFd, EPOLL_CTL_DEL, descriptor, nullptr);
     }
 }
 
+/*!
+    Returns an awaitable which suspends a coroutine for \a interval milliseconds.
+
+    The coroutine is resumed from the event loop when the interval has elapsed, for example
+    \c {co_await loop.sleep(500);}
+*/
+EventLoop::Sleep EventLoop::sleep(int interval)
+{
+    return Sleep(this, interval);
+}
+
+/*!
+    Returns an awaitable which suspends a coroutine until the socket \a descriptor becomes
+    readable.
+
+    The result of the co_await expression is the epoll events that were signalled, or 0 if
+    the descriptor could not be watched in which case the coroutine is not suspended.  The
+    descriptor is only watched for a single notification, and it's expected the coroutine will
+    consume the pending data before waiting again.
+*/
+EventLoop::Readable EventLoop::readable(int descriptor)
+{
+    return Readable(this, descriptor);
+}
+
 /*!
     Handles a notification of \a events for a socket \a descriptor with the given \a data.
 
@@ -341,6 +505,97 @@ bool EventLoop::dispatch()
     return false;
 }
 
+/*!
+    Runs the earliest timer if it has expired.
+
+    Returns 0 if a timer was run, otherwise the time in milliseconds until the earliest timer
+    expires or -1 if there are no timers.
+*/
+int64_t EventLoop::runExpiredTimer()
+{
+    if (m_timers.empty()) {
+        return -1;
+    }
+
+    const int64_t expires = m_timers.front().expiration - currentTime();
+
+    if (expires > 0) {
+        return expires;
+    }
+
+    runTimer(m_timers.begin());
+
+    return 0;
+}
+
+/*!
+    Runs the timer at \a position and moves it to its next expiration point.
+*/
+void EventLoop::runTimer(std::vector<Timer>::iterator position)
+{
+    auto timer = *position;
+
+    // Move the timer to the next expiration point.
+    m_timers.erase(position);
+
+    timer.expiration += timer.interval;
+
+    insertTimer(timer);
+
+    Watchdog::Scope scope(m_watchdog, Watchdog::Timer, timer.id, timer.data);
+    if (timer.data) {
+        timerExpired(timer.data);
+    } else if (timer.callback) {
+        timer.callback();
+    }
+}
+
+/*!
+    Processes queued single shots, pending dispatches, ready notifiers and window updates until
+    there is nothing left to do without waiting.
+
+    Input devices are not polled.
+*/
+void EventLoop::processPendingEvents()
+{
+    for (bool pending = true; pending;) {
+        pending = false;
+
+        while (!m_singleShots.empty()) {
+            auto singleShot = m_singleShots.front();
+            m_singleShots.erase(m_singleShots.begin());
+
+            Watchdog::Scope scope(m_watchdog, Watchdog::SingleShot);
+            singleShot();
+
+            pending = true;
+        }
+
+        {
+            Watchdog::Scope scope(m_watchdog, Watchdog::Dispatch);
+            if (dispatch()) {
+                pending = true;
+            }
+        }
+
+        // Only the notifiers and the update notifications of the window are polled.
+        pollfd descriptors[] = {
+            { m_notifierFd, POLLIN, 0 },
+            { m_window ? m_window->m_eventFd : -1, POLLIN, 0 }
+        };
+        if (::poll(descriptors, 2, 0) > 0) {
+            if (descriptors[0].revents & POLLIN) {
+                ev_notifier_callback(m_notifierFd, EPOLLIN, this);
+                pending = true;
+            }
+            if (m_window && (descriptors[1].revents & POLLIN)) {
+                Window::update_callback(m_window->m_eventFd, EPOLLIN, m_window);
+                pending = true;
+            }
+        }
+    }
+}
+
 /*!
     Inserts a new \a timer.
 */
@@ -383,44 +638,81 @@ int EventLoop::ev_input_callback(int fd, uint32_t events, void *data)
 {
     EventLoop * const loop = static_cast<EventLoop *>(data);
 
-    input_event event;
+    if (!(events & EPOLLIN)) {
+        return -1;
+    }
 
-    if (ev_get_input(fd, events, &event) != 0) {
+    // Read everything the device has queued at once rather than an event at a time as
+    // ev_get_input() does, a single touch frame is typically 6 to 10 events.
+    input_event inputEvents[64];
+    ssize_t size;
+    do {
+        size = ::read(fd, inputEvents, sizeof(inputEvents));
+    } while (size < 0 && errno == EINTR);
+
+    const int count = size > 0 ? int(size / sizeof(input_event)) : 0;
+    if (count == 0) {
         return -1;
     }
 
-    if (loop->m_window) {
-        loop->m_window->inputEvent(fd, event);
+    if (loop->m_recorder) {
+        loop->m_recorder->record(fd, inputEvents, count);
+    }
+
+    Watchdog::Scope scope(loop->m_watchdog, Watchdog::Input, fd, loop->m_window);
+
+    // Deliver complete SYN_REPORT frames, a trailing partial frame is delivered as is and
+    // completed by the next read.
+    int begin = 0;
+    for (int i = 0; i < count && loop->m_window; ++i) {
+        if (inputEvents[i].type == EV_SYN && inputEvents[i].code == SYN_REPORT) {
+            loop->m_window->inputFrame(fd, inputEvents + begin, i + 1 - begin);
+            begin = i + 1;
+        }
+    }
+    if (begin < count && loop->m_window) {
+        loop->m_window->inputFrame(fd, inputEvents + begin, count - begin);
     }
 
     return 0;
 }
 
 /*!
-    Handles a notifier \a event for a file descriptor \a fd where \a data is a pointer to the
-    event loop.
+    Handles events for the notifier epoll set \a fd where \a data is a pointer to the event loop.
 
     Returns -1 if there was an error handling the events and 0 if it was handled successfully.
 */
-int EventLoop::ev_notifier_callback(int fd, uint32_t event, void *data)
+int EventLoop::ev_notifier_callback(int fd, uint32_t, void *data)
 {
     const auto loop = static_cast<EventLoop *>(data);
 
-    void *notifierData = nullptr;
-    std::function<NotifierCallbackType> callback(nullptr);
-    for (const auto &notifier : loop->m_notifiers) {
-        if (notifier.fd == fd) {
-            notifierData = notifier.data;
-            callback = notifier.callback;
-            break;
-        }
+    epoll_event events[16];
+    const int count = ::epoll_wait(fd, events, 16, 0);
+    if (count < 0) {
+        return -1;
     }
 
-    if (callback) {
-        callback(fd, event);
-    }
-    if (notifierData) {
-        loop->notify(fd, event, notifierData);
+    for (int i = 0; i < count; ++i) {
+        const int descriptor = events[i].data.fd;
+
+        // A preceding callback may have removed this notifier.
+        void *notifierData = nullptr;
+        std::function<NotifierCallbackType> callback(nullptr);
+        for (const auto &notifier : loop->m_notifiers) {
+            if (notifier.fd == descriptor) {
+                notifierData = notifier.data;
+                callback = notifier.callback;
+                break;
+            }
+        }
+
+        Watchdog::Scope scope(loop->m_watchdog, Watchdog::Notifier, descriptor, notifierData);
+        if (callback) {
+            callback(descriptor, events[i].events);
+        }
+        if (notifierData) {
+            loop->notify(descriptor, events[i].events, notifierData);
+        }
     }
 
     return 0;
@@ -441,6 +733,7 @@ int EventLoop::terminated_callback(int fd, uint32_t event, void *data)
     assert(size == sizeof(eventData));
 
     const auto loop = static_cast<EventLoop *>(data);
+    Watchdog::Scope scope(loop->m_watchdog, Watchdog::Terminated);
     if (loop->m_terminated) {
         loop->m_terminated();
     } else {
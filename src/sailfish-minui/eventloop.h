@@ -37,6 +37,8 @@
 #ifndef SAILFISH_MINUI_EVENTLOOP_H
 #define SAILFISH_MINUI_EVENTLOOP_H
 
+#include <sailfish-minui/clock.h>
+
 #include <vector>
 #include <functional>
 
@@ -44,11 +46,87 @@ typedef bool (NotifierCallbackType)(int descriptor, uint32_t events);
 
 namespace Sailfish { namespace MinUi {
 
+class InputRecorder;
 class Window;
+class Watchdog;
+
+class Continuation
+{
+public:
+    template <typename Handle> void suspend(Handle handle)
+    {
+        m_address = handle.address();
+        m_resume = &invoke<Handle>;
+    }
+
+    void resume() { m_resume(m_address); }
+
+private:
+    template <typename Handle> static void invoke(void *address) { Handle::from_address(address).resume(); }
+
+    void *m_address = nullptr;
+    void (*m_resume)(void *address) = nullptr;
+};
 
 class EventLoop
 {
 public:
+    class Sleep
+    {
+    public:
+        Sleep(EventLoop *loop, int interval) : m_loop(loop), m_interval(interval) {}
+        Sleep(Sleep &&sleep) : m_loop(sleep.m_loop), m_interval(sleep.m_interval) {}
+        ~Sleep() { if (m_id > 0) { m_loop->cancelTimer(m_id); } }
+
+        bool await_ready() const { return false; }
+        template <typename Handle> void await_suspend(Handle handle)
+        {
+            m_continuation.suspend(handle);
+            m_id = m_loop->createTimer(m_interval, [this]() {
+                m_loop->cancelTimer(m_id);
+                m_id = 0;
+                m_continuation.resume();
+            });
+        }
+        void await_resume() {}
+
+    private:
+        Continuation m_continuation;
+        EventLoop * const m_loop;
+        const int m_interval;
+        int m_id = 0;
+    };
+
+    class Readable
+    {
+    public:
+        Readable(EventLoop *loop, int descriptor) : m_loop(loop), m_descriptor(descriptor) {}
+        Readable(Readable &&readable) : m_loop(readable.m_loop), m_descriptor(readable.m_descriptor) {}
+        ~Readable() { if (m_watching) { m_loop->removeNotifier(m_descriptor); } }
+
+        bool await_ready() const { return false; }
+        template <typename Handle> bool await_suspend(Handle handle)
+        {
+            m_continuation.suspend(handle);
+            m_watching = m_loop->addNotifierCallback(m_descriptor, [this](int, uint32_t events) {
+                m_loop->removeNotifier(m_descriptor);
+                m_watching = false;
+                m_events = events;
+                m_continuation.resume();
+                return true;
+            });
+            return m_watching;
+        }
+        uint32_t await_resume() const { return m_events; }
+
+    private:
+        Continuation m_continuation;
+        EventLoop * const m_loop;
+        const int m_descriptor;
+        uint32_t m_events = 0;
+        bool m_watching = false;
+    };
+
     EventLoop();
     ~EventLoop();
 
@@ -58,6 +136,15 @@ public:
 
     void exit(int result = EXIT_SUCCESS);
 
+    Clock *clock() const { return m_clock; }
+    void setClock(Clock *clock);
+    int64_t currentTime() const { return m_clock->currentTime(); }
+
+    void advance(int64_t interval);
+
+    Watchdog *watchdog() const { return m_watchdog; }
+    void setWatchdog(Watchdog *watchdog);
+
     int createTimer(int interval, const std::function<void()> &callback);
     void cancelTimer(int id);
 
@@ -68,6 +155,9 @@ public:
     bool addNotifierCallback(int descriptor, const std::function<NotifierCallbackType> &callback);
     void removeNotifier(int descriptor);
 
+    Sleep sleep(int interval);
+    Readable readable(int descriptor);
+
 protected:
     void createTimer(int interval, void *data);
     void cancelTimer(void *data);
@@ -80,6 +170,7 @@ protected:
     virtual bool dispatch();
 
 private:
+    friend class InputRecorder;
     friend class Window;
 
     struct Notifier {
@@ -103,6 +194,9 @@ private:
     };
 
     inline void insertTimer(const Timer &timer);
+    inline int64_t runExpiredTimer();
+    inline void runTimer(std::vector<Timer>::iterator position);
+    inline void processPendingEvents();
     inline void setWindow(Window *window);
 
     static inline int ev_input_callback(int fd, uint32_t epevents, void *data);
@@ -113,7 +207,12 @@ private:
     std::vector<Timer> m_timers;
     std::vector<std::function<void()>> m_singleShots;
     std::function<void()> m_terminated;
+    MonotonicClock m_monotonicClock;
+    Clock *m_clock;
+    Watchdog *m_watchdog;
+    InputRecorder *m_recorder;
     Window *m_window;
+    const int m_notifierFd;
     int m_result;
     bool m_executing;
 };
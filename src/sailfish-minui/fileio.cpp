@@ -0,0 +1,888 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "fileio.h"
+#include "logging.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define SAILFISH_MINUI_HAVE_IO_URING
+#endif
+#endif
+
+namespace Sailfish { namespace MinUi {
+
+class FileIOBackend
+{
+public:
+    struct Completion
+    {
+        uint64_t tag;
+        int result;
+    };
+
+    FileIOBackend()
+        : m_eventFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    {
+    }
+
+    virtual ~FileIOBackend()
+    {
+        if (m_eventFd >= 0) {
+            ::close(m_eventFd);
+        }
+    }
+
+    static FileIOBackend *create(char *buffers, int count, size_t size);
+
+    virtual const char *name() const = 0;
+
+    virtual void read(int descriptor, int buffer, char *data, size_t length, int64_t offset, uint64_t tag) = 0;
+    virtual void write(int descriptor, int buffer, char *data, size_t length, int64_t offset, uint64_t tag) = 0;
+    virtual void sync(int descriptor, uint64_t tag) = 0;
+    virtual void submit() = 0;
+    virtual int complete(Completion *completions, int maximum) = 0;
+    virtual void wait() = 0;
+
+    int descriptor() const { return m_eventFd; }
+
+    void wake()
+    {
+        const uint64_t value = 1;
+        if (::write(m_eventFd, &value, sizeof(value)) != sizeof(value)) {
+            log_err("FileIO: Failed to signal completion descriptor. " << strerror(errno));
+        }
+    }
+
+protected:
+    void clearWake()
+    {
+        uint64_t value;
+        while (::read(m_eventFd, &value, sizeof(value)) < 0 && errno == EINTR) {
+        }
+    }
+
+    const int m_eventFd;
+};
+
+#if defined(SAILFISH_MINUI_HAVE_IO_URING)
+
+class UringBackend : public FileIOBackend
+{
+public:
+    UringBackend(char *buffers, int count, size_t size)
+        : m_iovecs(count)
+    {
+        io_uring_params parameters;
+        memset(&parameters, 0, sizeof(parameters));
+
+        m_fd = ::syscall(__NR_io_uring_setup, Entries, &parameters);
+        if (m_fd < 0) {
+            return;
+        }
+
+        m_sqRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+        m_cqRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = parameters.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap) {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+
+        m_sqRing = map(m_sqRingSize, IORING_OFF_SQ_RING);
+        m_cqRing = singleMap ? m_sqRing : map(m_cqRingSize, IORING_OFF_CQ_RING);
+        m_sqesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = static_cast<io_uring_sqe *>(map(m_sqesSize, IORING_OFF_SQES));
+
+        if (!m_sqRing || !m_cqRing || !m_sqes || m_eventFd < 0) {
+            release();
+            return;
+        }
+
+        m_sqHead = ring<unsigned>(m_sqRing, parameters.sq_off.head);
+        m_sqTail = ring<unsigned>(m_sqRing, parameters.sq_off.tail);
+        m_sqMask = *ring<unsigned>(m_sqRing, parameters.sq_off.ring_mask);
+        m_sqArray = ring<unsigned>(m_sqRing, parameters.sq_off.array);
+        m_sqEntries = parameters.sq_entries;
+        m_cqHead = ring<unsigned>(m_cqRing, parameters.cq_off.head);
+        m_cqTail = ring<unsigned>(m_cqRing, parameters.cq_off.tail);
+        m_cqMask = *ring<unsigned>(m_cqRing, parameters.cq_off.ring_mask);
+        m_cqes = ring<io_uring_cqe>(m_cqRing, parameters.cq_off.cqes);
+
+        const int eventFd = m_eventFd;
+        if (::syscall(__NR_io_uring_register, m_fd, IORING_REGISTER_EVENTFD, &eventFd, 1) < 0) {
+            release();
+            return;
+        }
+
+        // Registering the buffers pins them once up front rather than on every request, it
+        // can fail if the locked memory limit is low in which case plain vectored I/O is used.
+        for (int i = 0; i < count; ++i) {
+            m_iovecs[i].iov_base = buffers + i * size;
+            m_iovecs[i].iov_len = size;
+        }
+        m_fixedBuffers = ::syscall(
+                    __NR_io_uring_register, m_fd, IORING_REGISTER_BUFFERS, m_iovecs.data(), count) == 0;
+    }
+
+    ~UringBackend()
+    {
+        release();
+    }
+
+    bool isValid() const { return m_fd >= 0; }
+
+    const char *name() const override { return m_fixedBuffers ? "io_uring (fixed buffers)" : "io_uring"; }
+
+    void read(int descriptor, int buffer, char *data, size_t length, int64_t offset, uint64_t tag) override
+    {
+        transfer(m_fixedBuffers ? IORING_OP_READ_FIXED : IORING_OP_READV, descriptor, buffer, data, length, offset, tag);
+    }
+
+    void write(int descriptor, int buffer, char *data, size_t length, int64_t offset, uint64_t tag) override
+    {
+        transfer(m_fixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITEV, descriptor, buffer, data, length, offset, tag);
+    }
+
+    void sync(int descriptor, uint64_t tag) override
+    {
+        io_uring_sqe * const entry = acquire();
+        entry->opcode = IORING_OP_FSYNC;
+        entry->fd = descriptor;
+        entry->fsync_flags = IORING_FSYNC_DATASYNC;
+        entry->user_data = tag;
+        commit();
+    }
+
+    void submit() override
+    {
+        while (m_queued > 0) {
+            const long submitted = ::syscall(__NR_io_uring_enter, m_fd, m_queued, 0, 0, nullptr, 0);
+            if (submitted > 0) {
+                m_queued -= submitted;
+            } else if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                log_err("FileIO: Failed to submit I/O requests. " << strerror(errno));
+                return;
+            }
+        }
+    }
+
+    int complete(Completion *completions, int maximum) override
+    {
+        clearWake();
+
+        unsigned head = *m_cqHead;
+        const unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+
+        int count = 0;
+        for (; head != tail && count < maximum; ++head, ++count) {
+            const io_uring_cqe &entry = m_cqes[head & m_cqMask];
+            completions[count].tag = entry.user_data;
+            completions[count].result = entry.res;
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+        return count;
+    }
+
+    void wait() override
+    {
+        while (::syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0
+                && errno == EINTR) {
+        }
+    }
+
+private:
+    enum { Entries = 32 };
+
+    template <typename T>
+    static T *ring(void *base, uint32_t offset)
+    {
+        return reinterpret_cast<T *>(static_cast<char *>(base) + offset);
+    }
+
+    void *map(size_t size, off_t offset)
+    {
+        void * const address = ::mmap(
+                    nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, offset);
+        return address != MAP_FAILED ? address : nullptr;
+    }
+
+    void release()
+    {
+        if (m_sqes) {
+            ::munmap(m_sqes, m_sqesSize);
+            m_sqes = nullptr;
+        }
+        if (m_cqRing && m_cqRing != m_sqRing) {
+            ::munmap(m_cqRing, m_cqRingSize);
+        }
+        m_cqRing = nullptr;
+        if (m_sqRing) {
+            ::munmap(m_sqRing, m_sqRingSize);
+            m_sqRing = nullptr;
+        }
+        if (m_fd >= 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+
+    io_uring_sqe *acquire()
+    {
+        if (*m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) >= m_sqEntries) {
+            submit();
+        }
+
+        io_uring_sqe * const entry = &m_sqes[*m_sqTail & m_sqMask];
+        memset(entry, 0, sizeof(*entry));
+        return entry;
+    }
+
+    void commit()
+    {
+        const unsigned tail = *m_sqTail;
+        m_sqArray[tail & m_sqMask] = tail & m_sqMask;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++m_queued;
+    }
+
+    void transfer(
+            uint8_t opcode, int descriptor, int buffer, char *data, size_t length, int64_t offset, uint64_t tag)
+    {
+        io_uring_sqe * const entry = acquire();
+        entry->opcode = opcode;
+        entry->fd = descriptor;
+        entry->off = offset;
+        entry->user_data = tag;
+
+        if (m_fixedBuffers) {
+            entry->addr = reinterpret_cast<uintptr_t>(data);
+            entry->len = length;
+            entry->buf_index = buffer;
+        } else {
+            m_iovecs[buffer].iov_base = data;
+            m_iovecs[buffer].iov_len = length;
+            entry->addr = reinterpret_cast<uintptr_t>(&m_iovecs[buffer]);
+            entry->len = 1;
+        }
+        commit();
+    }
+
+    std::vector<iovec> m_iovecs;
+    void *m_sqRing = nullptr;
+    void *m_cqRing = nullptr;
+    io_uring_sqe *m_sqes = nullptr;
+    io_uring_cqe *m_cqes = nullptr;
+    unsigned *m_sqHead = nullptr;
+    unsigned *m_sqTail = nullptr;
+    unsigned *m_sqArray = nullptr;
+    unsigned *m_cqHead = nullptr;
+    unsigned *m_cqTail = nullptr;
+    size_t m_sqRingSize = 0;
+    size_t m_cqRingSize = 0;
+    size_t m_sqesSize = 0;
+    unsigned m_sqMask = 0;
+    unsigned m_sqEntries = 0;
+    unsigned m_cqMask = 0;
+    unsigned m_queued = 0;
+    int m_fd = -1;
+    bool m_fixedBuffers = false;
+};
+
+#endif
+
+class ThreadPoolBackend : public FileIOBackend
+{
+public:
+    ThreadPoolBackend()
+    {
+        const int count = std::max(2u, std::min(4u, std::thread::hardware_concurrency()));
+        for (int i = 0; i < count; ++i) {
+            m_threads.emplace_back([this]() { run(); });
+        }
+    }
+
+    ~ThreadPoolBackend()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_quit = true;
+        }
+        m_condition.notify_all();
+
+        for (std::thread &thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    const char *name() const override { return "thread pool"; }
+
+    void read(int descriptor, int, char *data, size_t length, int64_t offset, uint64_t tag) override
+    {
+        m_queued.push_back({ Request::Read, descriptor, data, length, offset, tag });
+    }
+
+    void write(int descriptor, int, char *data, size_t length, int64_t offset, uint64_t tag) override
+    {
+        m_queued.push_back({ Request::Write, descriptor, data, length, offset, tag });
+    }
+
+    void sync(int descriptor, uint64_t tag) override
+    {
+        m_queued.push_back({ Request::Sync, descriptor, nullptr, 0, 0, tag });
+    }
+
+    void submit() override
+    {
+        if (m_queued.empty()) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.insert(m_requests.end(), m_queued.begin(), m_queued.end());
+        }
+        m_queued.clear();
+        m_condition.notify_all();
+    }
+
+    int complete(Completion *completions, int maximum) override
+    {
+        clearWake();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const int count = std::min<int>(maximum, m_completions.size());
+        std::copy(m_completions.begin(), m_completions.begin() + count, completions);
+        m_completions.erase(m_completions.begin(), m_completions.begin() + count);
+
+        return count;
+    }
+
+    void wait() override
+    {
+        pollfd descriptor = { m_eventFd, POLLIN, 0 };
+        while (::poll(&descriptor, 1, -1) < 0 && errno == EINTR) {
+        }
+    }
+
+private:
+    struct Request
+    {
+        enum Type { Read, Write, Sync } type;
+        int descriptor;
+        char *data;
+        size_t length;
+        int64_t offset;
+        uint64_t tag;
+    };
+
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_condition.wait(lock, [this]() { return m_quit || !m_requests.empty(); });
+            if (m_quit) {
+                return;
+            }
+
+            const Request request = m_requests.front();
+            m_requests.pop_front();
+
+            lock.unlock();
+
+            ssize_t result = 0;
+            switch (request.type) {
+            case Request::Read:
+                result = ::pread(request.descriptor, request.data, request.length, request.offset);
+                break;
+            case Request::Write:
+                result = ::pwrite(request.descriptor, request.data, request.length, request.offset);
+                break;
+            case Request::Sync:
+                result = ::fdatasync(request.descriptor);
+                break;
+            }
+
+            lock.lock();
+            m_completions.push_back({ request.tag, int(result < 0 ? -errno : result) });
+            wake();
+        }
+    }
+
+    std::vector<Request> m_queued;
+    std::deque<Request> m_requests;
+    std::vector<Completion> m_completions;
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_quit = false;
+};
+
+FileIOBackend *FileIOBackend::create(char *buffers, int count, size_t size)
+{
+#if defined(SAILFISH_MINUI_HAVE_IO_URING)
+    const char * const env = getenv("SAILFISH_MINUI_FILEIO");
+    if (!env || strcmp(env, "threads") != 0) {
+        UringBackend * const backend = new UringBackend(buffers, count, size);
+        if (backend->isValid()) {
+            return backend;
+        }
+        log_debug("FileIO: io_uring is unavailable, using a thread pool. " << strerror(errno));
+        delete backend;
+    }
+#else
+    (void)buffers;
+    (void)count;
+    (void)size;
+#endif
+    return new ThreadPoolBackend;
+}
+
+static const uint64_t syncTag = ~uint64_t(0);
+
+/*!
+    \class Sailfish::MinUi::FileIO
+    \brief Copies or compares large files without blocking the event loop.
+
+    Transfers are split into blocks which are read and written asynchronously with several
+    requests in flight at once.  Where the kernel supports it requests are submitted in batches
+    through an io_uring with buffers registered once when the FileIO is constructed, otherwise
+    they're serviced by a small pool of worker threads.  Setting the SAILFISH_MINUI_FILEIO
+    environment variable to \c threads forces the thread pool.
+
+    Completions are processed on the event loop thread which is also where the \l onProgress()
+    and \l onFinished() callbacks are invoked. Only one operation can be active at a time.
+*/
+
+/*!
+    \enum Sailfish::MinUi::FileIO::Result
+
+    \value Succeeded The operation completed, for a comparison the files are identical.
+    \value Failed The operation failed, \l error() holds the error number.
+    \value Mismatch The compared files differ.
+    \value Canceled The operation was canceled with \l cancel().
+*/
+
+/*!
+    Constructs a new file I/O object which delivers completions through an \a eventLoop.
+*/
+FileIO::FileIO(EventLoop *eventLoop)
+    : m_eventLoop(eventLoop)
+{
+    void *buffers = nullptr;
+    if (posix_memalign(&buffers, 4096, size_t(BufferCount) * BlockSize) != 0) {
+        log_err("FileIO: Failed to allocate transfer buffers.");
+        return;
+    }
+    m_buffers = static_cast<char *>(buffers);
+    m_backend = FileIOBackend::create(m_buffers, BufferCount, BlockSize);
+
+    m_eventLoop->addNotifierCallback(m_backend->descriptor(), [this](int, uint32_t) {
+        handleCompletions();
+        return true;
+    });
+}
+
+/*!
+    Destroys a file I/O object.
+
+    If an operation is active it is canceled and any requests still in flight are waited for
+    before the buffers are released, the finished callback is not invoked.
+*/
+FileIO::~FileIO()
+{
+    if (m_operation != NoOperation) {
+        m_progress = nullptr;
+        m_finished = nullptr;
+        m_result = Canceled;
+
+        FileIOBackend::Completion completions[BufferCount + 1];
+        while (m_inFlight > 0) {
+            m_backend->submit();
+            m_backend->wait();
+            m_inFlight -= m_backend->complete(completions, BufferCount + 1);
+        }
+        closeFiles();
+    }
+
+    if (m_backend) {
+        m_eventLoop->removeNotifier(m_backend->descriptor());
+        delete m_backend;
+    }
+    free(m_buffers);
+}
+
+/*!
+    Starts copying the file at \a source to \a destination, replacing any existing file.
+
+    Returns false if either file could not be opened in which case \l error() holds the error
+    number, or if another operation is already active.  The destination is synced to storage
+    before the copy is reported as succeeded.  If the copy fails or is canceled a partially
+    written destination file is left behind.
+*/
+bool FileIO::copy(const char *source, const char *destination)
+{
+    if (m_operation != NoOperation) {
+        log_warning("FileIO: Cannot start a copy while another operation is active.");
+        return false;
+    }
+
+    m_fds[0] = ::open(source, O_RDONLY | O_CLOEXEC);
+
+    struct stat sourceStatus;
+    if (m_fds[0] < 0 || ::fstat(m_fds[0], &sourceStatus) != 0) {
+        m_error = errno;
+        closeFiles();
+        return false;
+    }
+
+    // The destination is only truncated once it's known to not be the source.
+    m_fds[1] = ::open(destination, O_WRONLY | O_CREAT | O_CLOEXEC, sourceStatus.st_mode & 0777);
+
+    struct stat destinationStatus;
+    if (m_fds[1] < 0 || ::fstat(m_fds[1], &destinationStatus) != 0) {
+        m_error = errno;
+        closeFiles();
+        return false;
+    } else if (sourceStatus.st_dev == destinationStatus.st_dev
+            && sourceStatus.st_ino == destinationStatus.st_ino) {
+        m_error = EINVAL;
+        closeFiles();
+        return false;
+    } else if (::ftruncate(m_fds[1], 0) != 0) {
+        m_error = errno;
+        closeFiles();
+        return false;
+    }
+
+    ::posix_fadvise(m_fds[0], 0, 0, POSIX_FADV_SEQUENTIAL);
+    if (sourceStatus.st_size > 0) {
+        ::fallocate(m_fds[1], 0, 0, sourceStatus.st_size);
+    }
+
+    return start(Copy, sourceStatus.st_size, Succeeded);
+}
+
+/*!
+    Starts comparing the contents of the files at \a first and \a second.
+
+    Returns false if either file could not be opened in which case \l error() holds the error
+    number, or if another operation is already active.  Files of different sizes finish with
+    a mismatch without any data being read.
+*/
+bool FileIO::compare(const char *first, const char *second)
+{
+    if (m_operation != NoOperation) {
+        log_warning("FileIO: Cannot start a comparison while another operation is active.");
+        return false;
+    }
+
+    struct stat status[2];
+    for (int i = 0; i < 2; ++i) {
+        m_fds[i] = ::open(i == 0 ? first : second, O_RDONLY | O_CLOEXEC);
+        if (m_fds[i] < 0 || ::fstat(m_fds[i], &status[i]) != 0) {
+            m_error = errno;
+            closeFiles();
+            return false;
+        }
+        ::posix_fadvise(m_fds[i], 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+
+    return status[0].st_size == status[1].st_size
+            ? start(Compare, status[0].st_size, Succeeded)
+            : start(Compare, 0, Mismatch);
+}
+
+/*!
+    Cancels the active operation.
+
+    Requests already in flight are allowed to complete after which the finished callback is
+    invoked with a Canceled result.
+*/
+void FileIO::cancel()
+{
+    if (m_operation == NoOperation) {
+        return;
+    }
+
+    if (m_result == Succeeded) {
+        m_result = Canceled;
+    }
+    if (m_inFlight == 0) {
+        m_backend->wake();
+    }
+}
+
+/*!
+    Returns the name of the I/O backend in use.
+*/
+const char *FileIO::backendName() const
+{
+    return m_backend ? m_backend->name() : "none";
+}
+
+/*!
+    Sets a \a callback which is invoked with the number of bytes processed and the total
+    whenever an operation makes progress.
+
+    Progress is reported at most once per event loop wake up regardless of how many blocks
+    completed.
+*/
+void FileIO::onProgress(const std::function<void(int64_t processed, int64_t total)> &callback)
+{
+    m_progress = callback;
+}
+
+/*!
+    Sets a \a callback which is invoked with the result when an operation finishes.
+*/
+void FileIO::onFinished(const std::function<void(Result result)> &callback)
+{
+    m_finished = callback;
+}
+
+bool FileIO::start(Operation operation, int64_t total, Result result)
+{
+    if (!m_backend) {
+        m_error = ENOMEM;
+        closeFiles();
+        return false;
+    }
+
+    m_operation = operation;
+    m_result = result;
+    m_total = total;
+    m_processed = 0;
+    m_nextOffset = 0;
+    m_error = 0;
+    m_syncing = false;
+    m_synced = false;
+
+    schedule();
+    m_backend->submit();
+
+    // Always finish from the event loop, even if there's nothing to transfer.
+    if (m_inFlight == 0) {
+        m_backend->wake();
+    }
+
+    return true;
+}
+
+void FileIO::schedule()
+{
+    for (int index = 0; index < QueueDepth && m_result == Succeeded && m_nextOffset < m_total; ++index) {
+        Slot &slot = m_slots[index];
+        if (slot.state != Idle) {
+            continue;
+        }
+
+        slot.offset = m_nextOffset;
+        slot.length = size_t(std::min<int64_t>(BlockSize, m_total - m_nextOffset));
+        slot.done[0] = 0;
+        slot.done[1] = 0;
+        slot.state = Reading;
+        m_nextOffset += slot.length;
+
+        request(index, 0);
+        if (m_operation == Compare) {
+            request(index, 1);
+        }
+    }
+}
+
+void FileIO::request(int index, int buffer)
+{
+    Slot &slot = m_slots[index];
+
+    const int bufferIndex = (index * 2) + buffer;
+    char * const data = m_buffers + (size_t(bufferIndex) * BlockSize) + slot.done[buffer];
+    const size_t length = slot.length - slot.done[buffer];
+    const int64_t offset = slot.offset + slot.done[buffer];
+
+    if (slot.state == Writing) {
+        m_backend->write(m_fds[1], bufferIndex, data, length, offset, bufferIndex);
+    } else {
+        m_backend->read(m_fds[buffer], bufferIndex, data, length, offset, bufferIndex);
+    }
+
+    ++slot.pending;
+    ++m_inFlight;
+}
+
+void FileIO::completed(uint64_t tag, int result)
+{
+    --m_inFlight;
+
+    if (tag == syncTag) {
+        m_syncing = false;
+        m_synced = true;
+        if (result < 0) {
+            fail(-result);
+        }
+        return;
+    }
+
+    const int index = int(tag / 2);
+    const int buffer = int(tag % 2);
+    Slot &slot = m_slots[index];
+
+    --slot.pending;
+
+    if (m_result == Succeeded) {
+        if (result == -EINTR || result == -EAGAIN) {
+            request(index, buffer);
+            return;
+        } else if (result < 0) {
+            fail(-result);
+        } else if (result == 0) {
+            // The file was truncated underneath us, or the device is full.
+            fail(slot.state == Writing ? ENOSPC : EIO);
+        } else if ((slot.done[buffer] += result) < slot.length) {
+            request(index, buffer);
+            return;
+        }
+    }
+
+    if (slot.pending > 0) {
+        return;
+    } else if (m_result != Succeeded) {
+        slot.state = Idle;
+    } else if (m_operation == Copy && slot.state == Reading) {
+        slot.state = Writing;
+        slot.done[0] = 0;
+        request(index, 0);
+    } else {
+        slot.state = Idle;
+
+        if (m_operation == Compare) {
+            const char * const first = m_buffers + (size_t(index) * 2 * BlockSize);
+            if (memcmp(first, first + BlockSize, slot.length) != 0) {
+                m_result = Mismatch;
+                return;
+            }
+        }
+        m_processed += slot.length;
+    }
+}
+
+void FileIO::fail(int error)
+{
+    if (m_result == Succeeded) {
+        m_result = Failed;
+        m_error = error;
+    }
+}
+
+void FileIO::handleCompletions()
+{
+    const int64_t processed = m_processed;
+
+    FileIOBackend::Completion completions[BufferCount + 1];
+    for (int count; (count = m_backend->complete(completions, BufferCount + 1)) > 0;) {
+        for (int i = 0; i < count; ++i) {
+            completed(completions[i].tag, completions[i].result);
+        }
+    }
+
+    if (m_operation == NoOperation) {
+        return;
+    }
+
+    schedule();
+    m_backend->submit();
+
+    if (m_processed != processed && m_progress) {
+        m_progress(m_processed, m_total);
+    }
+
+    checkFinished();
+}
+
+void FileIO::checkFinished()
+{
+    if (m_operation == NoOperation || m_inFlight > 0 || m_syncing) {
+        return;
+    } else if (m_result == Succeeded && m_operation == Copy && !m_synced) {
+        m_syncing = true;
+        ++m_inFlight;
+        m_backend->sync(m_fds[1], syncTag);
+        m_backend->submit();
+        return;
+    }
+
+    closeFiles();
+
+    const Result result = m_result;
+    m_operation = NoOperation;
+
+    if (m_finished) {
+        m_finished(result);
+    }
+}
+
+void FileIO::closeFiles()
+{
+    for (int &fd : m_fds) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+}}
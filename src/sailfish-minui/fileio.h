@@ -0,0 +1,137 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_FILEIO_H
+#define SAILFISH_MINUI_FILEIO_H
+
+#include <sailfish-minui/eventloop.h>
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Sailfish { namespace MinUi {
+
+class FileIOBackend;
+
+class FileIO
+{
+public:
+    enum Operation {
+        NoOperation,
+        Copy,
+        Compare
+    };
+
+    enum Result {
+        Succeeded,
+        Failed,
+        Mismatch,
+        Canceled
+    };
+
+    explicit FileIO(EventLoop *eventLoop = EventLoop::instance());
+    FileIO(const FileIO &) = delete;
+    ~FileIO();
+
+    FileIO &operator =(const FileIO &) = delete;
+
+    bool copy(const char *source, const char *destination);
+    bool compare(const char *first, const char *second);
+    void cancel();
+
+    Operation operation() const { return m_operation; }
+    bool isActive() const { return m_operation != NoOperation; }
+
+    int64_t processed() const { return m_processed; }
+    int64_t total() const { return m_total; }
+    int error() const { return m_error; }
+
+    const char *backendName() const;
+
+    void onProgress(const std::function<void(int64_t processed, int64_t total)> &callback);
+    void onFinished(const std::function<void(Result result)> &callback);
+
+private:
+    enum {
+        QueueDepth = 8,
+        BufferCount = 2 * QueueDepth,
+        BlockSize = 256 * 1024
+    };
+
+    enum SlotState {
+        Idle,
+        Reading,
+        Writing
+    };
+
+    struct Slot {
+        int64_t offset = 0;
+        size_t length = 0;
+        size_t done[2] = { 0, 0 };
+        int pending = 0;
+        SlotState state = Idle;
+    };
+
+    inline bool start(Operation operation, int64_t total, Result result);
+    inline void schedule();
+    inline void request(int index, int buffer);
+    inline void completed(uint64_t tag, int result);
+    inline void fail(int error);
+    inline void handleCompletions();
+    inline void checkFinished();
+    inline void closeFiles();
+
+    std::function<void(int64_t processed, int64_t total)> m_progress;
+    std::function<void(Result result)> m_finished;
+    EventLoop * const m_eventLoop;
+    FileIOBackend *m_backend = nullptr;
+    char *m_buffers = nullptr;
+    Slot m_slots[QueueDepth];
+    int64_t m_total = 0;
+    int64_t m_processed = 0;
+    int64_t m_nextOffset = 0;
+    int m_inFlight = 0;
+    int m_fds[2] = { -1, -1 };
+    int m_error = 0;
+    Operation m_operation = NoOperation;
+    Result m_result = Succeeded;
+    bool m_syncing = false;
+    bool m_synced = false;
+};
+
+}}
+
+#endif
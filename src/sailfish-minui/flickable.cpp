@@ -0,0 +1,370 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "flickable.h"
+#include "eventloop.h"
+#include "touchresampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Sailfish { namespace MinUi {
+
+/*!
+    \class Sailfish::MinUi::Flickable
+    \brief A view which can be dragged and flicked to scroll content larger than itself.
+
+    Items are added to the \l contentItem() which is positioned by the \l contentX() and
+    \l contentY() scroll position.  Dragging the flickable scrolls the content with the touch,
+    and releasing it while moving flicks the content with the velocity of the touch which
+    then decays exponentially.  A touch which starts as a press of a child item such as a
+    button becomes a drag once it has moved the theme's start drag distance.
+
+    Scroll updates are made as the window delivers touch moves and at the same interval
+    while flicking, so a scroll costs at most one frame per display refresh.  Nothing is
+    moved but the content item, the positions of the children within it are unchanged.
+
+    A flickable clips its content to its bounds, so content which is scrolled out of view
+    is neither drawn over neighbouring items nor drawn at all.
+*/
+
+/*!
+    \enum Sailfish::MinUi::Flickable::FlickDirection
+
+    \value HorizontalFlick The content can be scrolled horizontally.
+    \value VerticalFlick The content can be scrolled vertically.
+    \value HorizontalAndVerticalFlick The content can be scrolled in both directions.
+*/
+
+/*!
+    Constructs a flickable.
+
+    If a \a parent argument is supplied the new item will be appended as a child of that item.
+*/
+Flickable::Flickable(Item *parent)
+    : ResizeableItem(parent)
+    , m_contentItem(this)
+{
+    setAcceptsDrags(true);
+    setClip(true);
+}
+
+/*!
+    Destroys a flickable.
+*/
+Flickable::~Flickable()
+{
+    cancelFlick();
+}
+
+/*!
+    \fn Sailfish::MinUi::ContainerItem *Sailfish::MinUi::Flickable::contentItem()
+
+    Returns the item which contains the scrolled content.
+*/
+
+/*!
+    \fn int Sailfish::MinUi::Flickable::contentWidth() const
+
+    Returns the width of the scrolled content.
+*/
+
+/*!
+    Sets the \a width of the scrolled content.
+
+    If the flickable doesn't scroll horizontally the content is the width of the flickable.
+*/
+void Flickable::setContentWidth(int width)
+{
+    m_contentItem.setWidth(width);
+    moveContent(m_contentX, m_contentY);
+}
+
+/*!
+    \fn int Sailfish::MinUi::Flickable::contentHeight() const
+
+    Returns the height of the scrolled content.
+*/
+
+/*!
+    Sets the \a height of the scrolled content.
+
+    If the flickable doesn't scroll vertically the content is the height of the flickable.
+*/
+void Flickable::setContentHeight(int height)
+{
+    m_contentItem.setHeight(height);
+    moveContent(m_contentX, m_contentY);
+}
+
+/*!
+    \fn int Sailfish::MinUi::Flickable::contentX() const
+
+    Returns the horizontal position of the left of the view within the content.
+*/
+
+/*!
+    Scrolls the content so the left of the view is at the horizontal position \a x within it.
+
+    The position is bounded by the left and right edges of the content.
+*/
+void Flickable::setContentX(int x)
+{
+    moveContent(x, m_contentY);
+}
+
+/*!
+    \fn int Sailfish::MinUi::Flickable::contentY() const
+
+    Returns the vertical position of the top of the view within the content.
+*/
+
+/*!
+    Scrolls the content so the top of the view is at the vertical position \a y within it.
+
+    The position is bounded by the top and bottom edges of the content.
+*/
+void Flickable::setContentY(int y)
+{
+    moveContent(m_contentX, y);
+}
+
+/*!
+    \fn Sailfish::MinUi::Flickable::FlickDirection Sailfish::MinUi::Flickable::flickDirection() const
+
+    Returns the directions the content can be dragged and flicked in.  The default is
+    vertically.
+*/
+
+/*!
+    Sets the \a direction the content can be dragged and flicked in.
+*/
+void Flickable::setFlickDirection(FlickDirection direction)
+{
+    if (m_flickDirection != direction) {
+        m_flickDirection = direction;
+        invalidate(Layout);
+    }
+}
+
+/*!
+    \fn bool Sailfish::MinUi::Flickable::isDragging() const
+
+    Returns true if the content is being dragged.
+*/
+
+/*!
+    \fn bool Sailfish::MinUi::Flickable::isFlicking() const
+
+    Returns true if the content is moving after being flicked.
+*/
+
+/*!
+    Flicks the content with an initial velocity of \a velocityX, \a velocityY pixels per
+    second.
+
+    The velocity decays exponentially and the flick stops when it becomes imperceptible or the
+    content reaches its edge.
+*/
+void Flickable::flick(float velocityX, float velocityY)
+{
+    cancelFlick();
+
+    const float maximumVelocity = theme.scale(8000);
+    const float minimumVelocity = theme.scale(50);
+
+    m_velocityX = m_flickDirection & HorizontalFlick
+            ? std::max(-maximumVelocity, std::min(velocityX, maximumVelocity))
+            : 0.f;
+    m_velocityY = m_flickDirection & VerticalFlick
+            ? std::max(-maximumVelocity, std::min(velocityY, maximumVelocity))
+            : 0.f;
+
+    EventLoop * const eventLoop = Item::eventLoop();
+    if (!eventLoop || (std::abs(m_velocityX) < minimumVelocity && std::abs(m_velocityY) < minimumVelocity)) {
+        return;
+    }
+
+    m_flickTime = eventLoop->currentTime();
+    m_flickX = m_contentX;
+    m_flickY = m_contentY;
+    m_flickTimerId = eventLoop->createTimer(FlickInterval, [this]() {
+        updateFlick();
+    });
+}
+
+/*!
+    Stops a flick.
+*/
+void Flickable::cancelFlick()
+{
+    if (m_flickTimerId != 0) {
+        if (EventLoop * const eventLoop = Item::eventLoop()) {
+            eventLoop->cancelTimer(m_flickTimerId);
+        }
+        m_flickTimerId = 0;
+    }
+}
+
+/*!
+    Stops a flick when the flickable is pressed, the touch then drags the content and doesn't
+    press the item under it.
+*/
+bool Flickable::dragPressed(int, int)
+{
+    if (isFlicking()) {
+        cancelFlick();
+        return true;
+    }
+    return false;
+}
+
+/*!
+    Starts dragging the content from the touch position \a x, \a y.
+*/
+void Flickable::dragStarted(int x, int y)
+{
+    cancelFlick();
+
+    m_dragging = true;
+    m_dragX = x;
+    m_dragY = y;
+    m_dragContentX = m_contentX;
+    m_dragContentY = m_contentY;
+}
+
+/*!
+    Scrolls the content with the touch moved to \a x, \a y.
+*/
+void Flickable::dragMoved(int x, int y)
+{
+    moveContent(
+                m_flickDirection & HorizontalFlick ? m_dragContentX - (x - m_dragX) : m_contentX,
+                m_flickDirection & VerticalFlick ? m_dragContentY - (y - m_dragY) : m_contentY);
+}
+
+/*!
+    Finishes a drag released at \a x, \a y and flicks the content with the velocity of the
+    touch if it was \a dragged.
+*/
+void Flickable::dragReleased(int x, int y, bool dragged)
+{
+    if (!dragged) {
+        return;
+    }
+
+    dragMoved(x, y);
+    m_dragging = false;
+
+    if (Window * const window = Item::window()) {
+        // The content moves opposite to the direction its position increases in.
+        const TouchResampler::Velocity velocity = TouchResampler().velocity(window->touchHistory());
+        flick(-velocity.x, -velocity.y);
+    }
+}
+
+/*!
+    Sizes the content to the flickable in directions it doesn't scroll in and keeps the
+    scroll position within the bounds of the content.
+*/
+void Flickable::layout()
+{
+    if (!(m_flickDirection & HorizontalFlick)) {
+        m_contentItem.setWidth(width());
+    }
+    if (!(m_flickDirection & VerticalFlick)) {
+        m_contentItem.setHeight(height());
+    }
+
+    moveContent(m_contentX, m_contentY);
+}
+
+/*!
+    Called when the scroll position of the content changes.
+*/
+void Flickable::contentMoved()
+{
+}
+
+/*
+    Moves the content to the scroll position \a x, \a y bounded by the size of the content.
+*/
+void Flickable::moveContent(int x, int y)
+{
+    x = std::max(0, std::min(x, contentWidth() - width()));
+    y = std::max(0, std::min(y, contentHeight() - height()));
+
+    if (m_contentX != x || m_contentY != y || m_contentItem.x() != -x || m_contentItem.y() != -y) {
+        m_contentX = x;
+        m_contentY = y;
+        m_contentItem.move(-x, -y);
+
+        contentMoved();
+    }
+}
+
+/*
+    Advances a flick to the current time.  The velocity decays exponentially so the content
+    moves velocity * timeConstant * (1 - e^(-elapsed / timeConstant)) from where it was flicked.
+*/
+void Flickable::updateFlick()
+{
+    const float elapsed = eventLoop()->currentTime() - m_flickTime;
+    const float timeConstant = FlickTimeConstant;
+    const float decay = std::exp(-elapsed / timeConstant);
+    const float distance = (timeConstant / 1000.f) * (1.f - decay);
+
+    const int x = std::lround(m_flickX + (m_velocityX * distance));
+    const int y = std::lround(m_flickY + (m_velocityY * distance));
+
+    moveContent(x, y);
+
+    // An axis stops once it reaches an edge or its velocity becomes imperceptible.
+    const float minimumVelocity = theme.scale(50);
+    if (m_contentX != x || std::abs(m_velocityX * decay) < minimumVelocity) {
+        m_velocityX = 0;
+        m_flickX = m_contentX;
+    }
+    if (m_contentY != y || std::abs(m_velocityY * decay) < minimumVelocity) {
+        m_velocityY = 0;
+        m_flickY = m_contentY;
+    }
+    if (m_velocityX == 0 && m_velocityY == 0) {
+        cancelFlick();
+    }
+}
+
+}}
@@ -0,0 +1,116 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_FLICKABLE_H
+#define SAILFISH_MINUI_FLICKABLE_H
+
+#include <sailfish-minui/item.h>
+
+namespace Sailfish { namespace MinUi {
+
+class Flickable : public ResizeableItem
+{
+public:
+    enum FlickDirection {
+        HorizontalFlick = 0x01,
+        VerticalFlick = 0x02,
+        HorizontalAndVerticalFlick = HorizontalFlick | VerticalFlick
+    };
+
+    explicit Flickable(Item *parent = nullptr);
+    ~Flickable();
+
+    ContainerItem *contentItem() { return &m_contentItem; }
+
+    int contentWidth() const { return m_contentItem.width(); }
+    void setContentWidth(int width);
+
+    int contentHeight() const { return m_contentItem.height(); }
+    void setContentHeight(int height);
+
+    int contentX() const { return m_contentX; }
+    void setContentX(int x);
+
+    int contentY() const { return m_contentY; }
+    void setContentY(int y);
+
+    FlickDirection flickDirection() const { return m_flickDirection; }
+    void setFlickDirection(FlickDirection direction);
+
+    bool isDragging() const { return m_dragging; }
+    bool isFlicking() const { return m_flickTimerId != 0; }
+
+    void flick(float velocityX, float velocityY);
+    void cancelFlick();
+
+protected:
+    bool dragPressed(int x, int y) override;
+    void dragStarted(int x, int y) override;
+    void dragMoved(int x, int y) override;
+    void dragReleased(int x, int y, bool dragged) override;
+    void layout() override;
+
+    virtual void contentMoved();
+
+private:
+    enum {
+        FlickInterval = 16,
+        FlickTimeConstant = 325
+    };
+
+    inline void moveContent(int x, int y);
+    inline void updateFlick();
+
+    ContainerItem m_contentItem;
+    FlickDirection m_flickDirection = VerticalFlick;
+    int m_contentX = 0;
+    int m_contentY = 0;
+    int m_dragX = 0;
+    int m_dragY = 0;
+    int m_dragContentX = 0;
+    int m_dragContentY = 0;
+    bool m_dragging = false;
+    int m_flickTimerId = 0;
+    int64_t m_flickTime = 0;
+    float m_flickX = 0;
+    float m_flickY = 0;
+    float m_velocityX = 0;
+    float m_velocityY = 0;
+};
+
+}}
+
+#endif
@@ -37,12 +37,16 @@
 #include "icon.h"
 
 #include "logging.h"
+#include "surface.h"
 
 namespace Sailfish { namespace MinUi {
 
 /*!
     \class Sailfish::MinUi::Icon
     \brief A single color image.
+
+    An icon is initially the size of its image.  If it is resized the image is scaled to fit
+    from a copy decoded only while it is scaled, and the result is kept until the size changes.
 */
 
 /*!
@@ -51,14 +55,25 @@ namespace Sailfish { namespace MinUi {
     If a \a parent argument is supplied the new item will be appended as a child of that item.
 */
 Icon::Icon(const char *name, Item *parent)
-    : Item(parent)
+    : ResizeableItem(parent)
 {
-    const int result = res_create_alpha_surface(name, &m_icon);
+    gr_surface surface = nullptr;
+    const int result = res_create_alpha_surface(name, &surface);
     if (result != 0) {
         log_err("Failed to load icon " << name << " " << result);
     }
 
-    resize(gr_get_width(m_icon), gr_get_height(m_icon));
+    m_implicitWidth = gr_get_width(surface);
+    m_implicitHeight = gr_get_height(surface);
+    resize(m_implicitWidth, m_implicitHeight);
+
+    // Icons are mostly transparent or opaque pixels so they're kept run length encoded.
+    m_mask = encodeAlphaMask(surface);
+    if (m_mask) {
+        freeSurface(surface);
+    } else {
+        m_icon = surface;
+    }
 }
 
 /*!
@@ -66,7 +81,40 @@ Icon::Icon(const char *name, Item *parent)
 */
 Icon::~Icon()
 {
-    res_free_surface(m_icon);
+    freeAlphaMask(m_scaled);
+    freeAlphaMask(m_mask);
+    freeSurface(m_scaledIcon);
+    freeSurface(m_icon);
+}
+
+/*!
+    \fn Sailfish::MinUi::Icon::implicitWidth() const
+
+    Returns the width of the image of an icon.
+*/
+
+/*!
+    \fn Sailfish::MinUi::Icon::implicitHeight() const
+
+    Returns the height of the image of an icon.
+*/
+
+/*!
+    Composites an icon as it is drawn into the alpha surface \a target at \a x, \a y with the
+    given \a opacity.
+*/
+void Icon::composite(GRSurface *target, int x, int y, double opacity)
+{
+    if (width() != m_implicitWidth || height() != m_implicitHeight) {
+        if (scale()) {
+            compositeAlpha(target, x, y, m_scaled, opacity);
+            compositeAlpha(target, x, y, m_scaledIcon, opacity);
+        }
+    } else if (m_mask) {
+        compositeAlpha(target, x, y, m_mask, opacity);
+    } else {
+        compositeAlpha(target, x, y, m_icon, opacity);
+    }
 }
 
 /*!
@@ -84,17 +132,70 @@ void Icon::setColor(Color color)
     invalidate(Draw);
 }
 
+/*!
+    Scales the image to the current size if the size has changed.
+
+    The scaled image is kept run length encoded, or as a surface if it can't be encoded.  Returns
+    false if there is no image to scale.
+*/
+bool Icon::scale()
+{
+    if (m_scaled && m_scaled->width == width() && m_scaled->height == height()) {
+        return true;
+    } else if (m_scaledIcon && m_scaledIcon->width == width() && m_scaledIcon->height == height()) {
+        return true;
+    }
+
+    freeAlphaMask(m_scaled);
+    freeSurface(m_scaledIcon);
+    m_scaled = nullptr;
+    m_scaledIcon = nullptr;
+
+    // The box filter averages every pixel covered so a single pass from the full size image
+    // is as good as one from a mip level, and no full size copy outlives the scaling.
+    gr_surface decoded = m_mask ? decodeAlphaMask(m_mask) : nullptr;
+    const GRSurface * const image = decoded ? decoded : m_icon;
+    gr_surface scaled = image ? scaleSurface(image, width(), height()) : nullptr;
+
+    if (decoded) {
+        res_free_surface(decoded);
+    }
+
+    if (scaled) {
+        m_scaled = encodeAlphaMask(scaled);
+        if (m_scaled) {
+            res_free_surface(scaled);
+        } else {
+            m_scaledIcon = scaled;
+        }
+    }
+
+    return m_scaled || m_scaledIcon;
+}
+
 /*!
     Draws an icon at the absolute position x, y, with the given accumulative \a opacity.
 */
 void Icon::draw(int x, int y, double opacity)
 {
-    if (m_icon) {
-        const uint8_t alpha = m_color.a * opacity;
-        if (alpha != 0) {
-            gr_color(m_color.r, m_color.g, m_color.b, alpha);
-            gr_texticon(x, y, m_icon);
+    const uint8_t alpha = m_color.a * opacity;
+    if (alpha == 0) {
+        return;
+    } else if (width() != m_implicitWidth || height() != m_implicitHeight) {
+        if (scale()) {
+            setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+            if (m_scaled) {
+                drawAlphaMask(x, y, m_scaled);
+            } else {
+                drawTextIcon(x, y, m_scaledIcon);
+            }
         }
+    } else if (m_mask) {
+        setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+        drawAlphaMask(x, y, m_mask);
+    } else if (m_icon) {
+        setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+        drawTextIcon(x, y, m_icon);
     }
 }
 
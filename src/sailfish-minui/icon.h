@@ -41,13 +41,20 @@
 
 namespace Sailfish { namespace MinUi {
 
-class Icon : public Item
+struct AlphaMask;
+
+class Icon : public ResizeableItem
 {
 public:
     explicit Icon(const char *name, Item *parent = nullptr);
     ~Icon();
 
-    bool isValid() const { return m_icon; }
+    bool isValid() const { return m_mask || m_icon; }
+
+    int implicitWidth() const { return m_implicitWidth; }
+    int implicitHeight() const { return m_implicitHeight; }
+
+    void composite(GRSurface *target, int x, int y, double opacity = 1.);
 
     Color color() const { return m_color; }
     void setColor(Color color);
@@ -56,8 +63,15 @@ protected:
     void draw(int x, int y, double opacity) override;
 
 private:
+    inline bool scale();
+
+    AlphaMask *m_mask = nullptr;
     gr_surface m_icon = nullptr;
+    AlphaMask *m_scaled = nullptr;
+    gr_surface m_scaledIcon = nullptr;
     Color m_color;
+    int m_implicitWidth = 0;
+    int m_implicitHeight = 0;
 };
 }}
 
@@ -37,11 +37,15 @@
 #include "image.h"
 
 #include "logging.h"
+#include "surface.h"
 
 namespace Sailfish { namespace MinUi {
 /*!
     \class Sailfish::MinUi::Image
     \brief An RGB image.
+
+    An image is initially the size of its resource.  If it is resized the image is scaled to
+    fit, from downscaled copies which are kept so they are filtered only once.
 */
 
 /*!
@@ -50,14 +54,23 @@ namespace Sailfish { namespace MinUi {
     If a \a parent argument is supplied the new item will be appended as a child of that item.
 */
 Image::Image(const char *name, Item *parent)
-    : Item(parent)
+    : ResizeableItem(parent)
 {
     const int result = res_create_display_surface(name, &m_image);
     if (result != 0) {
         log_err("Failed to load image " << name << " " << result);
+    } else if (!isOpaque(m_image)) {
+        // Translucent pixels have to be blended by gr_blit_rgb() as they're drawn.
+    } else if (gr_surface native = convertSurface(m_image, nativePixelFormat(), false)) {
+        // Convert the pixels of opaque images once now so drawing is a plain copy of each row.
+        freeSurface(m_image);
+        m_image = native;
+        m_native = true;
     }
 
-    resize(gr_get_width(m_image), gr_get_height(m_image));
+    m_implicitWidth = gr_get_width(m_image);
+    m_implicitHeight = gr_get_height(m_image);
+    resize(m_implicitWidth, m_implicitHeight);
 }
 
 /*!
@@ -65,7 +78,41 @@ Image::Image(const char *name, Item *parent)
 */
 Image::~Image()
 {
-    res_free_surface(m_image);
+    delete m_mipCache;
+    freeSurface(m_scaled);
+    freeSurface(m_image);
+}
+
+/*!
+    \fn Sailfish::MinUi::Image::implicitWidth() const
+
+    Returns the width of the image resource.
+*/
+
+/*!
+    \fn Sailfish::MinUi::Image::implicitHeight() const
+
+    Returns the height of the image resource.
+*/
+
+/*!
+    Returns the image scaled to the current size, scaling it again if the size has changed.
+*/
+const GRSurface *Image::scaledImage()
+{
+    if (m_scaled && m_scaled->width == width() && m_scaled->height == height()) {
+        return m_scaled;
+    }
+
+    freeSurface(m_scaled);
+    m_scaled = nullptr;
+
+    if (!m_mipCache) {
+        m_mipCache = new MipCache(m_image);
+    }
+    m_scaled = m_mipCache->scaled(width(), height());
+
+    return m_scaled;
 }
 
 /*!
@@ -77,8 +124,16 @@ void Image::draw(int x, int y, double opacity)
 {
     (void)opacity;
 
-    if (m_image) {
-        gr_blit_rgb(m_image, 0, 0, width(), height(), x, y);
+    const GRSurface * const image = m_image && (width() != m_implicitWidth || height() != m_implicitHeight)
+            ? scaledImage()
+            : m_image;
+
+    if (!image) {
+        return;
+    } else if (m_native) {
+        blitSurface(image, 0, 0, width(), height(), x, y);
+    } else {
+        blitRgb(image, 0, 0, width(), height(), x, y);
     }
 }
 
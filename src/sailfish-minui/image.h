@@ -41,7 +41,9 @@
 
 namespace Sailfish { namespace MinUi {
 
-class Image : public Item
+class MipCache;
+
+class Image : public ResizeableItem
 {
 public:
     explicit Image(const char *name, Item *parent);
@@ -49,11 +51,21 @@ public:
 
     bool isValid() const { return m_image; }
 
+    int implicitWidth() const { return m_implicitWidth; }
+    int implicitHeight() const { return m_implicitHeight; }
+
 protected:
     void draw(int x, int y, double opacity) override;
 
 private:
+    inline const GRSurface *scaledImage();
+
     gr_surface m_image = nullptr;
+    MipCache *m_mipCache = nullptr;
+    gr_surface m_scaled = nullptr;
+    int m_implicitWidth = 0;
+    int m_implicitHeight = 0;
+    bool m_native = false;
 };
 
 }}
@@ -0,0 +1,146 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "inputdevice.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <sys/ioctl.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace Sailfish { namespace MinUi {
+
+static std::vector<std::pair<int, const InputDeviceInfo *>> virtualDevices;
+
+/*!
+    \class Sailfish::MinUi::InputDeviceInfo
+    \brief Capabilities of an evdev input device.
+
+    Captured from a real device by an InputRecorder and used to answer capability queries for the
+    virtual devices an InputReplayer feeds events from.
+*/
+bool InputDeviceInfo::query(int fd)
+{
+    if (ioctl(fd, EVIOCGBIT(0, sizeof(types)), types) < 0) {
+        return false;
+    }
+
+    ioctl(fd, EVIOCGNAME(sizeof(name) - 1), name);
+
+    if (hasType(EV_ABS) && ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absCodes)), absCodes) >= 0) {
+        for (int code = 0; code < ABS_CNT; ++code) {
+            if (hasAbs(code)) {
+                ioctl(fd, EVIOCGABS(code), &abs[code]);
+            }
+        }
+    }
+
+    return true;
+}
+
+static int copyBits(void *argument, unsigned int size, const void *bits, size_t bitsSize)
+{
+    // Like the kernel copy no more than the size of the bitmap, the remainder is untouched.
+    const size_t length = std::min<size_t>(size, bitsSize);
+    if (length > 0) {
+        memcpy(argument, bits, length);
+    }
+    return length;
+}
+
+/*!
+    Performs an ioctl \a request with an \a argument on the input device \a fd.
+
+    Requests on virtual devices registered with registerVirtualInputDevice() are answered from their
+    InputDeviceInfo, requests on any other descriptor are passed to ioctl().
+*/
+int inputDeviceIoctl(int fd, unsigned long request, void *argument)
+{
+    const InputDeviceInfo *info = nullptr;
+    for (const auto &device : virtualDevices) {
+        if (device.first == fd) {
+            info = device.second;
+            break;
+        }
+    }
+
+    if (!info) {
+        return ioctl(fd, request, argument);
+    }
+
+    const unsigned int number = _IOC_NR(request);
+    const unsigned int size = _IOC_SIZE(request);
+
+    if (_IOC_TYPE(request) != 'E' || _IOC_DIR(request) != _IOC_READ) {
+        // Not a query.
+    } else if (number == _IOC_NR(EVIOCGBIT(0, 0))) {
+        return copyBits(argument, size, info->types, sizeof(info->types));
+    } else if (number == _IOC_NR(EVIOCGBIT(EV_ABS, 0))) {
+        return copyBits(argument, size, info->absCodes, sizeof(info->absCodes));
+    } else if (number > _IOC_NR(EVIOCGBIT(0, 0)) && number < _IOC_NR(EVIOCGBIT(EV_MAX, 0))) {
+        return copyBits(argument, size, nullptr, 0);
+    } else if (number >= _IOC_NR(EVIOCGABS(0))
+            && number < _IOC_NR(EVIOCGABS(ABS_MAX)) + 1
+            && size == sizeof(input_absinfo)) {
+        memcpy(argument, &info->abs[number - _IOC_NR(EVIOCGABS(0))], sizeof(input_absinfo));
+        return 0;
+    } else if (number == _IOC_NR(EVIOCGNAME(0))) {
+        const size_t length = std::min<size_t>(size, strlen(info->name) + 1);
+        memcpy(argument, info->name, length);
+        return length;
+    }
+
+    errno = ENOTTY;
+    return -1;
+}
+
+void registerVirtualInputDevice(int fd, const InputDeviceInfo *info)
+{
+    unregisterVirtualInputDevice(fd);
+    virtualDevices.push_back(std::make_pair(fd, info));
+}
+
+void unregisterVirtualInputDevice(int fd)
+{
+    virtualDevices.erase(std::remove_if(virtualDevices.begin(), virtualDevices.end(), [fd](const std::pair<int, const InputDeviceInfo *> &device) {
+        return device.first == fd;
+    }), virtualDevices.end());
+}
+
+}}
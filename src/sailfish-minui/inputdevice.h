@@ -0,0 +1,74 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_INPUTDEVICE_H
+#define SAILFISH_MINUI_INPUTDEVICE_H
+
+#include <linux/input.h>
+
+#include <limits.h>
+
+#include <string>
+
+namespace Sailfish { namespace MinUi {
+
+struct InputDeviceInfo
+{
+    enum {
+        TypeWords = (EV_CNT + LONG_BIT - 1) / LONG_BIT,
+        AbsWords = (ABS_CNT + LONG_BIT - 1) / LONG_BIT,
+        NameLength = 64
+    };
+
+    char name[NameLength] = {};
+    unsigned long types[TypeWords] = {};
+    unsigned long absCodes[AbsWords] = {};
+    input_absinfo abs[ABS_CNT] = {};
+
+    bool hasType(int type) const { return types[type / LONG_BIT] & (1ul << (type % LONG_BIT)); }
+    bool hasAbs(int code) const { return absCodes[code / LONG_BIT] & (1ul << (code % LONG_BIT)); }
+
+    bool query(int fd);
+};
+
+int inputDeviceIoctl(int fd, unsigned long request, void *argument);
+
+void registerVirtualInputDevice(int fd, const InputDeviceInfo *info);
+void unregisterVirtualInputDevice(int fd);
+
+}}
+
+#endif
@@ -0,0 +1,528 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "inputrecorder.h"
+#include "inputdevice.h"
+#include "item.h"
+#include "logging.h"
+
+#include <algorithm>
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+
+namespace Sailfish { namespace MinUi {
+
+/*
+    Recordings are a header followed by a sequence of records in host byte order.
+
+    Header:  char magic[8] "SFMUIREC", uint32 version, uint32 reserved
+    Device:  uint8 'D', uint32 index, char name[64], uint8 types[EV_CNT / 8],
+             uint8 absCodes[ABS_CNT / 8], int32 absinfo[6] for each absolute axis
+    Events:  uint8 'E', uint32 device index, uint32 count,
+             count * { int64 time in microseconds, uint16 type, uint16 code, int32 value }
+
+    A device record precedes the first events record for that device.
+*/
+
+static const char recordingMagic[8] = { 'S', 'F', 'M', 'U', 'I', 'R', 'E', 'C' };
+static const uint32_t recordingVersion = 1;
+
+enum {
+    TypeBytes = EV_CNT / 8,
+    AbsBytes = ABS_CNT / 8
+};
+
+static int64_t monotonicTime()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (time.tv_sec * INT64_C(1000000)) + (time.tv_nsec / 1000);
+}
+
+static void packBits(uint8_t *bytes, int count, const unsigned long *words)
+{
+    for (int bit = 0; bit < count * 8; ++bit) {
+        if (words[bit / LONG_BIT] & (1ul << (bit % LONG_BIT))) {
+            bytes[bit / 8] |= 1 << (bit % 8);
+        }
+    }
+}
+
+static void unpackBits(unsigned long *words, int count, const uint8_t *bytes)
+{
+    for (int bit = 0; bit < count * 8; ++bit) {
+        if (bytes[bit / 8] & (1 << (bit % 8))) {
+            words[bit / LONG_BIT] |= 1ul << (bit % LONG_BIT);
+        }
+    }
+}
+
+template <typename T> static bool readValue(FILE *file, T *value)
+{
+    return fread(value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T> static void writeValue(FILE *file, const T &value)
+{
+    fwrite(&value, sizeof(T), 1, file);
+}
+
+/*!
+    \class Sailfish::MinUi::InputRecorder
+    \brief Records the raw input events received by an event loop to a file.
+
+    Events are recorded exactly as they are read from each evdev device along with their
+    kernel timestamps, and the first time a device is seen its name, supported event types and
+    absolute axis ranges are recorded so the recording can be replayed against a window on
+    another device with an \l InputReplayer.
+*/
+
+/*!
+    Constructs an input recorder for an \a eventLoop.
+*/
+InputRecorder::InputRecorder(EventLoop *eventLoop)
+    : m_eventLoop(eventLoop)
+{
+}
+
+/*!
+    Destroys an input recorder, stopping any recording in progress.
+*/
+InputRecorder::~InputRecorder()
+{
+    stop();
+}
+
+/*!
+    Starts recording input events to the file \a fileName, replacing any existing file.
+
+    Returns false if the file could not be opened or if another recorder is already active.
+*/
+bool InputRecorder::start(const char *fileName)
+{
+    if (m_file) {
+        stop();
+    }
+
+    if (m_eventLoop->m_recorder) {
+        log_warning("InputRecorder: Another recorder is already active.");
+        return false;
+    }
+
+    m_file = fopen(fileName, "wbe");
+    if (!m_file) {
+        log_err("InputRecorder: Failed to open " << fileName << ". " << strerror(errno));
+        return false;
+    }
+
+    fwrite(recordingMagic, sizeof(recordingMagic), 1, m_file);
+    writeValue(m_file, recordingVersion);
+    writeValue(m_file, uint32_t(0));
+
+    m_devices.clear();
+    m_eventCount = 0;
+    m_eventLoop->m_recorder = this;
+
+    return true;
+}
+
+/*!
+    Stops recording and closes the file.
+*/
+void InputRecorder::stop()
+{
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+
+        m_eventLoop->m_recorder = nullptr;
+    }
+}
+
+/*!
+    \fn int Sailfish::MinUi::InputRecorder::eventCount() const
+
+    Returns the number of events recorded since recording was started.
+*/
+
+void InputRecorder::record(int fd, const input_event *events, int count)
+{
+    auto it = std::find(m_devices.begin(), m_devices.end(), fd);
+    const uint32_t device = it - m_devices.begin();
+
+    if (it == m_devices.end()) {
+        m_devices.push_back(fd);
+
+        InputDeviceInfo info;
+        info.query(fd);
+
+        uint8_t types[TypeBytes] = {};
+        uint8_t absCodes[AbsBytes] = {};
+        packBits(types, TypeBytes, info.types);
+        packBits(absCodes, AbsBytes, info.absCodes);
+
+        writeValue(m_file, uint8_t('D'));
+        writeValue(m_file, device);
+        fwrite(info.name, sizeof(info.name), 1, m_file);
+        fwrite(types, sizeof(types), 1, m_file);
+        fwrite(absCodes, sizeof(absCodes), 1, m_file);
+        for (int code = 0; code < ABS_CNT; ++code) {
+            if (info.hasAbs(code)) {
+                const input_absinfo &abs = info.abs[code];
+                const int32_t values[] = { abs.value, abs.minimum, abs.maximum, abs.fuzz, abs.flat, abs.resolution };
+                fwrite(values, sizeof(values), 1, m_file);
+            }
+        }
+    }
+
+    writeValue(m_file, uint8_t('E'));
+    writeValue(m_file, device);
+    writeValue(m_file, uint32_t(count));
+    for (int i = 0; i < count; ++i) {
+        writeValue(m_file, int64_t(events[i].time.tv_sec) * INT64_C(1000000) + events[i].time.tv_usec);
+        writeValue(m_file, uint16_t(events[i].type));
+        writeValue(m_file, uint16_t(events[i].code));
+        writeValue(m_file, int32_t(events[i].value));
+    }
+
+    m_eventCount += count;
+}
+
+/*!
+    \class Sailfish::MinUi::InputReplayer
+    \brief Replays a recording made with \l InputRecorder into a window.
+
+    Each recorded device is represented by a virtual device whose capability queries are
+    answered from the recording, so touch coordinates are scaled the same as they were when
+    recorded regardless of the input devices present.  This is normally used with a headless
+    \l Window.
+
+    Events are delivered in the batches they were originally read in, either with their
+    original timing or as fast as possible with the event loop given one iteration between
+    batches to update the window.  With a \l VirtualClock installed on the event loop, real
+    time replay driven by \l EventLoop::advance() is both deterministic and fast.
+
+    The time taken to handle each SYN_REPORT frame and the number of frames the window drew
+    are recorded in the \l statistics().
+*/
+
+/*!
+    \class Sailfish::MinUi::InputReplayer::Statistics
+    \brief Measurements from a replay.
+
+    \c events, \c reports and \c batches count the input events, SYN_REPORT frames and reads
+    replayed, \c frames counts the frames drawn by the window.  \c handlingTime is the total
+    and \c maximumHandlingTime the longest time in microseconds spent handling a single
+    report, and \c duration is the wall time the replay took in microseconds.
+*/
+
+/*!
+    Constructs an input replayer which delivers events to a \a window.
+*/
+InputReplayer::InputReplayer(Window *window)
+    : m_window(window)
+{
+}
+
+/*!
+    Destroys an input replayer.
+*/
+InputReplayer::~InputReplayer()
+{
+    stop();
+    clear();
+}
+
+/*!
+    Loads the recording in the file \a fileName.
+
+    Returns false if the file could not be read or isn't a valid recording.
+*/
+bool InputReplayer::load(const char *fileName)
+{
+    stop();
+    clear();
+
+    FILE * const file = fopen(fileName, "rbe");
+    if (!file) {
+        log_err("InputReplayer: Failed to open " << fileName << ". " << strerror(errno));
+        return false;
+    }
+
+    char magic[sizeof(recordingMagic)];
+    uint32_t version = 0;
+    uint32_t reserved = 0;
+
+    bool valid = fread(magic, sizeof(magic), 1, file) == 1
+            && memcmp(magic, recordingMagic, sizeof(magic)) == 0
+            && readValue(file, &version)
+            && version == recordingVersion
+            && readValue(file, &reserved);
+
+    for (uint8_t kind; valid && readValue(file, &kind);) {
+        uint32_t device = 0;
+        valid = readValue(file, &device);
+
+        if (!valid) {
+            break;
+        } else if (kind == 'D' && device == m_devices.size()) {
+            InputDeviceInfo * const info = new InputDeviceInfo;
+            m_devices.push_back(info);
+
+            uint8_t types[TypeBytes];
+            uint8_t absCodes[AbsBytes];
+            valid = fread(info->name, sizeof(info->name), 1, file) == 1
+                    && fread(types, sizeof(types), 1, file) == 1
+                    && fread(absCodes, sizeof(absCodes), 1, file) == 1;
+            info->name[sizeof(info->name) - 1] = '\0';
+
+            unpackBits(info->types, TypeBytes, types);
+            unpackBits(info->absCodes, AbsBytes, absCodes);
+
+            for (int code = 0; valid && code < ABS_CNT; ++code) {
+                int32_t values[6];
+                if (!info->hasAbs(code)) {
+                    continue;
+                } else if ((valid = fread(values, sizeof(values), 1, file) == 1)) {
+                    input_absinfo &abs = info->abs[code];
+                    abs.value = values[0];
+                    abs.minimum = values[1];
+                    abs.maximum = values[2];
+                    abs.fuzz = values[3];
+                    abs.flat = values[4];
+                    abs.resolution = values[5];
+                }
+            }
+        } else if (kind == 'E' && device < m_devices.size()) {
+            uint32_t count = 0;
+            valid = readValue(file, &count);
+
+            Batch batch = { int(device), int(m_events.size()), int(count) };
+            for (uint32_t i = 0; valid && i < count; ++i) {
+                Event event;
+                valid = readValue(file, &event.time)
+                        && readValue(file, &event.type)
+                        && readValue(file, &event.code)
+                        && readValue(file, &event.value);
+                m_events.push_back(event);
+            }
+            m_batches.push_back(batch);
+        } else {
+            valid = false;
+        }
+    }
+
+    fclose(file);
+
+    if (!valid) {
+        log_err("InputReplayer: " << fileName << " is not a valid recording.");
+        clear();
+        return false;
+    }
+
+    for (InputDeviceInfo *info : m_devices) {
+        // The descriptor only needs to be a unique number which can't be mistaken for a real device.
+        const int fd = ::eventfd(0, EFD_CLOEXEC);
+        m_deviceFds.push_back(fd);
+        registerVirtualInputDevice(fd, info);
+    }
+
+    return true;
+}
+
+/*!
+    Starts replaying the loaded recording.  If \a realTime is true events are delivered with
+    their recorded timing, otherwise as fast as possible.
+
+    Returns false if no recording is loaded.
+*/
+bool InputReplayer::start(bool realTime)
+{
+    stop();
+
+    if (m_batches.empty()) {
+        return false;
+    }
+
+    m_realTime = realTime;
+    m_statistics = Statistics();
+    m_handlingTimes.clear();
+    m_handlingTimes.reserve(m_events.size() / 4);
+    m_position = 0;
+    m_startTime = m_window->eventLoop()->currentTime();
+    m_startWallTime = monotonicTime();
+    m_startFrame = m_window->frameCount();
+
+    schedule();
+
+    return true;
+}
+
+/*!
+    Stops a replay in progress, the finished callback is not invoked.
+*/
+void InputReplayer::stop()
+{
+    if (m_timerId != 0) {
+        m_window->eventLoop()->cancelTimer(m_timerId);
+        m_timerId = 0;
+    }
+}
+
+/*!
+    Logs the statistics of the last replay.
+*/
+void InputReplayer::logStatistics() const
+{
+    std::vector<int64_t> times = m_handlingTimes;
+    std::sort(times.begin(), times.end());
+
+    const auto percentile = [&times](int percent) -> int64_t {
+        return times.empty() ? 0 : times[(times.size() - 1) * percent / 100];
+    };
+
+    log_warning("InputReplayer: " << m_statistics.events << " events in "
+            << m_statistics.reports << " reports and " << m_statistics.batches << " reads, "
+            << m_statistics.frames << " frames drawn in " << (m_statistics.duration / 1000) << " ms");
+    log_warning("InputReplayer: handling time per event "
+            << (m_statistics.events > 0 ? m_statistics.handlingTime / m_statistics.events : 0) << " us,"
+            << " per report p50 " << percentile(50) << " us"
+            << " p95 " << percentile(95) << " us"
+            << " max " << m_statistics.maximumHandlingTime << " us");
+}
+
+/*!
+    Sets a \a callback which is invoked when a replay has delivered all events and the window
+    has been updated.
+*/
+void InputReplayer::onFinished(const std::function<void()> &callback)
+{
+    m_finished = callback;
+}
+
+void InputReplayer::clear()
+{
+    for (int fd : m_deviceFds) {
+        unregisterVirtualInputDevice(fd);
+        ::close(fd);
+    }
+    for (InputDeviceInfo *info : m_devices) {
+        delete info;
+    }
+    m_deviceFds.clear();
+    m_devices.clear();
+    m_events.clear();
+    m_batches.clear();
+}
+
+void InputReplayer::schedule()
+{
+    EventLoop * const eventLoop = m_window->eventLoop();
+
+    int64_t delay = 0;
+    if (m_realTime && m_position < int(m_batches.size())) {
+        const int64_t offset = (m_events[m_batches[m_position].first].time - m_events.front().time) / 1000;
+        delay = std::max<int64_t>(0, m_startTime + offset - eventLoop->currentTime());
+    }
+
+    // After the last batch allow one more iteration for the window to update before finishing.
+    m_timerId = eventLoop->createTimer(int(delay), [this, eventLoop]() {
+        eventLoop->cancelTimer(m_timerId);
+        m_timerId = 0;
+
+        if (m_position < int(m_batches.size())) {
+            deliver(m_batches[m_position++]);
+            schedule();
+        } else {
+            finish();
+        }
+    });
+}
+
+void InputReplayer::deliver(const Batch &batch)
+{
+    input_event events[64];
+
+    const int fd = m_deviceFds[batch.device];
+    int count = 0;
+
+    for (int i = 0; i < batch.count; ++i) {
+        const Event &event = m_events[batch.first + i];
+
+        input_event &inputEvent = events[count++];
+        inputEvent.time.tv_sec = event.time / 1000000;
+        inputEvent.time.tv_usec = event.time % 1000000;
+        inputEvent.type = event.type;
+        inputEvent.code = event.code;
+        inputEvent.value = event.value;
+
+        const bool report = event.type == EV_SYN && event.code == SYN_REPORT;
+        if (report || count == 64 || i == batch.count - 1) {
+            const int64_t start = monotonicTime();
+            m_window->inputFrame(fd, events, count);
+            const int64_t time = monotonicTime() - start;
+
+            m_statistics.events += count;
+            m_statistics.handlingTime += time;
+            m_statistics.maximumHandlingTime = std::max(m_statistics.maximumHandlingTime, time);
+            if (report) {
+                m_statistics.reports += 1;
+                m_handlingTimes.push_back(time);
+            }
+            count = 0;
+        }
+    }
+
+    m_statistics.batches += 1;
+}
+
+void InputReplayer::finish()
+{
+    m_statistics.frames = m_window->frameCount() - m_startFrame;
+    m_statistics.duration = monotonicTime() - m_startWallTime;
+
+    if (m_finished) {
+        m_finished();
+    }
+}
+
+}}
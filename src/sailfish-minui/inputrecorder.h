@@ -0,0 +1,150 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_INPUTRECORDER_H
+#define SAILFISH_MINUI_INPUTRECORDER_H
+
+#include <sailfish-minui/eventloop.h>
+
+#include <stdint.h>
+#include <stdio.h>
+
+extern "C" struct input_event;
+
+namespace Sailfish { namespace MinUi {
+
+struct InputDeviceInfo;
+class Window;
+
+class InputRecorder
+{
+public:
+    explicit InputRecorder(EventLoop *eventLoop = EventLoop::instance());
+    InputRecorder(const InputRecorder &) = delete;
+    ~InputRecorder();
+
+    InputRecorder &operator =(const InputRecorder &) = delete;
+
+    bool start(const char *fileName);
+    void stop();
+
+    bool isRecording() const { return m_file != nullptr; }
+    int eventCount() const { return m_eventCount; }
+
+private:
+    friend class EventLoop;
+
+    void record(int fd, const input_event *events, int count);
+
+    std::vector<int> m_devices;
+    EventLoop * const m_eventLoop;
+    FILE *m_file = nullptr;
+    int m_eventCount = 0;
+};
+
+class InputReplayer
+{
+public:
+    struct Statistics
+    {
+        int events = 0;
+        int reports = 0;
+        int batches = 0;
+        int frames = 0;
+        int64_t handlingTime = 0;
+        int64_t maximumHandlingTime = 0;
+        int64_t duration = 0;
+    };
+
+    explicit InputReplayer(Window *window);
+    InputReplayer(const InputReplayer &) = delete;
+    ~InputReplayer();
+
+    InputReplayer &operator =(const InputReplayer &) = delete;
+
+    bool load(const char *fileName);
+
+    bool start(bool realTime = true);
+    void stop();
+
+    bool isActive() const { return m_timerId != 0; }
+
+    const Statistics &statistics() const { return m_statistics; }
+    const std::vector<int64_t> &handlingTimes() const { return m_handlingTimes; }
+    void logStatistics() const;
+
+    void onFinished(const std::function<void()> &callback);
+
+private:
+    struct Event
+    {
+        int64_t time;
+        uint16_t type;
+        uint16_t code;
+        int32_t value;
+    };
+
+    struct Batch
+    {
+        int device;
+        int first;
+        int count;
+    };
+
+    inline void clear();
+    inline void schedule();
+    inline void deliver(const Batch &batch);
+    inline void finish();
+
+    std::function<void()> m_finished;
+    std::vector<InputDeviceInfo *> m_devices;
+    std::vector<int> m_deviceFds;
+    std::vector<Event> m_events;
+    std::vector<Batch> m_batches;
+    std::vector<int64_t> m_handlingTimes;
+    Statistics m_statistics;
+    Window * const m_window;
+    int64_t m_startTime = 0;
+    int64_t m_startWallTime = 0;
+    int m_startFrame = 0;
+    int m_position = 0;
+    int m_timerId = 0;
+    bool m_realTime = true;
+};
+
+}}
+
+#endif
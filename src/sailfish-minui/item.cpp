@@ -36,9 +36,17 @@
 
 #include "ui.h"
 #include "display.h"
+#include "displaylist.h"
+#include "renderthread.h"
 #include "eventloop.h"
+#include "inputdevice.h"
+#include "keymap.h"
+#include "latencytracer.h"
 #include "multitouch.h"
 #include "logging.h"
+#include "surface.h"
+#include "touchresampler.h"
+#include "watchdog.h"
 
 #include <minui/minui.h>
 
@@ -530,6 +538,30 @@ void Item::setAcceptsInputFocus(bool accept)
     }
 }
 
+/*!
+    \fn Sailfish::MinUi::Item::acceptsDrags()
+
+    Returns true if an item can be dragged.
+
+    An item which accepts drags is notified of touches within its bounds with dragPressed(),
+    and if the touch moves further than the theme's start drag distance it takes the touch
+    from any child item which was pressed and receives dragStarted(), dragMoved() and
+    dragReleased() calls as it moves.  If drag items are nested the innermost has the drag.
+*/
+
+/*!
+    Sets whether an item will \a accept drags.
+*/
+void Item::setAcceptsDrags(bool accept)
+{
+    if (m_acceptsDrags != accept) {
+        m_acceptsDrags = accept;
+        if (m_window && !m_acceptsDrags && m_window->m_touch.dragItem == this) {
+            m_window->m_touch.dragItem = nullptr;
+        }
+    }
+}
+
 /*!
     \fn Sailfish::MinUi::Item::isVisible()
 
@@ -554,11 +586,35 @@ void Item::setVisible(bool visible)
         invalidate(Draw);
 
         if (m_parent) {
+            m_parent->invalidateBounds();
             m_parent->invalidate(Layout);
         }
     }
 }
 
+/*!
+    \fn Sailfish::MinUi::Item::clip()
+
+    Returns true if an item clips the drawing of itself and its children to its bounds.
+*/
+
+/*!
+    Sets whether an item will \a clip the drawing of itself and its children to its bounds.
+
+    Child items which are wholly outside the bounds of a clipping item are not drawn at all,
+    which makes clipping a cheap way to bound the cost of drawing content which extends beyond
+    the visible area of a view.
+*/
+void Item::setClip(bool clip)
+{
+    if (m_clip != clip) {
+        m_clip = clip;
+
+        invalidateBounds();
+        invalidate(Draw);
+    }
+}
+
 /*!
     Allows an item to draw itself at the absolute screen coordinates \a x and \a y.
 
@@ -611,22 +667,24 @@ void Item::updateState(bool enabled)
 */
 void Item::invalidate(int flags)
 {
-    const int invalidatedFlags = m_invalidatedFlags | flags;
-    if (m_invalidatedFlags != invalidatedFlags) {
-        m_invalidatedFlags = invalidatedFlags;
+    if (m_window && m_window->m_latencyTracer) {
+        m_window->m_latencyTracer->invalidated();
+    }
 
-        if (m_window) {
-            const int windowFlags = m_window->m_invalidatedFlags | flags;
-            if ((m_window == this || m_window->m_invalidatedFlags != windowFlags)
-                    && m_window->m_eventFd >= 0) {
-                m_window->m_invalidatedFlags = windowFlags;
+    // The window is notified whenever its own flags change rather than only when the item's
+    // flags change as items which are hidden or culled aren't drawn and so retain their Draw flag.
+    if (m_window) {
+        const int windowFlags = m_window->m_invalidatedFlags | flags;
+        if (m_window->m_invalidatedFlags != windowFlags && m_window->m_eventFd >= 0) {
+            m_window->m_invalidatedFlags = windowFlags;
 
-                int64_t eventData = 1;
-                const ssize_t size = ::write(m_window->m_eventFd, &eventData, sizeof(eventData));
-                assert(size == sizeof(eventData));
-            }
+            int64_t eventData = 1;
+            const ssize_t size = ::write(m_window->m_eventFd, &eventData, sizeof(eventData));
+            assert(size == sizeof(eventData));
         }
     }
+
+    m_invalidatedFlags |= flags;
 }
 
 /*!
@@ -763,9 +821,17 @@ void Item::updateParent(Item *parent)
         m_window->clearFocus(this);
     }
 
+    if (m_parent) {
+        m_parent->invalidateBounds();
+    }
+
     m_parent = parent;
     updateWindow(parent ? parent->m_window : nullptr);
 
+    if (m_parent) {
+        m_parent->invalidateBounds();
+    }
+
     invalidate(Draw | State | Layout);
 }
 
@@ -793,6 +859,9 @@ void Item::updateWindow(Window *window)
 void Item::setX(int x)
 {
     m_x = x;
+    if (m_parent) {
+        m_parent->invalidateBounds();
+    }
     invalidate(Draw);
 }
 
@@ -808,6 +877,9 @@ void Item::setX(int x)
 void Item::setY(int y)
 {
     m_y = y;
+    if (m_parent) {
+        m_parent->invalidateBounds();
+    }
     invalidate(Draw);
 }
 
@@ -818,6 +890,9 @@ void Item::move(int x, int y)
 {
     m_x = x;
     m_y = y;
+    if (m_parent) {
+        m_parent->invalidateBounds();
+    }
     invalidate(Draw);
 }
 
@@ -943,6 +1018,7 @@ void Item::resize(int width, int height)
 */
 void Item::invalidateSize()
 {
+    invalidateBounds();
     invalidate(Draw | Layout);
     if (m_parent) {
         m_parent->invalidate(Layout);
@@ -1102,6 +1178,52 @@ bool Item::keyPress(int code, char character)
     return false;
 }
 
+/*!
+    Called when an item which accepts drags is pressed at the window position \a x, \a y.
+
+    Returns true if the item should take the touch and start dragging immediately rather than
+    once it has moved the start drag distance.
+*/
+bool Item::dragPressed(int x, int y)
+{
+    (void)x;
+    (void)y;
+
+    return false;
+}
+
+/*!
+    Called when a touch on an item which accepts drags has moved far enough to start a drag,
+    \a x and \a y are the window position of the touch.
+*/
+void Item::dragStarted(int x, int y)
+{
+    (void)x;
+    (void)y;
+}
+
+/*!
+    Called when a touch dragging an item moves to the window position \a x, \a y.
+*/
+void Item::dragMoved(int x, int y)
+{
+    (void)x;
+    (void)y;
+}
+
+/*!
+    Called when a touch pressed on an item which accepts drags is lifted at the window
+    position \a x, \a y.  If the touch was \a dragged the item was dragging.
+
+    The touch history of the window can be used to find the velocity of the release.
+*/
+void Item::dragReleased(int x, int y, bool dragged)
+{
+    (void)x;
+    (void)y;
+    (void)dragged;
+}
+
 /*!
     Returns a reference to the items list of child items.
 */
@@ -1290,12 +1412,73 @@ void Item::drawItems(int dx, int dy, double opacity)
     dy += m_y;
     opacity *= m_opacity;
 
+    updateBounds();
+
+    const ClipRect clip = clipRect();
+    if (!clip.intersects({
+            dx + m_boundsLeft, dy + m_boundsTop, dx + m_boundsRight, dy + m_boundsBottom })) {
+        // Nothing in this branch of the tree would be visible so skip it entirely.
+        return;
+    }
+
+    if (m_clip) {
+        setClipRect(clip.intersected({ dx, dy, dx + m_width, dy + m_height }));
+    }
+
     draw(dx, dy, opacity);
     m_invalidatedFlags &= ~Draw;
 
     for (Item &item : m_children) {
         item.drawItems(dx, dy, opacity);
     }
+
+    if (m_clip) {
+        setClipRect(clip);
+    }
+}
+
+/*!
+    Updates the cached bounds of this item and its visible descendants relative to the item's
+    position.
+
+    The bounds of a clipping item are its own bounds, otherwise they include any children
+    which overflow the item.
+*/
+void Item::updateBounds()
+{
+    if (m_boundsValid) {
+        return;
+    }
+
+    m_boundsLeft = 0;
+    m_boundsTop = 0;
+    m_boundsRight = m_width;
+    m_boundsBottom = m_height;
+
+    if (!m_clip) {
+        for (Item &item : m_children) {
+            if (item.m_visible) {
+                item.updateBounds();
+
+                m_boundsLeft = std::min(m_boundsLeft, item.m_x + item.m_boundsLeft);
+                m_boundsTop = std::min(m_boundsTop, item.m_y + item.m_boundsTop);
+                m_boundsRight = std::max(m_boundsRight, item.m_x + item.m_boundsRight);
+                m_boundsBottom = std::max(m_boundsBottom, item.m_y + item.m_boundsBottom);
+            }
+        }
+    }
+
+    m_boundsValid = true;
+}
+
+/*!
+    Invalidates the cached bounds of this item and its ancestors.
+*/
+void Item::invalidateBounds()
+{
+    for (Item *item = this; item && item->m_boundsValid; item = item->m_parent) {
+        item->m_boundsValid = false;
+    }
 }
 
 /*!
@@ -1341,6 +1524,7 @@ Window::Window(EventLoop *eventLoop)
     : Item(nullptr)
     , m_eventFd(::eventfd(0, EFD_NONBLOCK))
     , m_multiTouch(nullptr)
+    , m_keymap(&Keymap::system())
 {
     m_window = this;
 
@@ -1350,6 +1534,7 @@ Window::Window(EventLoop *eventLoop)
         log_err("Failed to initialize MinUI graphics");
         ::exit(EXIT_FAILURE);
     }
+    m_graphicsInitialized = true;
 
     m_multiTouch = new MultiTouch(fingerPressed,
                                   fingerMoved,
@@ -1401,14 +1586,56 @@ Window::Window(EventLoop *eventLoop)
         }
     }
 
+    Display::instance()->m_window = this;
     Display::instance()->unblank();
 }
 
+/*!
+    Constructs a headless window of \a width by \a height pixels for an \a eventLoop.
+
+    A headless window neither draws to nor powers on the display and has no haptic feedback,
+    it is intended for replaying recorded input with an \l InputReplayer.  Updates are still
+    processed and counted in \l frameCount().
+*/
+Window::Window(EventLoop *eventLoop, int width, int height)
+    : Item(nullptr)
+    , m_eventFd(::eventfd(0, EFD_NONBLOCK))
+    , m_multiTouch(nullptr)
+    , m_keymap(&Keymap::system())
+    , m_headless(true)
+{
+    m_window = this;
+
+    eventLoop->m_window = this;
+
+    // minui loads its font before looking for a display so text metrics are available even
+    // if this fails.
+    m_graphicsInitialized = gr_init() >= 0;
+
+    m_multiTouch = new MultiTouch(fingerPressed,
+                                  fingerMoved,
+                                  fingerLifted,
+                                  static_cast<void*>(this));
+
+    resize(width, height);
+    if (m_eventFd >= 0) {
+        ev_add_fd(m_eventFd, update_callback, this);
+    }
+}
+
 /*!
     Destroys a window.
 */
 Window::~Window()
 {
+    // Stop rendering before anything the last frame may draw is released.
+    delete m_renderThread;
+    m_renderThread = nullptr;
+
+    if (!m_headless && Display::instance()->m_window == this) {
+        Display::instance()->m_window = nullptr;
+    }
+
     eventLoop()->m_window = nullptr;
 
     if (m_eventFd >= 0) {
@@ -1421,7 +1648,12 @@ Window::~Window()
     delete m_multiTouch;
     m_multiTouch = nullptr;
 
-    gr_exit();
+    delete m_displayListRenderer;
+    m_displayListRenderer = nullptr;
+
+    if (m_graphicsInitialized) {
+        gr_exit();
+    }
 }
 
 /*
@@ -1579,8 +1811,8 @@ void Window::playHaptic(HapticEffect effect)
 */
 void Window::draw(int, int, double)
 {
-    gr_color(m_color.r, m_color.g, m_color.b, m_color.a);
-    gr_clear();
+    setDrawColor(m_color.r, m_color.g, m_color.b, m_color.a);
+    clearWindow();
 }
 
 /*!
@@ -1621,6 +1853,13 @@ void Window::clearFocus(Item *item)
     if (item->isAncestorOf(m_pressedItem)) {
         m_pressedItem = nullptr;
     }
+    if (item->isAncestorOf(m_touch.item)) {
+        m_touch.item = nullptr;
+    }
+    if (item->isAncestorOf(m_touch.dragItem)) {
+        m_touch.dragItem = nullptr;
+        m_touch.dragging = false;
+    }
     clearKeyFocus(item);
     clearInputFocus(item);
 }
@@ -1653,7 +1892,7 @@ void Window::Axis::initialize(int fd, int code, int screenSize)
         initialized = true;
 
         struct input_absinfo info;
-        if (ioctl(fd, EVIOCGABS(code), &info) >= 0) {
+        if (inputDeviceIoctl(fd, EVIOCGABS(code), &info) >= 0) {
             numerator = screenSize;
             denomintator = info.maximum - info.minimum;
             offset = info.minimum;
@@ -1661,8 +1900,10 @@ void Window::Axis::initialize(int fd, int code, int screenSize)
     }
 }
 
-void Window::fingerPressed(int x, int y)
+void Window::fingerPressed(int x, int y, int64_t time)
 {
+    LatencyTracer::Scope trace(m_latencyTracer, LatencyTracer::Press, time);
+
     /* On the 1st finger press: Initialize touch
      * coordinate to screen coordinate mapping.
      */
@@ -1672,8 +1913,10 @@ void Window::fingerPressed(int x, int y)
         m_touch.y.initialize(fd, ABS_MT_POSITION_Y, height());
     }
 
-    m_touch.x.value = m_touch.x.scale(x);
-    m_touch.y.value = m_touch.y.scale(y);
+    cancelMove();
+    m_touchHistory.clear();
+    appendTouchSample(x, y, time);
+    m_pressSample = m_touchHistory.back();
 
     log_private("#### down " << x << ","<< y << " -> " << m_touch.x.value << "," << m_touch.y.value);
 
@@ -1716,14 +1959,62 @@ void Window::fingerPressed(int x, int y)
             }
         }
     }
+
+    m_touch.dragging = false;
+    m_touch.dragItem = findItemAt(m_touch.x.value, m_touch.y.value, [](const Item *item) -> int {
+        if (!item->isEnabled() || !item->isVisible()) {
+            return SkipChildren;
+        }
+        return item->m_acceptsDrags ? Match : 0;
+    });
+
+    if (m_touch.dragItem && m_touch.dragItem->dragPressed(m_touch.x.value, m_touch.y.value)) {
+        startDrag();
+    }
+}
+
+/*
+    Moves are coalesced so at most one is handled per update of the window, the latest sample
+    is handled by update() before the frame is drawn.  All samples are retained in the touch
+    history.
+*/
+void Window::fingerMoved(int x, int y, int64_t time)
+{
+    appendTouchSample(x, y, time);
+
+    invalidate(TouchMove);
 }
 
-void Window::fingerMoved(int x, int y)
+void Window::deliverMove()
 {
-    m_touch.x.value = m_touch.x.scale(x);
-    m_touch.y.value = m_touch.y.scale(y);
+    const TouchSample &sample = m_touchHistory.back();
+    LatencyTracer::Scope trace(m_latencyTracer, LatencyTracer::Move, sample.time);
+
+    if (m_touchResampler) {
+        // Estimate the current time on the input clock from how long ago the last sample
+        // arrived.
+        const int64_t sinceSample = eventLoop()->currentTime() - m_lastSampleTime;
+        const TouchResampler::Point point = m_touchResampler->resample(
+                    m_touchHistory, sample.time + (sinceSample * 1000));
+        m_touch.x.value = point.x;
+        m_touch.y.value = point.y;
+    } else {
+        m_touch.x.value = sample.x;
+        m_touch.y.value = sample.y;
+    }
 
-    log_private("#### move " << x << ","<< y << " -> " << m_touch.x.value << "," << m_touch.y.value);
+    log_private("#### move -> " << m_touch.x.value << "," << m_touch.y.value);
+
+    if (m_touch.dragItem && !m_touch.dragging) {
+        if (std::abs(m_touch.x.value - m_pressSample.x) > theme.startDragDistance
+                || std::abs(m_touch.y.value - m_pressSample.y) > theme.startDragDistance) {
+            startDrag();
+        }
+    }
+    if (m_touch.dragItem && m_touch.dragging) {
+        m_touch.dragItem->dragMoved(m_touch.x.value, m_touch.y.value);
+        return;
+    }
 
     if (m_touch.item && !m_touch.item->contains(m_touch.x.value, m_touch.y.value)) {
         if (m_touch.item == m_pressedItem) {
@@ -1734,10 +2025,13 @@ void Window::fingerMoved(int x, int y)
     }
 }
 
-void Window::fingerLifted(int x, int y)
+void Window::fingerLifted(int x, int y, int64_t time)
 {
-    m_touch.x.value = m_touch.x.scale(x);
-    m_touch.y.value = m_touch.y.scale(y);
+    LatencyTracer::Scope trace(m_latencyTracer, LatencyTracer::Lift, time);
+
+    // The lift position supersedes any move still waiting to be handled.
+    cancelMove();
+    appendTouchSample(x, y, time);
 
     log_private("#### lift " << x << ","<< y << " -> " << m_touch.x.value << "," << m_touch.y.value);
 
@@ -1751,100 +2045,198 @@ void Window::fingerLifted(int x, int y)
         }
         m_touch.item = nullptr;
     }
+
+    if (Item * const dragItem = m_touch.dragItem) {
+        const bool dragged = m_touch.dragging;
+        m_touch.dragItem = nullptr;
+        m_touch.dragging = false;
+
+        dragItem->dragReleased(m_touch.x.value, m_touch.y.value, dragged);
+    }
 }
 
-void Window::fingerPressed(int x, int y, void *callbackData)
+/*
+    Gives the touch to the drag item, releasing any item which was pressed by it.
+*/
+void Window::startDrag()
+{
+    m_touch.dragging = true;
+
+    if (m_touch.item) {
+        if (m_touch.item == m_pressedItem) {
+            m_pressedItem->invalidateFocus();
+            m_pressedItem = nullptr;
+        }
+        m_touch.item = nullptr;
+    }
+
+    m_touch.dragItem->dragStarted(m_touch.x.value, m_touch.y.value);
+}
+
+void Window::appendTouchSample(int x, int y, int64_t time)
+{
+    m_touchHistory.append({ m_touch.x.scale(x), m_touch.y.scale(y), time });
+    m_lastSampleTime = eventLoop()->currentTime();
+
+    m_touch.x.value = m_touchHistory.back().x;
+    m_touch.y.value = m_touchHistory.back().y;
+}
+
+void Window::cancelMove()
+{
+    m_invalidatedFlags &= ~TouchMove;
+}
+
+void Window::fingerPressed(int x, int y, int64_t time, void *callbackData)
 {
     Window *self = static_cast<Window*>(callbackData);
-    self->fingerPressed(x, y);
+    self->fingerPressed(x, y, time);
 }
 
-void Window::fingerMoved(int x, int y, void *callbackData)
+void Window::fingerMoved(int x, int y, int64_t time, void *callbackData)
 {
     Window *self = static_cast<Window*>(callbackData);
-    self->fingerMoved(x, y);
+    self->fingerMoved(x, y, time);
 }
 
-void Window::fingerLifted(int x, int y, void *callbackData)
+void Window::fingerLifted(int x, int y, int64_t time, void *callbackData)
 {
     Window *self = static_cast<Window*>(callbackData);
-    self->fingerLifted(x, y);
+    self->fingerLifted(x, y, time);
 }
 
 /*!
-    Handles a linux input \a event.
+    Handles a frame of \a count linux input \a events read from the device \a fd.
+
+    A frame is normally terminated by a SYN_REPORT event.
 */
-void Window::inputEvent(int fd, const input_event &event)
+void Window::inputFrame(int fd, const input_event *events, int count)
 {
-    m_multiTouch->inputEvent(fd, event);
+    m_multiTouch->inputFrame(fd, events, count);
 
-    if (event.type == EV_KEY) {
-        switch (event.code) {
-        case KEY_DOWN:
-        case KEY_VOLUMEDOWN:
-        case KEY_UP:
-        case KEY_VOLUMEUP:
-            if (event.value) {
-                Item * const item = event.code == KEY_UP || event.code == KEY_VOLUMEUP
-                        ? previousKeyFocusItem(m_keyFocusItem, Wrap)
-                        : nextKeyFocusItem(m_keyFocusItem, Wrap);
-                if (m_keyFocusItem != item) {
-                    if (m_keyFocusItem) {
-                        m_keyFocusItem->invalidateFocus();
-                    }
-                    m_keyFocusItem = item;
-                    if (m_keyFocusItem) {
-                        m_keyFocusItem->invalidateFocus();
-                    }
+    for (int i = 0; i < count; ++i) {
+        if (events[i].type == EV_KEY) {
+            keyEvent(events[i]);
+        }
+    }
+}
+
+/*!
+    Handles a linux input key \a event.
+*/
+void Window::keyEvent(const input_event &event)
+{
+    LatencyTracer::Scope trace(
+                m_latencyTracer,
+                LatencyTracer::Key,
+                (int64_t(event.time.tv_sec) * 1000000) + event.time.tv_usec);
+
+    switch (event.code) {
+    case KEY_DOWN:
+    case KEY_VOLUMEDOWN:
+    case KEY_UP:
+    case KEY_VOLUMEUP:
+        if (event.value) {
+            Item * const item = event.code == KEY_UP || event.code == KEY_VOLUMEUP
+                    ? previousKeyFocusItem(m_keyFocusItem, Wrap)
+                    : nextKeyFocusItem(m_keyFocusItem, Wrap);
+            if (m_keyFocusItem != item) {
+                if (m_keyFocusItem) {
+                    m_keyFocusItem->invalidateFocus();
+                }
+                m_keyFocusItem = item;
+                if (m_keyFocusItem) {
+                    m_keyFocusItem->invalidateFocus();
                 }
             }
+        }
+        break;
+    case KEY_POWER:
+        if (m_itemFlags & PowerButtonDoesntSelect) {
+            // Flagged to not to select, just lose focus
+            if (m_keyFocusItem && m_pressedItem) {
+                m_pressedItem->invalidateFocus();
+            }
+            // Don't fall through to select
             break;
-        case KEY_POWER:
-            if (m_itemFlags & PowerButtonDoesntSelect) {
-                // Flagged to not to select, just lose focus
-                if (m_keyFocusItem && m_pressedItem) {
-                    m_pressedItem->invalidateFocus();
-                }
-                // Don't fall through to select
-                break;
+        }
+        /* Falls through. */
+    case KEY_ENTER:
+    case KEY_OK:
+    case KEY_SELECT:
+        if (m_keyFocusItem) {
+            if (m_pressedItem) {
+                m_pressedItem->invalidateFocus();
             }
-            /* Falls through. */
-        case KEY_ENTER:
-        case KEY_OK:
-        case KEY_SELECT:
-            if (m_keyFocusItem) {
-                if (m_pressedItem) {
-                    m_pressedItem->invalidateFocus();
-                }
-                if (event.value) {
-                    m_pressedItem = m_keyFocusItem;
-                    m_pressedItem->invalidateFocus();
-                } else {
-                    if (m_pressedItem == m_keyFocusItem) {
-                        m_pressedItem->activate();
-                    }
-                    m_pressedItem = nullptr;
-                }
+            if (event.value) {
+                m_pressedItem = m_keyFocusItem;
+                m_pressedItem->invalidateFocus();
             } else {
-                keyPress(KEY_ENTER, '\0');
+                if (m_pressedItem == m_keyFocusItem) {
+                    m_pressedItem->activate();
+                }
+                m_pressedItem = nullptr;
             }
-            break;
-        case KEY_0: case KEY_NUMERIC_0: keyPress(event.code, '0'); break;
-        case KEY_1: case KEY_NUMERIC_1: keyPress(event.code, '1'); break;
-        case KEY_2: case KEY_NUMERIC_2: keyPress(event.code, '2'); break;
-        case KEY_3: case KEY_NUMERIC_3: keyPress(event.code, '3'); break;
-        case KEY_4: case KEY_NUMERIC_4: keyPress(event.code, '4'); break;
-        case KEY_5: case KEY_NUMERIC_5: keyPress(event.code, '5'); break;
-        case KEY_6: case KEY_NUMERIC_6: keyPress(event.code, '6'); break;
-        case KEY_7: case KEY_NUMERIC_7: keyPress(event.code, '7'); break;
-        case KEY_8: case KEY_NUMERIC_8: keyPress(event.code, '8'); break;
-        case KEY_9: case KEY_NUMERIC_9: keyPress(event.code, '9'); break;
-        default:
-            break;
+        } else {
+            keyPress(KEY_ENTER, '\0');
         }
+        break;
+    case KEY_LEFTSHIFT:
+    case KEY_RIGHTSHIFT: {
+        // Shift stays active while either shift key is still held.
+        const int key = event.code == KEY_LEFTSHIFT ? 0x01 : 0x02;
+        m_shiftKeys = event.value ? m_shiftKeys | key : m_shiftKeys & ~key;
+        setKeyModifier(Keymap::Shift, m_shiftKeys != 0);
+        break;
+    }
+    case KEY_RIGHTALT:
+        setKeyModifier(Keymap::AltGr, event.value != 0);
+        break;
+    case KEY_CAPSLOCK:
+        if (event.value == 1) {
+            setKeyModifier(Keymap::CapsLock, !(m_keyModifiers & Keymap::CapsLock));
+        }
+        break;
+    case KEY_NUMERIC_0: case KEY_NUMERIC_1: case KEY_NUMERIC_2: case KEY_NUMERIC_3: case KEY_NUMERIC_4:
+    case KEY_NUMERIC_5: case KEY_NUMERIC_6: case KEY_NUMERIC_7: case KEY_NUMERIC_8: case KEY_NUMERIC_9:
+        if (event.value) {
+            keyPress(event.code, '0' + (event.code - KEY_NUMERIC_0));
+        }
+        break;
+    case KEY_ESC:
+    case KEY_BACKSPACE:
+    case KEY_DELETE:
+    case KEY_LEFT:
+    case KEY_RIGHT:
+    case KEY_HOME:
+    case KEY_END:
+        // Editing keys have no character.
+        if (event.value) {
+            keyPress(event.code, '\0');
+        }
+        break;
+    default:
+        // Presses and auto repeats of any other key are delivered with the character the
+        // keymap has for the key, and modifiers and keys the keymap has no character for
+        // aren't delivered at all.
+        if (event.value) {
+            const char character = m_keymap->character(event.code, m_keyModifiers);
+            if (character != '\0') {
+                keyPress(event.code, character);
+            }
+        }
+        break;
     }
 }
 
+/*
+    Sets whether a \a modifier of key presses is \a active.
+*/
+void Window::setKeyModifier(int modifier, bool active)
+{
+    m_keyModifiers = active ? m_keyModifiers | modifier : m_keyModifiers & ~modifier;
+}
+
 /*!
     Handles a update socket notifier event where \a data is a pointer to a Window.
 */
@@ -1852,33 +2244,264 @@ int Window::update_callback(int, uint32_t, void *data)
 {
     Window * const window = static_cast<Window *>(data);
 
-    if (window->m_invalidatedFlags & (State | InputFocus)) {
-        window->updateItems(window->m_invalidatedFlags, true);
-    }
-    if (window->m_invalidatedFlags & Layout) {
-        window->layoutItems();
-    }
-    if (window->m_invalidatedFlags & Draw) {
-        window->drawItems(0, 0, 1.);
-        if (Display::instance()->isDrawable())
-            gr_flip();
-        else
-            log_warning("display not in drawable state; skipping buffer flip");
-    }
-    window->m_invalidatedFlags = 0;
-
     int64_t eventData;
     const ssize_t size = ::read(window->m_eventFd, &eventData, sizeof(eventData));
     assert(size == sizeof(eventData));
 
+    // Nothing is updated while the display can't be drawn to, the invalidated flags are kept
+    // and the update is made by prerender() when the display becomes drawable again.
+    if (window->m_headless || Display::instance()->isDrawable()) {
+        window->update();
+    }
+
     return 0;
 }
 
+/*
+    Updates the state, layout and drawing of the items of a window according to the
+    invalidated flags, handling any pending touch move first.
+*/
+void Window::update()
+{
+    Watchdog::Scope scope(eventLoop()->m_watchdog, Watchdog::Update, -1, this);
+
+    if (m_invalidatedFlags & TouchMove) {
+        m_invalidatedFlags &= ~TouchMove;
+        deliverMove();
+    }
+    if (m_invalidatedFlags & (State | InputFocus)) {
+        updateItems(m_invalidatedFlags, true);
+    }
+    if (m_invalidatedFlags & Layout) {
+        layoutItems();
+    }
+    if (m_invalidatedFlags & Draw) {
+        ++m_frameCount;
+        if (m_headless) {
+            // There is nothing to draw to.
+            if (m_latencyTracer) {
+                m_latencyTracer->flipped();
+            }
+        } else {
+            const ClipRect bounds = { 0, 0, m_width, m_height };
+            setClipRect(bounds);
+            if (m_renderThread) {
+                // The render thread flips and notifies the latency tracer when it has.
+                DisplayList * const snapshot = m_renderThread->snapshot();
+                snapshot->record();
+                drawItems(0, 0, 1.);
+                DisplayList::stopRecording();
+                m_renderThread->submit(bounds, m_frameCount);
+            } else {
+                if (m_displayListRenderer) {
+                    m_displayListRenderer->begin(bounds);
+                    drawItems(0, 0, 1.);
+                    m_displayListRenderer->end(m_frameCount);
+                } else {
+                    drawItems(0, 0, 1.);
+                }
+                gr_flip();
+                if (m_latencyTracer) {
+                    m_latencyTracer->flipped();
+                }
+            }
+        }
+    }
+    m_invalidatedFlags = 0;
+}
+
+/*
+    Draws the frame owed to the display before it is powered on.
+
+    The framebuffers may not have kept their contents while the display was off so the frame
+    is drawn in full.
+*/
+void Window::prerender()
+{
+    if (m_displayListRenderer) {
+        m_displayListRenderer->invalidateAll();
+    }
+    if (m_renderThread) {
+        m_renderThread->invalidateAll();
+    }
+
+    m_invalidatedFlags |= Draw;
+    update();
+}
+
 void Window::disablePowerButtonSelect()
 {
     setItemFlags(itemFlags() | PowerButtonDoesntSelect);
 }
 
+/*!
+    \fn LatencyTracer *Sailfish::MinUi::Window::latencyTracer() const
+
+    Returns the tracer measuring the latency of input handled by the window.
+*/
+
+/*!
+    Sets a \a tracer to measure the latency from input events to the flip of the first frame
+    they affect.  The tracer is not owned by the window and a null tracer disables tracing.
+*/
+void Window::setLatencyTracer(LatencyTracer *tracer)
+{
+    m_latencyTracer = tracer;
+}
+
+/*!
+    \fn bool Sailfish::MinUi::Window::retainedRendering() const
+
+    Returns true if frames are drawn from retained display lists.
+*/
+
+/*!
+    Sets whether frames are drawn from \a retained display lists.
+
+    When retained, the draw commands of each frame are recorded rather than drawn and compared
+    with those of the previous frame, and only the rectangles covered by commands which changed
+    are drawn.  The redrawn area is then exact even if an item invalidates more than it changed,
+    at the cost of recording every visible item each frame.  Surfaces drawn must not be modified
+    afterwards.
+
+    If the SAILFISH_MINUI_DISPLAY_LIST_LOG environment variable is set, the display list and
+    damage of every frame are appended as text to the file it names.
+*/
+void Window::setRetainedRendering(bool retained)
+{
+    if (retained && !m_displayListRenderer) {
+        m_displayListRenderer = new DisplayListRenderer;
+        invalidate(Draw);
+    } else if (!retained && m_displayListRenderer) {
+        delete m_displayListRenderer;
+        m_displayListRenderer = nullptr;
+        invalidate(Draw);
+    }
+}
+
+/*!
+    \fn bool Sailfish::MinUi::Window::threadedRendering() const
+
+    Returns true if frames are drawn and flipped on a render thread.
+*/
+
+/*!
+    Sets whether frames are drawn and flipped on a render thread if \a threaded.
+
+    The event loop thread still updates, lays out and records the display list of each frame
+    but the drawing of its damage and the flip, which may block until the next vertical blank,
+    happen on the render thread so input can be handled in the meantime.  If frames are
+    produced faster than they can be flipped only the latest waiting is drawn.  Frames drawn on
+    the render thread are always drawn from retained display lists, see setRetainedRendering().
+
+    A headless window has nothing to draw to and is never rendered on a thread.
+*/
+void Window::setThreadedRendering(bool threaded)
+{
+    if (threaded && !m_renderThread && !m_headless) {
+        m_renderThread = new RenderThread(eventLoop(), [this]() {
+            if (m_latencyTracer) {
+                m_latencyTracer->flipped();
+            }
+        });
+        invalidate(Draw);
+    } else if (!threaded && m_renderThread) {
+        delete m_renderThread;
+        m_renderThread = nullptr;
+        if (m_displayListRenderer) {
+            // The framebuffers were drawn by the render thread's renderer.
+            m_displayListRenderer->invalidateAll();
+        }
+        invalidate(Draw);
+    }
+}
+
+/*!
+    \fn TouchResampler *Sailfish::MinUi::Window::touchResampler() const
+
+    Returns the resampler applied to touch moves.
+*/
+
+/*!
+    Sets a \a resampler to estimate the position of a moved touch at the time the move is
+    handled rather than using the last reported position.  The resampler is not owned by the
+    window and a null resampler disables resampling.
+
+    Presses and lifts always use the reported position.
+*/
+void Window::setTouchResampler(TouchResampler *resampler)
+{
+    m_touchResampler = resampler;
+}
+
+/*!
+    \fn const Keymap *Sailfish::MinUi::Window::keymap() const
+
+    Returns the keymap which translates the keys of hardware keyboards to characters.
+
+    The default is the \l {Keymap::system()}{system keymap}.
+*/
+
+/*!
+    Sets the \a keymap which translates the keys of hardware keyboards to characters.  A null
+    keymap restores the system keymap.
+*/
+void Window::setKeymap(const Keymap *keymap)
+{
+    m_keymap = keymap ? keymap : &Keymap::system();
+}
+
+/*!
+    \fn int Sailfish::MinUi::Window::keyModifiers() const
+
+    Returns the \l {Keymap::Modifier}{modifiers} currently applied to hardware key presses.
+*/
+
+/*!
+    \fn int Sailfish::MinUi::Window::frameCount() const
+
+    Returns the number of frames the window has drawn.
+*/
+
+/*!
+    \fn bool Sailfish::MinUi::Window::isHeadless() const
+
+    Returns true if the window was constructed without a display.
+*/
+
+/*!
+    \fn const TouchHistory &Sailfish::MinUi::Window::touchHistory() const
+
+    Returns the most recent touch samples of the current or last touch in window coordinates,
+    oldest first, with the input event timestamps in microseconds.
+
+    Finger moves are only handled once per frame interval with the latest position, the
+    history retains every sample reported for use in velocity estimation.  The history is a
+    bounded window of the last TouchHistory::Capacity samples, not the whole gesture, so the
+    oldest sample is not the press once a touch has moved far enough; use pressSample() for
+    that.
+*/
+
+/*!
+    \fn const TouchSample &Sailfish::MinUi::Window::pressSample() const
+
+    Returns the sample of the press which started the current or last touch.
+*/
+
+/*
+    Appends a \a sample to a touch history, replacing the oldest sample if the history is full.
+*/
+void Window::TouchHistory::append(const TouchSample &sample)
+{
+    if (m_count < Capacity) {
+        m_samples[(m_head + m_count) % Capacity] = sample;
+        ++m_count;
+    } else {
+        m_samples[m_head] = sample;
+        m_head = (m_head + 1) % Capacity;
+    }
+}
+
 /*!
     \class Sailfish::MinUi::ResizeableItem
     \brief An item that can be freely resized.
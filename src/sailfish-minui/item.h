@@ -40,7 +40,9 @@
 #include <stdint.h>
 #include <sailfish-minui/linkedlist.h>
 
+#include <array>
 #include <functional>
+#include <vector>
 
 #include <minui/minui.h>
 
@@ -126,11 +128,18 @@ public:
     const int paddingMedium = scale(12);
     const int paddingLarge = scale(24);
     const int horizontalPageMargin = sizeCategory >= Large ? paddingLarge * 2 : paddingLarge;
+
+    const int startDragDistance = scale(20);
 };
 
 extern const Theme theme;
 
 class EventLoop;
+class Keymap;
+class DisplayListRenderer;
+class RenderThread;
+class LatencyTracer;
+class TouchResampler;
 class Window;
 
 class Item
@@ -188,11 +197,16 @@ public:
     bool acceptsInputFocus() const { return m_acceptsInputFocus; }
     bool hasInputFocus() const;
 
+    bool acceptsDrags() const { return m_acceptsDrags; }
+
     bool isPressed() const;
 
     bool isVisible() const { return m_visible; }
     void setVisible(bool visible);
 
+    bool clip() const { return m_clip; }
+    void setClip(bool clip);
+
     bool isAncestorOf(const Item *item) const;
 
     Item *parent() const { return m_parent; }
@@ -228,7 +242,8 @@ protected:
         Layout      = 0x02,
         State       = 0x04,
         Enabled     = 0x08,
-        InputFocus  = 0x10
+        InputFocus  = 0x10,
+        TouchMove   = 0x20
     };
 
     virtual void activate();
@@ -237,6 +252,11 @@ protected:
     virtual void updateState(bool enabled);
     virtual void layout();
 
+    virtual bool dragPressed(int x, int y);
+    virtual void dragStarted(int x, int y);
+    virtual void dragMoved(int x, int y);
+    virtual void dragReleased(int x, int y, bool dragged);
+
     void invalidate(int flags);
     void invalidateParent(int flags);
 
@@ -263,6 +283,8 @@ protected:
     void setInputFocusOnPress(bool focus);
     void setAcceptsInputFocus(bool accept);
 
+    void setAcceptsDrags(bool accept);
+
     inline void invalidateSize();
     inline void invalidateFocus();
 
@@ -275,6 +297,8 @@ private:
     inline void layoutItems();
     inline void updateItems(int windowFlags, bool enabled);
     inline void drawItems(int dx, int dy, double opacity);
+    inline void updateBounds();
+    inline void invalidateBounds();
     inline void updateParent(Item *parent);
     inline void updateWindow(Window *window);
 
@@ -291,13 +315,20 @@ private:
     int m_height = 0;
     int m_itemFlags = 0;
     int m_invalidatedFlags = 0;
+    int m_boundsLeft = 0;
+    int m_boundsTop = 0;
+    int m_boundsRight = 0;
+    int m_boundsBottom = 0;
     bool m_enabled = true;
     bool m_canActivate = false;
     bool m_keyFocusOnPress = false;
     bool m_acceptsKeyFocus = false;
     bool m_inputFocusOnPress = false;
     bool m_acceptsInputFocus = false;
+    bool m_acceptsDrags = false;
     bool m_visible = true;
+    bool m_clip = false;
+    bool m_boundsValid = false;
 
 protected:
     typedef LinkedList<Item, &Item::m_childrenNode> ChildList;
@@ -311,7 +342,41 @@ public:
         KeyPressEffect,
         HapticCount
     };
+
+    struct TouchSample
+    {
+        int x;
+        int y;
+        int64_t time;
+    };
+
+    class TouchHistory
+    {
+    public:
+        enum {
+            Capacity = 64
+        };
+
+        bool empty() const { return m_count == 0; }
+        size_t size() const { return m_count; }
+
+        const TouchSample &operator[](size_t index) const { return m_samples[(m_head + index) % Capacity]; }
+        const TouchSample &front() const { return (*this)[0]; }
+        const TouchSample &back() const { return (*this)[m_count - 1]; }
+
+    private:
+        friend class Window;
+
+        void clear() { m_head = 0; m_count = 0; }
+        inline void append(const TouchSample &sample);
+
+        std::array<TouchSample, Capacity> m_samples;
+        size_t m_head = 0;
+        size_t m_count = 0;
+    };
+
     explicit Window(EventLoop *eventLoop);
+    Window(EventLoop *eventLoop, int width, int height);
     ~Window();
 
     Item *keyFocusItem() const { return m_keyFocusItem; }
@@ -335,11 +400,35 @@ public:
 
     void disablePowerButtonSelect();
 
+    const TouchHistory &touchHistory() const { return m_touchHistory; }
+    const TouchSample &pressSample() const { return m_pressSample; }
+
+    int frameCount() const { return m_frameCount; }
+
+    LatencyTracer *latencyTracer() const { return m_latencyTracer; }
+    void setLatencyTracer(LatencyTracer *tracer);
+
+    TouchResampler *touchResampler() const { return m_touchResampler; }
+    void setTouchResampler(TouchResampler *resampler);
+
+    const Keymap *keymap() const { return m_keymap; }
+    void setKeymap(const Keymap *keymap);
+    int keyModifiers() const { return m_keyModifiers; }
+    bool isHeadless() const { return m_headless; }
+
+    bool retainedRendering() const { return m_displayListRenderer; }
+    void setRetainedRendering(bool retained);
+
+    bool threadedRendering() const { return m_renderThread; }
+    void setThreadedRendering(bool threaded);
+
 protected:
     void draw(int x, int y, double opacity) override;
 
 private:
+    friend class Display;
     friend class EventLoop;
+    friend class InputReplayer;
     friend class Item;
 
     using Item::setX;
@@ -356,17 +445,26 @@ private:
     inline Item *previousKeyFocusItem(Item *item, int options = 0);
     inline Item *nextKeyFocusItem(Item *item, int options = 0);
 
-    void inputEvent(int fd, const input_event &event);
+    void inputFrame(int fd, const input_event *events, int count);
+    inline void keyEvent(const input_event &event);
+    inline void setKeyModifier(int modifier, bool active);
+
+    static int update_callback(int fd, uint32_t epevents, void *data);
+    inline void update();
+    void prerender();
 
-    static inline int update_callback(int fd, uint32_t epevents, void *data);
+    void fingerPressed(int x, int y, int64_t time);
+    void fingerMoved(int x, int y, int64_t time);
+    void fingerLifted(int x, int y, int64_t time);
 
-    void fingerPressed(int x, int y);
-    void fingerMoved(int x, int y);
-    void fingerLifted(int x, int y);
+    inline void appendTouchSample(int x, int y, int64_t time);
+    inline void deliverMove();
+    inline void cancelMove();
+    inline void startDrag();
 
-    static void fingerPressed(int x, int y, void *callbackData);
-    static void fingerMoved(int x, int y, void *callbackData);
-    static void fingerLifted(int x, int y, void *callbackData);
+    static void fingerPressed(int x, int y, int64_t time, void *callbackData);
+    static void fingerMoved(int x, int y, int64_t time, void *callbackData);
+    static void fingerLifted(int x, int y, int64_t time, void *callbackData);
 
     struct Axis {
         int value = 0;
@@ -382,9 +480,14 @@ private:
     };
     struct {
         Item *item = nullptr;
+        Item *dragItem = nullptr;
+        bool dragging = false;
         Axis x;
         Axis y;
     } m_touch;
+    TouchHistory m_touchHistory;
+    TouchSample m_pressSample = { 0, 0, 0 };
+    int64_t m_lastSampleTime = 0;
     Item *m_keyFocusItem = nullptr;
     Item *m_inputFocusItem = nullptr;
     Item *m_pressedItem = nullptr;
@@ -393,6 +496,16 @@ private:
     int m_effectIds[HapticCount] = { -1 };
     Color m_color { 0, 0, 0, 255 };
     MultiTouch *m_multiTouch;
+    LatencyTracer *m_latencyTracer = nullptr;
+    DisplayListRenderer *m_displayListRenderer = nullptr;
+    RenderThread *m_renderThread = nullptr;
+    TouchResampler *m_touchResampler = nullptr;
+    const Keymap *m_keymap;
+    int m_keyModifiers = 0;
+    int m_shiftKeys = 0;
+    int m_frameCount = 0;
+    const bool m_headless = false;
+    bool m_graphicsInitialized = false;
 };
 
 class ResizeableItem : public Item
@@ -35,6 +35,14 @@
 ****************************************************************************************/
 
 #include "keyboard.h"
+#include "keymap.h"
+#include "logging.h"
+#include "surface.h"
+#include "wordpredictor.h"
+
+#include <string.h>
+
+#include <algorithm>
 
 namespace Sailfish { namespace MinUi {
 
@@ -54,6 +62,15 @@ void KeyboardButtonBase::setState(KeyboardState)
     // nothing
 }
 
+/*
+    Renders the decoration of a button at x, y in the alpha \a mask a cached keyboard is drawn
+    from.
+*/
+void KeyboardButtonBase::render(GRSurface *, int, int, KeyboardState)
+{
+    // nothing
+}
+
 void KeyboardButtonBase::activate()
 {
     Window * const window = Item::window();
@@ -93,7 +110,17 @@ void KeyboardButton::setState(KeyboardState state)
         m_character = m_char_symbol;
         break;
     }
-    m_label.setText(std::string(1, m_character));
+    if (!m_keyboard->cachedRendering()) {
+        m_label.setText(std::string(1, m_character));
+    }
+}
+
+void KeyboardButton::render(GRSurface *mask, int x, int y, KeyboardState state)
+{
+    const char character = state == KeyboardState::lowercase
+            ? m_char_lower
+            : state == KeyboardState::uppercase ? m_char_upper : m_char_symbol;
+    compositeText(mask, x + (width() / 2), y + (height() / 2), std::string(1, character));
 }
 
 void KeyboardButton::layout()
@@ -113,9 +140,7 @@ void KeyboardButton::updateState(bool enabled)
 
 SpaceButton::SpaceButton(Keyboard *parent)
     : KeyboardButtonBase(parent)
-    , m_left("icon-m-spacebar-left", this)
-    , m_middle("icon-m-spacebar-middle", this)
-    , m_right("icon-m-spacebar-right", this)
+    , m_bar("icon-m-spacebar", this)
 {
     m_character = ' ';
 }
@@ -126,13 +151,13 @@ SpaceButton::~SpaceButton()
 
 void SpaceButton::layout()
 {
-    m_middle.centerIn(*this);
-
-    m_left.align(Right, m_middle, Left);
-    m_left.align(Bottom, m_middle, Bottom);
+    m_bar.resize(std::min(width(), 3 * m_bar.implicitWidth()), m_bar.implicitHeight());
+    m_bar.centerIn(*this);
+}
 
-    m_right.align(Left, m_middle, Right);
-    m_right.align(Bottom, m_middle, Bottom);
+void SpaceButton::render(GRSurface *mask, int x, int y, KeyboardState)
+{
+    m_bar.composite(mask, x + m_bar.x(), y + m_bar.y());
 }
 
 void SpaceButton::updateState(bool enabled)
@@ -145,9 +170,7 @@ void SpaceButton::updateState(bool enabled)
         color = m_keyboard->palette().normal;
     }
 
-    m_left.setColor(color);
-    m_right.setColor(color);
-    m_middle.setColor(color);
+    m_bar.setColor(color);
 }
 
 KeyboardIconButton::KeyboardIconButton(Keyboard *parent, const char *icon, int keycode)
@@ -166,6 +189,11 @@ void KeyboardIconButton::layout()
     m_icon.centerIn(*this);
 }
 
+void KeyboardIconButton::render(GRSurface *mask, int x, int y, KeyboardState)
+{
+    m_icon.composite(mask, x + m_icon.x(), y + m_icon.y(), isEnabled() ? 1.0 : 0.6);
+}
+
 void KeyboardIconButton::updateState(bool enabled)
 {
     setOpacity(enabled ? 1.0 : 0.6);
@@ -202,6 +230,15 @@ void ShiftButton::layout()
     m_shiftOn.centerIn(*this);
 }
 
+void ShiftButton::render(GRSurface *mask, int x, int y, KeyboardState state)
+{
+    if (state == KeyboardState::lowercase) {
+        m_shiftOff.composite(mask, x + m_shiftOff.x(), y + m_shiftOff.y());
+    } else if (state == KeyboardState::uppercase) {
+        m_shiftOn.composite(mask, x + m_shiftOn.x(), y + m_shiftOn.y());
+    }
+}
+
 void ShiftButton::updateState(bool enabled)
 {
     (void) enabled;
@@ -241,6 +278,15 @@ void SymbolButton::layout()
     m_label.centerIn(*this);
 }
 
+void SymbolButton::render(GRSurface *mask, int x, int y, KeyboardState state)
+{
+    compositeText(
+                mask,
+                x + (width() / 2),
+                y + (height() / 2),
+                state != KeyboardState::symbol ? "?123" : "ABC");
+}
+
 void SymbolButton::updateState(bool enabled)
 {
     (void) enabled;
@@ -251,15 +297,65 @@ void SymbolButton::updateState(bool enabled)
     }
 }
 
-namespace {
-// Definition for a keyboard Qwerty layout.
-const std::string row_1_lowercase {'q', 'w', 'e', 'r', 't', 'y', 'u', 'i', 'o', 'p'};
-const std::string row_2_lowercase {'a', 's', 'd', 'f', 'g', 'h', 'j', 'k', 'l'};
-const std::string row_3_lowercase {'z', 'x', 'c', 'v', 'b', 'n', 'm'};
+/*
+    A button showing a candidate completion of the entered word, the text is drawn directly
+    from the predictor's buffer so a keystroke doesn't allocate a label.
+*/
+PredictionButton::PredictionButton(Keyboard *parent, int index)
+    : KeyboardButtonBase(parent)
+    , m_index(index)
+{
+    gr_font_size(&m_fontWidth, &m_fontHeight);
+    setEnabled(false);
+}
 
-const std::string row_1_uppercase {'Q', 'W', 'E', 'R', 'T', 'Y', 'U', 'I', 'O', 'P'};
-const std::string row_2_uppercase {'A', 'S', 'D', 'F', 'G', 'H', 'J', 'K', 'L'};
-const std::string row_3_uppercase {'Z', 'X', 'C', 'V', 'B', 'N', 'M'};
+PredictionButton::~PredictionButton()
+{
+}
+
+void PredictionButton::activate()
+{
+    Window * const window = Item::window();
+
+    if (window) {
+        window->playHaptic(Window::KeyPressEffect);
+    }
+
+    m_keyboard->acceptPrediction(m_index);
+}
+
+void PredictionButton::draw(int x, int y, double opacity)
+{
+    const char * const prediction = m_keyboard->prediction(m_index);
+    const uint8_t alpha = m_color.a * opacity;
+    if (!prediction || alpha == 0 || m_fontWidth <= 0) {
+        return;
+    }
+
+    char text[WordPredictor::MaximumWordLength + 1];
+    const int length = std::min<int>(strlen(prediction), std::max(0, width() / m_fontWidth));
+    memcpy(text, prediction, length);
+    text[length] = '\0';
+
+    setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+    drawText(
+                x + ((width() - (length * m_fontWidth)) / 2),
+                y + ((height() - m_fontHeight) / 2),
+                text,
+                0);
+}
+
+void PredictionButton::updateState(bool enabled)
+{
+    (void) enabled;
+    m_color = isPressed() ? m_keyboard->palette().pressed : m_keyboard->palette().normal;
+}
+
+namespace {
+// The keys of a keyboard.  The letters are those of the window's keymap for the key codes.
+const std::vector<int> row_1_codes {KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y, KEY_U, KEY_I, KEY_O, KEY_P};
+const std::vector<int> row_2_codes {KEY_A, KEY_S, KEY_D, KEY_F, KEY_G, KEY_H, KEY_J, KEY_K, KEY_L};
+const std::vector<int> row_3_codes {KEY_Z, KEY_X, KEY_C, KEY_V, KEY_B, KEY_N, KEY_M};
 
 const std::string row_1_symbol {'1', '2', '3', '4', '5', '6', '7', '8', '9', '0'};
 const std::string row_2_symbol {'*', '#', '+', '-', '=', '(', ')', '!', '?'};
@@ -269,6 +365,18 @@ const std::string row_3_symbol {'@', '&', '/', '\\', '\'', ';', ':'};
 /*!
     \class Sailfish::MinUi::Keyboard
     \brief An alphanumeric input keyboard.
+
+    The letters of the keyboard are those of the window's \l {Window::keymap()}{keymap} when
+    the keyboard is created.
+
+    By default each key is an item drawing its own label or icon.  With
+    \l setCachedRendering() enabled the keys of each keyboard state are instead rendered once
+    into an alpha mask that is drawn in a single operation, with only the pressed key drawn
+    separately, and the pressed key is found from the row and column under the touch rather
+    than by searching the key items.
+
+    With a \l setWordPredictor() {word predictor} the keyboard gains a row above the keys
+    showing completions of the word being entered, selecting one enters the rest of the word.
 */
 Keyboard::Keyboard(Item *parent)
     : ResizeableItem(parent)
@@ -288,6 +396,11 @@ Keyboard::Keyboard(Item *parent)
 */
 Keyboard::~Keyboard()
 {
+    clearCache();
+
+    for (const auto button : m_predictions) {
+        delete button;
+    }
     for (const auto button : m_keyrow1) {
         delete button;
     }
@@ -308,7 +421,266 @@ bool Keyboard::enterEnabled() const
 
 void Keyboard::setEnterEnabled(bool enabled)
 {
-    m_enter.setEnabled(enabled);
+    if (m_enter.isEnabled() != enabled) {
+        m_enter.setEnabled(enabled);
+
+        clearCache();
+        invalidate(Draw);
+    }
+}
+
+/*!
+    \fn bool Sailfish::MinUi::Keyboard::cachedRendering() const
+
+    Returns true if the keyboard is drawn from cached images of its states.
+*/
+
+/*!
+    Sets whether the keyboard is drawn from \a cached images of its states.
+
+    Cached rendering requires the font glyphs to be loadable as a resource, if they aren't the
+    keyboard continues to draw each key individually.
+*/
+void Keyboard::setCachedRendering(bool cached)
+{
+    if (m_cachedRendering == cached) {
+        return;
+    } else if (cached && !hasFontGlyphs()) {
+        log_warning("Keyboard: cached rendering is unavailable");
+        return;
+    }
+
+    m_cachedRendering = cached;
+    m_pressedKey = -1;
+    clearCache();
+
+    setCanActivate(cached);
+    for (const CachedKey &key : m_keys) {
+        key.button->setVisible(!cached);
+    }
+
+    // Restore the label text which isn't maintained while cached.
+    setKeyState(m_state);
+
+    invalidate(Draw | State);
+}
+
+/*!
+    \fn Sailfish::MinUi::WordPredictor *Sailfish::MinUi::Keyboard::wordPredictor() const
+
+    Returns the predictor which provides completions of the entered word.
+*/
+
+/*!
+    Sets the \a predictor which provides completions of the entered word.
+
+    The keyboard doesn't take ownership of the predictor, which must outlive it or be unset.
+    Adding a predictor adds a row to the keyboard and increases its height accordingly.
+*/
+void Keyboard::setWordPredictor(WordPredictor *predictor)
+{
+    if (m_wordPredictor == predictor) {
+        return;
+    }
+
+    if (!m_wordPredictor) {
+        for (int i = 0; i < PredictionCount; ++i) {
+            m_predictions[i] = new PredictionButton(this, i);
+        }
+        setHeight(height() + (height() / RowCount));
+    } else if (!predictor) {
+        for (PredictionButton *&button : m_predictions) {
+            delete button;
+            button = nullptr;
+        }
+        setHeight(height() - (height() / (RowCount + 1)));
+    }
+
+    m_wordPredictor = predictor;
+
+    if (m_wordPredictor) {
+        m_wordPredictor->reset();
+        updatePredictions();
+    }
+}
+
+/*!
+    Returns the completion of the entered word shown at \a index, or null if there is none.
+*/
+const char *Keyboard::prediction(int index) const
+{
+    return m_wordPredictor && index >= 0 && index < m_wordPredictor->candidateCount()
+            ? m_wordPredictor->candidate(index)
+            : nullptr;
+}
+
+/*!
+    Enters the remainder of the completion at \a index followed by a space.
+*/
+void Keyboard::acceptPrediction(int index)
+{
+    const char * const prediction = Keyboard::prediction(index);
+    if (!prediction) {
+        return;
+    }
+
+    // Entering characters updates the candidates so copy the accepted one first.
+    char word[WordPredictor::MaximumWordLength + 1];
+    strcpy(word, prediction);
+
+    for (const char *character = word + m_wordPredictor->prefixLength(); *character; ++character) {
+        handleInput(0, *character);
+    }
+    handleInput(0, ' ');
+}
+
+/*!
+    Activates the key under a touch if it was pressed and released on the same key when the
+    keyboard is cached.
+*/
+void Keyboard::activate()
+{
+    const int key = touchedKey(true);
+    if (key >= 0 && key == touchedKey(false) && m_keys[key].button->isEnabled()) {
+        m_keys[key].button->activate();
+    }
+}
+
+/*!
+    Draws the cached image of the current keyboard state at \a x, \a y with the given
+    accumulative \a opacity.
+*/
+void Keyboard::draw(int x, int y, double opacity)
+{
+    if (!m_cachedRendering) {
+        return;
+    }
+
+    gr_surface &cache = m_cache[int(m_state)];
+    if (!cache) {
+        cache = createAlphaSurface(width(), height());
+        if (!cache) {
+            return;
+        }
+        MaskRasterizer rasterizer(cache);
+        for (const CachedKey &key : m_keys) {
+            key.button->render(cache, key.x, key.y, m_state);
+        }
+        rasterizer.rasterize();
+    }
+
+    if (m_pressedKey >= 0) {
+        const CachedKey &key = m_keys[m_pressedKey];
+        drawAlphaSurface(
+                    x, y, cache, m_palette.normal,
+                    key.x, key.y, key.width, key.height, m_palette.pressed,
+                    opacity);
+    } else {
+        drawAlphaSurface(x, y, cache, m_palette.normal, opacity);
+    }
+}
+
+/*!
+    Updates the pressed key of a cached keyboard.
+*/
+void Keyboard::updateState(bool enabled)
+{
+    Window * const window = Item::window();
+    Item * const inputFocusItem = window ? window->inputFocusItem() : nullptr;
+    if (m_inputFocusItem != inputFocusItem) {
+        // The word being entered is only known while the same item has focus.
+        m_inputFocusItem = inputFocusItem;
+        if (m_wordPredictor) {
+            m_wordPredictor->reset();
+            updatePredictions();
+        }
+    }
+
+    int pressedKey = -1;
+    if (m_cachedRendering && enabled && isPressed()) {
+        pressedKey = touchedKey(true);
+        if (pressedKey >= 0 && !m_keys[pressedKey].button->isEnabled()) {
+            pressedKey = -1;
+        }
+    }
+
+    if (m_pressedKey != pressedKey) {
+        m_pressedKey = pressedKey;
+        invalidate(Draw);
+    }
+}
+
+/*
+    Returns the index of the key at the position \a x, \a y relative to the keyboard, or -1 if
+    there is no key there.
+*/
+int Keyboard::keyAt(int x, int y) const
+{
+    if (m_rowHeight <= 0 || x < 0 || x >= width() || y < m_rowTop) {
+        return -1;
+    }
+
+    const int row = (y - m_rowTop) / m_rowHeight;
+    if (row >= RowCount) {
+        return -1;
+    }
+
+    // The keys in a row are ordered by position so the key is the last to start before x.
+    const auto begin = m_keys.begin() + m_rowStart[row];
+    const auto end = m_keys.begin() + m_rowStart[row + 1];
+    const auto it = std::upper_bound(begin, end, x, [](int x, const CachedKey &key) {
+        return x < key.x;
+    });
+    if (it == begin) {
+        return -1;
+    }
+
+    const CachedKey &key = *(it - 1);
+    return x < key.x + key.width ? int(it - 1 - m_keys.begin()) : -1;
+}
+
+/*
+    Returns the index of the key under the press, if \a first is true, or the last position of
+    the current touch.
+*/
+int Keyboard::touchedKey(bool first) const
+{
+    Window * const window = Item::window();
+    if (!window || window->touchHistory().empty()) {
+        return -1;
+    }
+
+    // The history only holds the most recent samples so the press is kept separately.
+    const Window::TouchSample &sample = first
+            ? window->pressSample()
+            : window->touchHistory().back();
+
+    int x = sample.x;
+    int y = sample.y;
+    for (const Item *item = this; item; item = item->parent()) {
+        x -= item->x();
+        y -= item->y();
+    }
+    return keyAt(x, y);
+}
+
+void Keyboard::clearCache()
+{
+    for (gr_surface &cache : m_cache) {
+        freeSurface(cache);
+        cache = nullptr;
+    }
+}
+
+/*
+    Shows the current completions of the entered word in the prediction row.
+*/
+void Keyboard::updatePredictions()
+{
+    for (int i = 0; i < PredictionCount; ++i) {
+        m_predictions[i]->setEnabled(i < m_wordPredictor->candidateCount());
+        m_predictions[i]->invalidate(Draw);
+    }
 }
 
 void Keyboard::handleInput(int code, char character)
@@ -323,6 +695,17 @@ void Keyboard::handleInput(int code, char character)
         setKeyState(KeyboardState::lowercase);
     }
 
+    if (m_wordPredictor) {
+        if (code == KEY_BACKSPACE) {
+            m_wordPredictor->backspace();
+        } else if (code == KEY_ENTER) {
+            m_wordPredictor->reset();
+        } else if (character != '\0') {
+            m_wordPredictor->append(character);
+        }
+        updatePredictions();
+    }
+
     if (m_keyPress) {
         m_keyPress(code, character);
     } else {
@@ -360,7 +743,7 @@ static void placeRow(const std::vector<KeyboardButton*> &keyRow, ResizeableItem
 
 void Keyboard::layout()
 {
-    int keyHeight = height() / 4;
+    int keyHeight = height() / (m_wordPredictor ? RowCount + 1 : RowCount);
     int keyWidth = width() / m_keyrow1.size();
     int funcKeyWidth = (width() - m_keyrow3.size() * keyWidth) / 2;
     int largeFuncKeyWidth = funcKeyWidth * 1.25;
@@ -400,27 +783,80 @@ void Keyboard::layout()
     placeRow(m_keyrow3, this, &m_space, keyWidth, keyHeight, funcKeyWidth);
     placeRow(m_keyrow2, this, m_keyrow3[0], keyWidth, keyHeight, keyWidth/2);
     placeRow(m_keyrow1, this, m_keyrow2[0], keyWidth, keyHeight);
+
+    if (m_wordPredictor) {
+        const int predictionWidth = width() / PredictionCount;
+        for (int i = 0; i < PredictionCount; ++i) {
+            m_predictions[i]->resize(predictionWidth, keyHeight);
+            m_predictions[i]->align(Left, *this, Left, i * predictionWidth);
+            m_predictions[i]->align(Bottom, *m_keyrow1[0], Top);
+        }
+    }
+
+    m_rowHeight = keyHeight;
+    m_rowTop = height() - (RowCount * keyHeight);
+    for (CachedKey &key : m_keys) {
+        // The buttons are hidden while the keyboard is cached so the window doesn't lay them
+        // out, their decorations are positioned here before the cache is rendered.
+        key.button->layout();
+
+        key.x = key.button->x();
+        key.y = key.button->y();
+        key.width = key.button->width();
+        key.height = key.button->height();
+    }
+    for (int row = 0; row < RowCount; ++row) {
+        std::sort(m_keys.begin() + m_rowStart[row], m_keys.begin() + m_rowStart[row + 1],
+                  [](const CachedKey &left, const CachedKey &right) { return left.x < right.x; });
+    }
+
+    clearCache();
 }
 
 void Keyboard::createKeys()
 {
-    auto createKeys = [this](const std::string &lowers, const std::string &uppers, const std::string &symbols) {
-        size_t n = lowers.size();
+    Window * const window = Item::window();
+    const Keymap &keymap = window ? *window->keymap() : Keymap::system();
+
+    auto createKeys = [this, &keymap](const std::vector<int> &codes, const std::string &symbols) {
+        size_t n = codes.size();
         std::vector<KeyboardButton*> keys;
         for (size_t i = 0; i < n; ++i) {
-            keys.push_back(new KeyboardButton(lowers[i], uppers[i], symbols[i], this));
+            keys.push_back(new KeyboardButton(
+                    keymap.character(codes[i]),
+                    keymap.character(codes[i], Keymap::Shift),
+                    symbols[i],
+                    this));
         }
         return keys;
     };
 
-    m_keyrow1 = createKeys(row_1_lowercase, row_1_uppercase, row_1_symbol);
-    m_keyrow2 = createKeys(row_2_lowercase, row_2_uppercase, row_2_symbol);
-    m_keyrow3 = createKeys(row_3_lowercase, row_3_uppercase, row_3_symbol);
+    m_keyrow1 = createKeys(row_1_codes, row_1_symbol);
+    m_keyrow2 = createKeys(row_2_codes, row_2_symbol);
+    m_keyrow3 = createKeys(row_3_codes, row_3_symbol);
 
     m_dotKey = new KeyboardButton('.', '.', '.', this);
     m_commaKey = new KeyboardButton(',', ',', ',', this);
     m_dotKey->setState(KeyboardState::lowercase);
     m_commaKey->setState(KeyboardState::lowercase);
+
+    // The keys grouped by row, top to bottom, for cached rendering.
+    std::vector<KeyboardButtonBase *> row3 { &m_shift, &m_backspace };
+    row3.insert(row3.end(), m_keyrow3.begin(), m_keyrow3.end());
+
+    const std::vector<std::vector<KeyboardButtonBase *>> rows = {
+        { m_keyrow1.begin(), m_keyrow1.end() },
+        { m_keyrow2.begin(), m_keyrow2.end() },
+        row3,
+        { &m_symbolButton, m_commaKey, &m_space, m_dotKey, &m_enter }
+    };
+    for (int row = 0; row < RowCount; ++row) {
+        m_rowStart[row] = m_keys.size();
+        for (KeyboardButtonBase *button : rows[row]) {
+            m_keys.push_back({ button, 0, 0, 0, 0 });
+        }
+    }
+    m_rowStart[RowCount] = m_keys.size();
 }
 
 void Keyboard::setKeyState(KeyboardState state)
@@ -438,6 +874,10 @@ void Keyboard::setKeyState(KeyboardState state)
 
     m_symbolButton.setState(m_state);
     m_shift.setState(m_state);
+
+    if (m_cachedRendering) {
+        invalidate(Draw);
+    }
 }
 
 }}
@@ -39,6 +39,7 @@
 
 #include <sailfish-minui/icon.h>
 #include <sailfish-minui/label.h>
+#include <sailfish-minui/ninepatch.h>
 #include <linux/input.h>
 
 #include <vector>
@@ -46,6 +47,7 @@
 namespace Sailfish { namespace MinUi {
 
 class Keyboard;
+class WordPredictor;
 enum class KeyboardState {lowercase, uppercase, symbol};
 
 class KeyboardButtonBase : public ResizeableItem
@@ -57,7 +59,10 @@ public:
     virtual void setState(KeyboardState state);
 
 protected:
+    friend class Keyboard;
+
     void activate() override;
+    virtual void render(GRSurface *mask, int x, int y, KeyboardState state);
 
     Keyboard *m_keyboard;
     int m_code = 0;
@@ -75,6 +80,7 @@ public:
 protected:
     void layout();
     void updateState(bool enabled);
+    void render(GRSurface *mask, int x, int y, KeyboardState state);
 
 private:
     LiteralLabel m_label;
@@ -93,11 +99,10 @@ public:
 protected:
     void layout();
     void updateState(bool enabled);
+    void render(GRSurface *mask, int x, int y, KeyboardState state);
 
 private:
-    Icon m_left;
-    Icon m_middle;
-    Icon m_right;
+    NinePatch m_bar;
 };
 
 class KeyboardIconButton : public KeyboardButtonBase
@@ -109,6 +114,7 @@ public:
 protected:
     void layout();
     void updateState(bool enabled);
+    void render(GRSurface *mask, int x, int y, KeyboardState state);
 
 private:
     Icon m_icon;
@@ -125,6 +131,7 @@ public:
 protected:
     void layout();
     void updateState(bool enabled);
+    void render(GRSurface *mask, int x, int y, KeyboardState state);
 
 private:
     Icon m_shiftOff;
@@ -142,11 +149,30 @@ public:
 protected:
     void layout();
     void updateState(bool enabled);
+    void render(GRSurface *mask, int x, int y, KeyboardState state);
 
 private:
     LiteralLabel m_label;
 };
 
+class PredictionButton : public KeyboardButtonBase
+{
+public:
+    PredictionButton(Keyboard *parent, int index);
+    ~PredictionButton();
+
+protected:
+    void activate() override;
+    void draw(int x, int y, double opacity) override;
+    void updateState(bool enabled) override;
+
+private:
+    Color m_color;
+    int m_index;
+    int m_fontWidth = 0;
+    int m_fontHeight = 0;
+};
+
 class Keyboard : public ResizeableItem
 {
 public:
@@ -161,16 +187,58 @@ public:
     Palette palette() const { return m_palette; }
     void handleInput(int code, char character);
 
+    bool cachedRendering() const { return m_cachedRendering; }
+    void setCachedRendering(bool cached);
+
+    WordPredictor *wordPredictor() const { return m_wordPredictor; }
+    void setWordPredictor(WordPredictor *predictor);
+
+    const char *prediction(int index) const;
+    void acceptPrediction(int index);
+
 protected:
+    void activate() override;
+    void draw(int x, int y, double opacity) override;
+    void updateState(bool enabled) override;
     void layout() override;
 
 private:
+    struct CachedKey
+    {
+        KeyboardButtonBase *button;
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    enum {
+        RowCount = 4,
+        StateCount = 3,
+        PredictionCount = 3
+    };
+
     void createKeys();
     void setKeyState(KeyboardState state);
 
+    inline int keyAt(int x, int y) const;
+    inline int touchedKey(bool first) const;
+    inline void clearCache();
+    inline void updatePredictions();
+
     std::function<void(int code, char character)> m_keyPress;
     KeyboardState m_state {KeyboardState::lowercase};
     Palette m_palette;
+    bool m_cachedRendering = false;
+    int m_pressedKey = -1;
+    int m_rowTop = 0;
+    int m_rowHeight = 0;
+    int m_rowStart[RowCount + 1] = {};
+    std::vector<CachedKey> m_keys;
+    gr_surface m_cache[StateCount] = {};
+    WordPredictor *m_wordPredictor = nullptr;
+    Item *m_inputFocusItem = nullptr;
+    PredictionButton *m_predictions[PredictionCount] = {};
 
     SpaceButton m_space;
     SymbolButton m_symbolButton;
@@ -0,0 +1,288 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "keymap.h"
+#include "logging.h"
+
+#include <linux/input.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace Sailfish { namespace MinUi {
+
+namespace {
+
+// The keys which differ between layouts, in the order their characters are listed in a
+// layout's levels.  Left to right, top to bottom, with the ISO key between left shift and Z
+// at the start of the last row.
+enum {
+    PositionCount = 48
+};
+
+constexpr uint8_t positionCodes[PositionCount] = {
+    KEY_GRAVE, KEY_1, KEY_2, KEY_3, KEY_4, KEY_5, KEY_6, KEY_7, KEY_8, KEY_9, KEY_0, KEY_MINUS, KEY_EQUAL,
+    KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y, KEY_U, KEY_I, KEY_O, KEY_P, KEY_LEFTBRACE, KEY_RIGHTBRACE,
+    KEY_A, KEY_S, KEY_D, KEY_F, KEY_G, KEY_H, KEY_J, KEY_K, KEY_L, KEY_SEMICOLON, KEY_APOSTROPHE, KEY_BACKSLASH,
+    KEY_102ND, KEY_Z, KEY_X, KEY_C, KEY_V, KEY_B, KEY_N, KEY_M, KEY_COMMA, KEY_DOT, KEY_SLASH
+};
+
+// The characters of each layout without and with shift and with AltGr.  Only ASCII can be
+// drawn with the minui font so a space marks a key which produces no character.
+#define LAYOUT_LEVEL(name, row1, row2, row3, row4) \
+    constexpr char name[] = row1 row2 row3 row4; \
+    static_assert(sizeof(name) == PositionCount + 1, #name " must have a character for every key");
+
+LAYOUT_LEVEL(usPlain,   "`1234567890-=", "qwertyuiop[]", "asdfghjkl;'\\", "<zxcvbnm,./")
+LAYOUT_LEVEL(usShifted, "~!@#$%^&*()_+", "QWERTYUIOP{}", "ASDFGHJKL:\"|", ">ZXCVBNM<>?")
+LAYOUT_LEVEL(usAltGr,   "             ", "            ", "            ", "           ")
+
+LAYOUT_LEVEL(gbPlain,   "`1234567890-=", "qwertyuiop[]", "asdfghjkl;'#", "\\zxcvbnm,./")
+LAYOUT_LEVEL(gbShifted, " !\" $%^&*()_+", "QWERTYUIOP{}", "ASDFGHJKL:@~", "|ZXCVBNM<>?")
+LAYOUT_LEVEL(gbAltGr,   "|            ", "            ", "            ", "           ")
+
+LAYOUT_LEVEL(dePlain,   "^1234567890  ", "qwertzuiop +", "asdfghjkl  #", "<yxcvbnm,.-")
+LAYOUT_LEVEL(deShifted, " !\" $%&/()=?`", "QWERTZUIOP *", "ASDFGHJKL  '", ">YXCVBNM;:_")
+LAYOUT_LEVEL(deAltGr,   "       {[]}\\ ", "@          ~", "            ", "|          ")
+
+LAYOUT_LEVEL(fiPlain,   " 1234567890+ ", "qwertyuiop  ", "asdfghjkl  '", "<zxcvbnm,.-")
+LAYOUT_LEVEL(fiShifted, " !\"# %&/()=?`", "QWERTYUIOP ^", "ASDFGHJKL  *", ">ZXCVBNM;:_")
+LAYOUT_LEVEL(fiAltGr,   "  @ $  {[]}\\ ", "           ~", "            ", "|          ")
+
+#undef LAYOUT_LEVEL
+
+struct LayoutDefinition
+{
+    const char *plain;
+    const char *shifted;
+    const char *altGr;
+};
+
+constexpr int position(int code, int index = 0)
+{
+    return index == PositionCount
+            ? -1
+            : positionCodes[index] == code ? index : position(code, index + 1);
+}
+
+constexpr char keypadCharacter(int code)
+{
+    return code >= KEY_KP7 && code <= KEY_KPDOT
+            ? "789-456+1230."[code - KEY_KP7]
+            : code == KEY_KPASTERISK ? '*' : code == KEY_KPSLASH ? '/' : '\0';
+}
+
+constexpr char defined(char character)
+{
+    return character != ' ' ? character : '\0';
+}
+
+constexpr bool isLetter(char character)
+{
+    return character >= 'a' && character <= 'z';
+}
+
+constexpr char positionCharacter(const LayoutDefinition &layout, int modifiers, int index)
+{
+    return index < 0
+            ? '\0'
+            : (modifiers & Keymap::AltGr)
+                ? defined(layout.altGr[index])
+                // Caps lock inverts shift for letters only.
+                : ((modifiers & Keymap::Shift) != 0) != ((modifiers & Keymap::CapsLock) != 0 && isLetter(layout.plain[index]))
+                    ? defined(layout.shifted[index])
+                    : defined(layout.plain[index]);
+}
+
+constexpr char character(const LayoutDefinition &layout, int modifiers, int code)
+{
+    return code == KEY_SPACE
+            ? ' '
+            : keypadCharacter(code) != '\0'
+                ? keypadCharacter(code)
+                : positionCharacter(layout, modifiers, position(code));
+}
+
+template <int... Codes> struct KeyCodes {};
+template <int Count, int... Codes> struct MakeKeyCodes : MakeKeyCodes<Count - 1, Count - 1, Codes...> {};
+template <int... Codes> struct MakeKeyCodes<0, Codes...> { typedef KeyCodes<Codes...> Type; };
+
+template <int... Codes>
+constexpr Keymap::Table::Row makeRow(const LayoutDefinition &layout, int modifiers, KeyCodes<Codes...>)
+{
+    return {{ character(layout, modifiers, Codes)... }};
+}
+
+constexpr Keymap::Table makeTable(const LayoutDefinition &layout)
+{
+    typedef MakeKeyCodes<Keymap::KeyCount>::Type Codes;
+
+    return {{
+        makeRow(layout, 0, Codes()),
+        makeRow(layout, 1, Codes()),
+        makeRow(layout, 2, Codes()),
+        makeRow(layout, 3, Codes()),
+        makeRow(layout, 4, Codes()),
+        makeRow(layout, 5, Codes()),
+        makeRow(layout, 6, Codes()),
+        makeRow(layout, 7, Codes())
+    }};
+}
+
+static_assert(Keymap::ModifierCombinations == 8, "A table must have a row for every modifier combination");
+
+constexpr LayoutDefinition usLayout = { usPlain, usShifted, usAltGr };
+constexpr LayoutDefinition gbLayout = { gbPlain, gbShifted, gbAltGr };
+constexpr LayoutDefinition deLayout = { dePlain, deShifted, deAltGr };
+constexpr LayoutDefinition fiLayout = { fiPlain, fiShifted, fiAltGr };
+
+// Every character for every key and modifier combination is computed by the compiler so
+// translating a key is a single array lookup.
+constexpr Keymap keymaps[Keymap::LayoutCount] = {
+    Keymap("us", makeTable(usLayout)),
+    Keymap("gb", makeTable(gbLayout)),
+    Keymap("de", makeTable(deLayout)),
+    Keymap("fi", makeTable(fiLayout))
+};
+
+static_assert(keymaps[Keymap::UnitedStates].character(KEY_A, Keymap::Shift) == 'A', "Shift selects the upper case");
+static_assert(keymaps[Keymap::UnitedStates].character(KEY_1, Keymap::CapsLock) == '1', "Caps lock only affects letters");
+static_assert(keymaps[Keymap::German].character(KEY_Y) == 'z', "German keyboards are QWERTZ");
+static_assert(keymaps[Keymap::German].character(KEY_Q, Keymap::AltGr) == '@', "AltGr selects the third level");
+
+}
+
+/*!
+    \class Sailfish::MinUi::Keymap
+    \brief Translates linux input key codes to characters.
+
+    A keymap holds a table of the character produced by every key code below KeyCount for each
+    combination of modifiers.  The tables are computed at compile time from the per layout
+    key assignments so a translation is a single bounds checked array lookup.
+
+    The minui font only has glyphs for printable ASCII so keys which produce other characters
+    in a layout produce no character.
+*/
+
+/*!
+    \enum Sailfish::MinUi::Keymap::Layout
+
+    \value UnitedStates The US QWERTY layout.
+    \value UnitedKingdom The UK QWERTY layout.
+    \value German The German QWERTZ layout.
+    \value Finnish The Finnish and Swedish QWERTY layout.
+*/
+
+/*!
+    \enum Sailfish::MinUi::Keymap::Modifier
+
+    \value NoModifiers No modifier is active.
+    \value Shift A shift key is held.
+    \value CapsLock Caps lock is on, this changes the case of letters only.
+    \value AltGr The AltGr key is held.
+*/
+
+/*!
+    Returns the keymap for a \a layout.
+*/
+const Keymap &Keymap::layout(Layout layout)
+{
+    return layout >= 0 && layout < LayoutCount ? keymaps[layout] : keymaps[UnitedStates];
+}
+
+/*!
+    Returns the keymap with the given \a name, or null if there is no such keymap.
+
+    Keymaps are named with the layout names of the xkb keyboard configuration, \c us, \c gb,
+    \c de and \c fi.
+*/
+const Keymap *Keymap::find(const char *name)
+{
+    for (const Keymap &keymap : keymaps) {
+        if (strcmp(keymap.name(), name) == 0) {
+            return &keymap;
+        }
+    }
+    return nullptr;
+}
+
+/*!
+    Returns the keymap selected for the system.
+
+    This is the keymap named by the SAILFISH_KEYMAP environment variable if set, otherwise one
+    is chosen from the territory or language of the LANG environment variable.
+*/
+const Keymap &Keymap::system()
+{
+    static const Keymap * const keymap = [] {
+        if (const char * const env = getenv("SAILFISH_KEYMAP")) {
+            if (const Keymap * const keymap = find(env)) {
+                return keymap;
+            }
+            log_warning("Keymap: unknown keymap " << env);
+        }
+
+        const char * const locale = getenv("LANG");
+        if (!locale) {
+            return &keymaps[UnitedStates];
+        } else if (strncmp(locale, "en_GB", 5) == 0) {
+            return &keymaps[UnitedKingdom];
+        } else if (strncmp(locale, "de_", 3) == 0) {
+            return &keymaps[German];
+        } else if (strncmp(locale, "fi_", 3) == 0 || strncmp(locale, "sv_", 3) == 0) {
+            return &keymaps[Finnish];
+        } else {
+            return &keymaps[UnitedStates];
+        }
+    }();
+
+    return *keymap;
+}
+
+/*!
+    \fn const char *Sailfish::MinUi::Keymap::name() const
+
+    Returns the name of the keymap.
+*/
+
+/*!
+    \fn char Sailfish::MinUi::Keymap::character(int code, int modifiers) const
+
+    Returns the character produced by the key with the linux input key \a code when the given
+    \a modifiers are active, or a null character if the key doesn't produce a character.
+*/
+
+}}
@@ -0,0 +1,97 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_KEYMAP_H
+#define SAILFISH_MINUI_KEYMAP_H
+
+namespace Sailfish { namespace MinUi {
+
+class Keymap
+{
+public:
+    enum Layout {
+        UnitedStates,
+        UnitedKingdom,
+        German,
+        Finnish,
+        LayoutCount
+    };
+
+    enum Modifier {
+        NoModifiers = 0x00,
+        Shift       = 0x01,
+        CapsLock    = 0x02,
+        AltGr       = 0x04
+    };
+
+    enum {
+        KeyCount = 128,
+        ModifierCombinations = 8
+    };
+
+    struct Table
+    {
+        struct Row
+        {
+            char characters[KeyCount];
+        };
+
+        Row rows[ModifierCombinations];
+    };
+
+    constexpr Keymap(const char *name, const Table &table) : m_name(name), m_table(table) {}
+
+    static const Keymap &layout(Layout layout);
+    static const Keymap *find(const char *name);
+    static const Keymap &system();
+
+    const char *name() const { return m_name; }
+
+    constexpr char character(int code, int modifiers = NoModifiers) const
+    {
+        return code >= 0 && code < KeyCount
+                ? m_table.rows[modifiers & (ModifierCombinations - 1)].characters[code]
+                : '\0';
+    }
+
+private:
+    const char *m_name;
+    Table m_table;
+};
+
+}}
+
+#endif
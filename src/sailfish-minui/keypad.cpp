@@ -35,6 +35,7 @@
 ****************************************************************************************/
 
 #include "keypad.h"
+#include "surface.h"
 
 namespace Sailfish { namespace MinUi {
 
@@ -104,6 +105,29 @@ void KeypadButton::activate()
     }
 }
 
+/*!
+    Shows or hides the item children of a button which are replaced by a keypad's cache when
+    it is not \a decorated.
+*/
+void KeypadButton::setDecorated(bool decorated)
+{
+    for (Item &item : childItems()) {
+        item.setVisible(decorated);
+    }
+}
+
+/*!
+    Renders the decorations of a button at \a x, \a y in the alpha \a mask a cached keypad is
+    drawn from.
+*/
+void KeypadButton::render(GRSurface *mask, int x, int y)
+{
+    renderDecoration(mask, x, y);
+    if (m_label) {
+        m_label->composite(mask, x + m_label->x(), y + m_label->y(), m_label->opacity());
+    }
+}
+
 /*!
     \class Sailfish::MinUi::KeypadButtonTemplate
     \brief A keypad button with an icon or label decoration.
@@ -140,12 +164,26 @@ void KeypadButtonTemplate<Decoration>::layout()
     m_decoration.centerIn(*this);
 }
 
+/*!
+    Renders the button decoration at \a x, \a y in the alpha \a mask a cached keypad is drawn
+    from.
+*/
+template <typename Decoration>
+void KeypadButtonTemplate<Decoration>::renderDecoration(GRSurface *mask, int x, int y)
+{
+    m_decoration.composite(mask, x + m_decoration.x(), y + m_decoration.y());
+}
+
 template class KeypadButtonTemplate<Icon>;
 template class KeypadButtonTemplate<Label>;
 
 /*!
     \class Sailfish::MinUi::Keypad
     \brief A numeric input keypad.
+
+    With \l setCachedRendering() enabled the button decorations are rendered once into an alpha
+    mask which is drawn in a single operation when all buttons are the same color, only the
+    buttons with a different color are drawn separately.
 */
 
 /*!
@@ -192,6 +230,8 @@ Keypad::Keypad(const char *acceptText, const char *cancelText, Item *parent)
 */
 Keypad::~Keypad()
 {
+    clearCache();
+
     delete m_cancelButton;
     m_cancelButton = nullptr;
 
@@ -238,6 +278,7 @@ bool Keypad::isAcceptVisible() const
 void Keypad::setAcceptVisible(bool visible)
 {
     acceptButton()->setVisible(visible);
+    clearCache();
 }
 
 bool Keypad::isCancelEnabled() const
@@ -258,6 +299,7 @@ bool Keypad::isCancelVisible() const
 void Keypad::setCancelVisible(bool visible)
 {
     cancelButton()->setVisible(visible);
+    clearCache();
 }
 
 /*!
@@ -312,6 +354,125 @@ void Keypad::updateButtonState(KeypadButton *button, bool enabled) const
     }
 }
 
+std::array<KeypadButton *, Keypad::ButtonCount> Keypad::buttons()
+{
+    return {{
+        &m_button1,
+        &m_button2,
+        &m_button3,
+        &m_button4,
+        &m_button5,
+        &m_button6,
+        &m_button7,
+        &m_button8,
+        &m_button9,
+        cancelButton(),
+        &m_button0,
+        acceptButton()
+    }};
+}
+
+/*!
+    \fn bool Sailfish::MinUi::Keypad::cachedRendering() const
+
+    Returns true if the keypad button decorations are drawn from a cached image.
+*/
+
+/*!
+    Sets whether the keypad button decorations are drawn from a \a cached image.
+*/
+void Keypad::setCachedRendering(bool cached)
+{
+    if (m_cachedRendering != cached) {
+        m_cachedRendering = cached;
+        clearCache();
+
+        for (KeypadButton *button : buttons()) {
+            button->setDecorated(!cached);
+        }
+        invalidate(Draw);
+    }
+}
+
+static bool operator ==(Color left, Color right)
+{
+    return left.r == right.r && left.g == right.g && left.b == right.b && left.a == right.a;
+}
+
+/*!
+    Draws the cached button decorations at \a x, \a y with the given accumulative \a opacity.
+*/
+void Keypad::draw(int x, int y, double opacity)
+{
+    if (!m_cachedRendering) {
+        return;
+    }
+
+    const std::array<KeypadButton *, ButtonCount> buttons = this->buttons();
+    const int originX = m_buttonContainer.x();
+    const int originY = m_buttonContainer.y();
+
+    if (!m_cache) {
+        m_cache = createAlphaSurface(width(), height());
+        if (!m_cache) {
+            return;
+        }
+        MaskRasterizer rasterizer(m_cache);
+        for (KeypadButton *button : buttons) {
+            if (button->isVisible()) {
+                button->render(m_cache, originX + button->x(), originY + button->y());
+            }
+        }
+        rasterizer.rasterize();
+    }
+
+    // The digits share a color except when one is pressed or has focus, so one digit or the
+    // other is the majority color.
+    const Color color = m_button1.color() == m_button2.color() ? m_button1.color() : m_button3.color();
+
+    int highlightCount = 0;
+    KeypadButton *highlight = nullptr;
+    for (KeypadButton *button : buttons) {
+        if (button->isVisible() && !(button->color() == color)) {
+            highlight = button;
+            ++highlightCount;
+        }
+    }
+
+    if (highlightCount == 0) {
+        drawAlphaSurface(x, y, m_cache, color, opacity);
+    } else if (highlightCount == 1) {
+        drawAlphaSurface(
+                    x, y, m_cache, color,
+                    originX + highlight->x(), originY + highlight->y(),
+                    highlight->width(), highlight->height(), highlight->color(),
+                    opacity);
+    } else {
+        for (KeypadButton *button : buttons) {
+            if (button->isVisible()) {
+                const GRSurface region = subSurface(
+                            m_cache,
+                            originX + button->x(),
+                            originY + button->y(),
+                            button->width(),
+                            button->height());
+                drawAlphaSurface(
+                            x + originX + button->x(),
+                            y + originY + button->y(),
+                            &region,
+                            button->color(),
+                            opacity);
+            }
+        }
+    }
+}
+
+void Keypad::clearCache()
+{
+    freeSurface(m_cache);
+    m_cache = nullptr;
+}
+
 KeypadButton *Keypad::cancelButton() const
 {
     if (m_cancelButton) {
@@ -370,6 +531,13 @@ void Keypad::layout()
 
     acceptButton()->align(Left, m_button3, Left);
     acceptButton()->align(Top, *cancelButton(), Top);
+
+    // The decorations are positioned before the cache is rendered from them.
+    for (KeypadButton *button : buttons()) {
+        button->layout();
+    }
+
+    clearCache();
 }
 
 void Keypad::setAcceptText(const char *acceptText)
@@ -385,6 +553,7 @@ void Keypad::setAcceptText(const char *acceptText)
     } else {
         m_acceptIconButton = new KeypadButtonTemplate<Icon>("icon-m-accept", KEY_ENTER, '\0', this);
     }
+    acceptButton()->setDecorated(!m_cachedRendering);
 
     layout();
 }
@@ -402,6 +571,7 @@ void Keypad::setCancelText(const char *cancelText)
     } else {
         m_cancelIconButton = new KeypadButtonTemplate<Icon>("icon-m-cancel", KEY_ESC, '\0', this);
     }
+    cancelButton()->setDecorated(!m_cachedRendering);
 
     layout();
 }
@@ -41,6 +41,8 @@
 #include <sailfish-minui/label.h>
 #include <linux/input.h>
 
+#include <array>
+
 namespace Sailfish { namespace MinUi {
 
 class Keypad;
@@ -50,12 +52,19 @@ public:
     KeypadButton(int code, char character, Keypad *parent, const char *label = NULL);
     ~KeypadButton();
 
+    virtual Color color() const = 0;
     virtual void setColor(Color color) = 0;
 
 protected:
+    friend class Keypad;
+
     void updateState(bool enabled);
     void activate() override;
 
+    void setDecorated(bool decorated);
+    void render(GRSurface *mask, int x, int y);
+    virtual void renderDecoration(GRSurface *mask, int x, int y) = 0;
+
 private:
     Keypad *m_keypad;
     int m_code;
@@ -70,11 +79,12 @@ public:
     KeypadButtonTemplate(const char *name, int code, char character, Keypad *parent, const char *label = NULL);
     ~KeypadButtonTemplate();
 
-    Color color() const { return m_decoration.color(); }
+    Color color() const override { return m_decoration.color(); }
     void setColor(Color color) override { m_decoration.setColor(color); }
 
 protected:
     void layout();
+    void renderDecoration(GRSurface *mask, int x, int y) override;
 
 private:
     Decoration m_decoration;
@@ -109,16 +119,24 @@ public:
     /* Set new cancel text, use null to use the default icon */
     void setCancelText(const char *acceptText);
 
+    bool cachedRendering() const { return m_cachedRendering; }
+    void setCachedRendering(bool cached);
+
 protected:
+    void draw(int x, int y, double opacity) override;
     void updateState(bool enabled) override;
     void layout() override;
 
 private:
     friend class KeypadButton;
 
+    enum { ButtonCount = 12 };
+
     inline void updateButtonState(KeypadButton *button, bool interactive) const;
     KeypadButton *cancelButton() const;
     KeypadButton *acceptButton() const;
+    inline std::array<KeypadButton *, ButtonCount> buttons();
+    inline void clearCache();
 
     ResizeableItem m_buttonContainer { this };
     KeypadButtonTemplate<Icon> m_button1 { "sailfish-minui-bt-key1", 2 /*KEY_1*/, '1', this };
@@ -147,6 +165,8 @@ private:
 
     Palette m_palette;
     std::function<void(int code, char character)> m_keyPress;
+    gr_surface m_cache = nullptr;
+    bool m_cachedRendering = false;
 };
 
 }}
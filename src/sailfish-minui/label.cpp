@@ -37,6 +37,7 @@
 #include "label.h"
 
 #include "logging.h"
+#include "surface.h"
 
 namespace Sailfish { namespace MinUi {
 
@@ -54,12 +55,20 @@ Label::Label(const char *name, Item *parent)
     : Item(parent)
 {
     if (name) {
-        const int result = res_create_localized_alpha_surface(name, locale(), &m_text);
+        gr_surface surface = nullptr;
+        const int result = res_create_localized_alpha_surface(name, locale(), &surface);
         if (result != 0) {
             log_err("Failed to load label " << name << " " << result);
         }
 
-        resize(gr_get_width(m_text), gr_get_height(m_text));
+        resize(gr_get_width(surface), gr_get_height(surface));
+
+        m_mask = encodeAlphaMask(surface);
+        if (m_mask) {
+            freeSurface(surface);
+        } else {
+            m_text = surface;
+        }
     }
 }
 
@@ -68,7 +77,20 @@ Label::Label(const char *name, Item *parent)
 */
 Label::~Label()
 {
-    res_free_surface(m_text);
+    freeAlphaMask(m_mask);
+    freeSurface(m_text);
+}
+
+/*!
+    Composites a label into the alpha surface \a target at \a x, \a y with the given \a opacity.
+*/
+void Label::composite(GRSurface *target, int x, int y, double opacity) const
+{
+    if (m_mask) {
+        compositeAlpha(target, x, y, m_mask, opacity);
+    } else {
+        compositeAlpha(target, x, y, m_text, opacity);
+    }
 }
 
 /*!
@@ -91,12 +113,15 @@ void Label::setColor(Color color)
 */
 void Label::draw(int x, int y, double opacity)
 {
-    if (m_text) {
-        const uint8_t alpha = m_color.a * opacity;
-        if (alpha != 0) {
-            gr_color(m_color.r, m_color.g, m_color.b, alpha);
-            gr_texticon(x, y, m_text);
-        }
+    const uint8_t alpha = m_color.a * opacity;
+    if (alpha == 0) {
+        return;
+    } else if (m_mask) {
+        setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+        drawAlphaMask(x, y, m_mask);
+    } else if (m_text) {
+        setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+        drawTextIcon(x, y, m_text);
     }
 }
 
@@ -132,7 +157,7 @@ void LiteralLabel::draw(int x, int y, double opacity)
     if (alpha == 0)
         return;
 
-    gr_color(m_color.r, m_color.g, m_color.b, (m_color.a * opacity));
+    setDrawColor(m_color.r, m_color.g, m_color.b, (m_color.a * opacity));
 
     // output the text tighter. width need what happens to look good for some known usage
     float charDistance = m_fontWidth * 0.75;
@@ -142,7 +167,7 @@ void LiteralLabel::draw(int x, int y, double opacity)
     char input[2] = "\0";
     for (char c : m_text) {
         input[0] = c;
-        gr_text(start_x, y - (m_fontHeight/2), input, 0);
+        drawText(start_x, y - (m_fontHeight/2), input, 0);
         start_x += charDistance;
     }
 }
@@ -40,13 +40,17 @@
 
 namespace Sailfish { namespace MinUi {
 
+struct AlphaMask;
+
 class Label : public Item
 {
 public:
     explicit Label(const char *name, Item *parent = nullptr);
     ~Label();
 
-    bool isValid() const { return m_text; }
+    bool isValid() const { return m_mask || m_text; }
+
+    void composite(GRSurface *target, int x, int y, double opacity = 1.) const;
 
     Color color() const { return m_color; }
     void setColor(Color color);
@@ -55,6 +59,7 @@ protected:
     void draw(int x, int y, double opacity) override;
 
 private:
+    AlphaMask *m_mask = nullptr;
     gr_surface m_text = nullptr;
     Color m_color;
 };
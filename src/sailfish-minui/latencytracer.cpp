@@ -0,0 +1,215 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "latencytracer.h"
+#include "logging.h"
+
+#include <algorithm>
+
+#include <time.h>
+
+namespace Sailfish { namespace MinUi {
+
+static int64_t clockTime(clockid_t clock)
+{
+    timespec time;
+    clock_gettime(clock, &time);
+
+    return (time.tv_sec * INT64_C(1000000)) + (time.tv_nsec / 1000);
+}
+
+/*!
+    \class Sailfish::MinUi::LatencyTracer
+    \brief Measures the time from input events to the display of the frames they affect.
+
+    A tracer installed on a window with \l Window::setLatencyTracer() follows each touch
+    press, move and lift and each key event from the kernel timestamp of its input_event,
+    through any item invalidations handling it causes, to the flip of the first frame drawn
+    afterwards.  Events which don't cause an invalidation aren't measured.
+
+    Input timestamps may come from either the realtime or monotonic clock depending on the
+    device so they're mapped to the monotonic clock by whichever gives a plausible age.  If
+    neither does, as with replayed recordings, the time the event was handled is used instead
+    and only the handling and drawing latency is measured.
+*/
+
+/*!
+    Constructs a latency tracer.
+*/
+LatencyTracer::LatencyTracer()
+{
+    for (std::vector<int64_t> &samples : m_samples) {
+        samples.reserve(MaximumSamples);
+    }
+}
+
+/*!
+    Returns the number of latency samples and their 50th, 95th and 99th percentiles and
+    maximum in microseconds for an event \a type.
+*/
+LatencyTracer::Statistics LatencyTracer::statistics(EventType type) const
+{
+    Statistics statistics;
+
+    std::vector<int64_t> samples = m_samples[type];
+    if (!samples.empty()) {
+        std::sort(samples.begin(), samples.end());
+
+        const size_t last = samples.size() - 1;
+        statistics.count = samples.size();
+        statistics.p50 = samples[last * 50 / 100];
+        statistics.p95 = samples[last * 95 / 100];
+        statistics.p99 = samples[last * 99 / 100];
+        statistics.maximum = samples[last];
+    }
+
+    return statistics;
+}
+
+/*!
+    \fn const std::vector<int64_t> &Sailfish::MinUi::LatencyTracer::samples(EventType type) const
+
+    Returns the most recent latency samples in microseconds for an event \a type.
+*/
+
+/*!
+    Clears all samples.
+*/
+void LatencyTracer::clear()
+{
+    for (std::vector<int64_t> &samples : m_samples) {
+        samples.clear();
+    }
+    m_pending.clear();
+}
+
+/*!
+    Logs the latency distribution for each event type.
+*/
+void LatencyTracer::logStatistics() const
+{
+    for (int type = 0; type < EventTypeCount; ++type) {
+        const Statistics statistics = this->statistics(EventType(type));
+        if (statistics.count > 0) {
+            log_warning("LatencyTracer: " << typeName(EventType(type))
+                    << " count " << statistics.count
+                    << " p50 " << (statistics.p50 / 1000.) << " ms"
+                    << " p95 " << (statistics.p95 / 1000.) << " ms"
+                    << " p99 " << (statistics.p99 / 1000.) << " ms"
+                    << " max " << (statistics.maximum / 1000.) << " ms");
+        }
+    }
+}
+
+/*!
+    Returns a printable name for an event \a type.
+*/
+const char *LatencyTracer::typeName(EventType type)
+{
+    switch (type) {
+    case Press: return "press";
+    case Move: return "move";
+    case Lift: return "lift";
+    case Key: return "key";
+    default: return "unknown";
+    }
+}
+
+/*!
+    Marks the start of the handling of an input event of a \a type with the kernel timestamp
+    \a time in microseconds.
+*/
+void LatencyTracer::beginInput(EventType type, int64_t time)
+{
+    const int64_t monotonic = clockTime(CLOCK_MONOTONIC);
+    const int64_t monotonicAge = monotonic - time;
+    const int64_t realtimeAge = clockTime(CLOCK_REALTIME) - time;
+
+    const int64_t plausibleAge = INT64_C(10000000);
+
+    m_inputType = type;
+    if (monotonicAge >= 0 && monotonicAge < plausibleAge) {
+        m_inputTime = time;
+    } else if (realtimeAge >= 0 && realtimeAge < plausibleAge) {
+        m_inputTime = monotonic - realtimeAge;
+    } else {
+        m_inputTime = monotonic;
+    }
+    m_active = true;
+    m_invalidated = false;
+}
+
+/*!
+    Marks the end of the handling of an input event.
+*/
+void LatencyTracer::endInput()
+{
+    m_active = false;
+}
+
+/*!
+    Notes that an item was invalidated.  If this happens while an input event is being handled
+    the next flip will complete the measurement of that event.
+*/
+void LatencyTracer::invalidated()
+{
+    if (m_active && !m_invalidated) {
+        m_invalidated = true;
+        m_pending.push_back({ m_inputType, m_inputTime });
+    }
+}
+
+/*!
+    Notes that a frame was flipped to the display.
+*/
+void LatencyTracer::flipped()
+{
+    if (m_pending.empty()) {
+        return;
+    }
+
+    const int64_t now = clockTime(CLOCK_MONOTONIC);
+    for (const Pending &pending : m_pending) {
+        std::vector<int64_t> &samples = m_samples[pending.type];
+        if (samples.size() >= MaximumSamples) {
+            samples.erase(samples.begin(), samples.begin() + MaximumSamples / 2);
+        }
+        samples.push_back(now - pending.time);
+    }
+    m_pending.clear();
+}
+
+}}
@@ -0,0 +1,125 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_LATENCYTRACER_H
+#define SAILFISH_MINUI_LATENCYTRACER_H
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace Sailfish { namespace MinUi {
+
+class LatencyTracer
+{
+public:
+    enum EventType {
+        Press,
+        Move,
+        Lift,
+        Key,
+        EventTypeCount
+    };
+
+    struct Statistics
+    {
+        int count = 0;
+        int64_t p50 = 0;
+        int64_t p95 = 0;
+        int64_t p99 = 0;
+        int64_t maximum = 0;
+    };
+
+    class Scope
+    {
+    public:
+        Scope(LatencyTracer *tracer, EventType type, int64_t time)
+            : m_tracer(tracer)
+        {
+            if (m_tracer) {
+                m_tracer->beginInput(type, time);
+            }
+        }
+
+        ~Scope()
+        {
+            if (m_tracer) {
+                m_tracer->endInput();
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator =(const Scope &) = delete;
+
+    private:
+        LatencyTracer * const m_tracer;
+    };
+
+    LatencyTracer();
+
+    Statistics statistics(EventType type) const;
+    const std::vector<int64_t> &samples(EventType type) const { return m_samples[type]; }
+    void clear();
+
+    void logStatistics() const;
+
+    static const char *typeName(EventType type);
+
+    void beginInput(EventType type, int64_t time);
+    void endInput();
+    void invalidated();
+    void flipped();
+
+private:
+    enum { MaximumSamples = 4096 };
+
+    struct Pending
+    {
+        EventType type;
+        int64_t time;
+    };
+
+    std::vector<Pending> m_pending;
+    std::vector<int64_t> m_samples[EventTypeCount];
+    int64_t m_inputTime = 0;
+    EventType m_inputType = Press;
+    bool m_active = false;
+    bool m_invalidated = false;
+};
+
+}}
+
+#endif
@@ -0,0 +1,347 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "listview.h"
+
+#include <algorithm>
+
+namespace Sailfish { namespace MinUi {
+
+/*!
+    \class Sailfish::MinUi::ListModel
+    \brief An interface providing the delegate items of a list view.
+
+    A model has a \l count() of entries, and creates the delegate items which display them.  A
+    delegate may be used to display any entry and is updated with updateDelegate() each time
+    it is assigned to a new one.
+*/
+
+/*!
+    \fn int Sailfish::MinUi::ListModel::count() const
+
+    Returns the number of entries in the model.
+*/
+
+/*!
+    \fn Sailfish::MinUi::ResizeableItem *Sailfish::MinUi::ListModel::createDelegate(ListView *view)
+
+    Creates a new delegate item for a list \a view.
+
+    The view takes ownership of the delegate.
+*/
+
+/*!
+    \fn void Sailfish::MinUi::ListModel::updateDelegate(ResizeableItem *delegate, int index)
+
+    Updates a \a delegate to display the entry at \a index.
+*/
+
+/*!
+    \class Sailfish::MinUi::ListView
+    \brief A vertical list of items provided by a model.
+
+    A list view only has delegate items for the entries which intersect the view, and a few
+    \l overscan() entries either side of those.  Delegates which are scrolled out of that range
+    are kept in a pool and assigned to the entries scrolled into it, so the number of items
+    and the cost of drawing them depends on the height of the view rather than the number
+    of entries.
+
+    All entries have the same height so the entries in view can be found without visiting
+    the others.
+
+    The list is a vertical \l Flickable, the delegates are placed in its content item.
+*/
+
+/*!
+    Constructs a list view.
+
+    If a \a parent argument is supplied the new item will be appended as a child of that item.
+*/
+ListView::ListView(Item *parent)
+    : Flickable(parent)
+    , m_itemHeight(theme.itemSizeMedium)
+{
+}
+
+/*!
+    Destroys a list view and its delegates.
+*/
+ListView::~ListView()
+{
+    deleteDelegates();
+}
+
+/*!
+    \fn Sailfish::MinUi::ListModel *Sailfish::MinUi::ListView::model() const
+
+    Returns the model which provides the list's items.
+*/
+
+/*!
+    Sets the \a model which provides the list's items.
+
+    The model is not owned by the list, all delegates created by a previous model are
+    destroyed.
+*/
+void ListView::setModel(ListModel *model)
+{
+    if (m_model != model) {
+        deleteDelegates();
+
+        m_model = model;
+
+        reset();
+    }
+}
+
+/*!
+    Updates the list after the count or entries of the model have changed.
+*/
+void ListView::reset()
+{
+    m_count = m_model ? std::max(0, m_model->count()) : 0;
+
+    // Every entry may have changed, so release all the delegates to be assigned again.
+    for (ResizeableItem * const delegate : m_delegates) {
+        if (delegate) {
+            delegate->setVisible(false);
+            m_pool.push_back(delegate);
+        }
+    }
+    m_delegates.clear();
+
+    // This bounds the scroll position to the new count.
+    setContentHeight(m_count * m_itemHeight);
+
+    updateDelegates();
+}
+
+/*!
+    Updates the delegate of the entry at \a index after that entry has changed in the model.
+*/
+void ListView::updateIndex(int index)
+{
+    if (ResizeableItem * const delegate = ListView::delegate(index)) {
+        m_model->updateDelegate(delegate, index);
+    }
+}
+
+/*!
+    \fn int Sailfish::MinUi::ListView::count() const
+
+    Returns the number of entries in the list.
+*/
+
+/*!
+    \fn int Sailfish::MinUi::ListView::itemHeight() const
+
+    Returns the height of every entry.  The default is the theme's medium item size.
+*/
+
+/*!
+    Sets the \a height of every entry.
+*/
+void ListView::setItemHeight(int height)
+{
+    if (m_itemHeight != height) {
+        m_itemHeight = height;
+
+        setContentHeight(m_count * m_itemHeight);
+        updateDelegates();
+    }
+}
+
+/*!
+    \fn int Sailfish::MinUi::ListView::overscan() const
+
+    Returns the number of entries above and below those in view which have delegates.  The
+    default is 2.
+*/
+
+/*!
+    Sets the \a count of entries above and below those in view which have delegates.
+
+    Delegates for entries just out of view are ready to be shown when the list is scrolled
+    without creating or updating them.
+*/
+void ListView::setOverscan(int count)
+{
+    if (m_overscan != count) {
+        m_overscan = std::max(0, count);
+
+        updateDelegates();
+    }
+}
+
+/*!
+    Scrolls the list by the least amount which brings the entry at \a index fully into view.
+*/
+void ListView::positionViewAtIndex(int index)
+{
+    if (index < 0 || index >= m_count) {
+        return;
+    } else if (index * m_itemHeight < contentY()) {
+        setContentY(index * m_itemHeight);
+    } else if ((index + 1) * m_itemHeight > contentY() + height()) {
+        setContentY(((index + 1) * m_itemHeight) - height());
+    }
+}
+
+/*!
+    Returns the index of the entry at the position \a y relative to the view, or -1 if there
+    is no entry there.
+*/
+int ListView::indexAt(int y) const
+{
+    if (m_itemHeight <= 0 || y < 0 || y >= height()) {
+        return -1;
+    }
+
+    const int index = (y + contentY()) / m_itemHeight;
+    return index < m_count ? index : -1;
+}
+
+/*!
+    Returns the delegate displaying the entry at \a index, or null if the entry is too far out
+    of view to have a delegate.
+*/
+ResizeableItem *ListView::delegate(int index) const
+{
+    return index >= m_firstIndex && index < m_firstIndex + int(m_delegates.size())
+            ? m_delegates[index - m_firstIndex]
+            : nullptr;
+}
+
+/*!
+    \fn int Sailfish::MinUi::ListView::delegateCount() const
+
+    Returns the number of delegates the list has created.
+*/
+
+/*!
+    Positions the delegates for the size of the view.
+*/
+void ListView::layout()
+{
+    Flickable::layout();
+
+    updateDelegates();
+}
+
+/*!
+    Assigns delegates to the entries scrolled into view.
+*/
+void ListView::contentMoved()
+{
+    updateDelegates();
+}
+
+/*
+    Assigns delegates to the entries in and near the view and positions them, releasing the
+    delegates of any entries which are no longer near.
+*/
+void ListView::updateDelegates()
+{
+    int firstVisible = 0;
+    int endVisible = 0;
+    int begin = 0;
+    int end = 0;
+    if (m_model && m_itemHeight > 0 && m_count > 0) {
+        const int contentY = Flickable::contentY();
+        firstVisible = std::min(contentY / m_itemHeight, m_count);
+        endVisible = std::min((contentY + std::max(0, height()) + m_itemHeight - 1) / m_itemHeight, m_count);
+        begin = std::max(0, firstVisible - m_overscan);
+        end = std::min(m_count, endVisible + m_overscan);
+    }
+
+    // Both lists keep their capacity so scrolling doesn't allocate once the pool is full.
+    m_previousDelegates.swap(m_delegates);
+    m_delegates.assign(end - begin, nullptr);
+
+    for (size_t i = 0; i < m_previousDelegates.size(); ++i) {
+        ResizeableItem * const delegate = m_previousDelegates[i];
+        const int index = m_firstIndex + int(i);
+        if (!delegate) {
+            continue;
+        } else if (index >= begin && index < end) {
+            m_delegates[index - begin] = delegate;
+        } else {
+            delegate->setVisible(false);
+            m_pool.push_back(delegate);
+        }
+    }
+    m_previousDelegates.clear();
+    m_firstIndex = begin;
+
+    for (int index = begin; index < end; ++index) {
+        ResizeableItem *&delegate = m_delegates[index - begin];
+        if (!delegate) {
+            if (!m_pool.empty()) {
+                delegate = m_pool.back();
+                m_pool.pop_back();
+            } else if ((delegate = m_model->createDelegate(this))) {
+                if (delegate->parent() != contentItem()) {
+                    contentItem()->appendChild(delegate);
+                }
+            } else {
+                continue;
+            }
+            m_model->updateDelegate(delegate, index);
+        }
+
+        delegate->resize(width(), m_itemHeight);
+        delegate->move(0, index * m_itemHeight);
+        // The overscan delegates are only prepared for scrolling, not drawn.
+        delegate->setVisible(index >= firstVisible && index < endVisible);
+    }
+
+    invalidate(Draw);
+}
+
+void ListView::deleteDelegates()
+{
+    for (ResizeableItem * const delegate : m_delegates) {
+        delete delegate;
+    }
+    for (ResizeableItem * const delegate : m_pool) {
+        delete delegate;
+    }
+    m_delegates.clear();
+    m_pool.clear();
+    m_firstIndex = 0;
+}
+
+}}
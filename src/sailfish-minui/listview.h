@@ -0,0 +1,103 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_LISTVIEW_H
+#define SAILFISH_MINUI_LISTVIEW_H
+
+#include <sailfish-minui/flickable.h>
+
+#include <vector>
+
+namespace Sailfish { namespace MinUi {
+
+class ListView;
+
+class ListModel
+{
+public:
+    virtual ~ListModel() {}
+
+    virtual int count() const = 0;
+    virtual ResizeableItem *createDelegate(ListView *view) = 0;
+    virtual void updateDelegate(ResizeableItem *delegate, int index) = 0;
+};
+
+class ListView : public Flickable
+{
+public:
+    explicit ListView(Item *parent = nullptr);
+    ~ListView();
+
+    ListModel *model() const { return m_model; }
+    void setModel(ListModel *model);
+    void reset();
+    void updateIndex(int index);
+
+    int count() const { return m_count; }
+
+    int itemHeight() const { return m_itemHeight; }
+    void setItemHeight(int height);
+
+    int overscan() const { return m_overscan; }
+    void setOverscan(int count);
+
+    void positionViewAtIndex(int index);
+    int indexAt(int y) const;
+
+    ResizeableItem *delegate(int index) const;
+    int delegateCount() const { return m_delegates.size() + m_pool.size(); }
+
+protected:
+    void layout() override;
+    void contentMoved() override;
+
+private:
+    inline void updateDelegates();
+    inline void deleteDelegates();
+
+    ListModel *m_model = nullptr;
+    std::vector<ResizeableItem *> m_delegates;
+    std::vector<ResizeableItem *> m_previousDelegates;
+    std::vector<ResizeableItem *> m_pool;
+    int m_firstIndex = 0;
+    int m_count = 0;
+    int m_itemHeight;
+    int m_overscan = 2;
+};
+
+}}
+
+#endif
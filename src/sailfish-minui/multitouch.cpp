@@ -35,6 +35,7 @@
 ****************************************************************************************/
 
 #include "multitouch.h"
+#include "inputdevice.h"
 #include "logging.h"
 
 #include <linux/input.h>
@@ -84,9 +85,9 @@ void MultiTouch::updateTouching(bool touching)
     if (m_touching != touching) {
         if ((m_touching = touching)) {
             m_prev = m_active;
-            m_fingerPressed(m_active.x, m_active.y, m_callbackData);
+            m_fingerPressed(m_active.x, m_active.y, m_time, m_callbackData);
         } else {
-            m_fingerLifted(m_active.x, m_active.y, m_callbackData);
+            m_fingerLifted(m_active.x, m_active.y, m_time, m_callbackData);
 
             /* Especially protocol A is likely to have recycled
              * id numbers to be seen -> forget tracking id once
@@ -98,13 +99,15 @@ void MultiTouch::updateTouching(bool touching)
         int v = m_prev.y - m_active.y;
         if (u*u + v*v >= DragThreshold*DragThreshold) {
             m_prev = m_active;
-            m_fingerMoved(m_active.x, m_active.y, m_callbackData);
+            m_fingerMoved(m_active.x, m_active.y, m_time, m_callbackData);
         }
     }
 }
 
-void MultiTouch::evaluateTouchingA()
+void MultiTouch::evaluateTouchingA(const input_event &event)
 {
+    m_time = event.time.tv_sec * INT64_C(1000000) + event.time.tv_usec;
+
     /* Assume: Tracked finger was lifted */
     bool touching = false;
 
@@ -142,8 +145,10 @@ void MultiTouch::evaluateTouchingA()
     updateTouching(touching);
 }
 
-void MultiTouch::evaluateTouchingB()
+void MultiTouch::evaluateTouchingB(const input_event &event)
 {
+    m_time = event.time.tv_sec * INT64_C(1000000) + event.time.tv_usec;
+
     /* Assume: Tracked finger was lifted */
     bool touching = false;
 
@@ -220,7 +225,7 @@ void MultiTouch::handleProtocolA(const input_event &event)
             m_state.clear();
             break;
         case SYN_REPORT:
-            evaluateTouchingA();
+            evaluateTouchingA(event);
             break;
         default:
             break;
@@ -260,7 +265,7 @@ void MultiTouch::handleProtocolB(const input_event &event)
     case EV_SYN:
         switch (event.code) {
         case SYN_REPORT:
-            evaluateTouchingB();
+            evaluateTouchingB(event);
             break;
         default:
             break;
@@ -286,12 +291,12 @@ bool MultiTouch::isMultiTouchDevice(int fd)
         /* Mark down: This fd got probed */
         m_fd = fd;
 
-        if (ioctl(fd, EVIOCGBIT(0, EV_CNT), memset(types, 0, sizeof types)) == -1) {
+        if (inputDeviceIoctl(fd, EVIOCGBIT(0, EV_CNT), memset(types, 0, sizeof types)) == -1) {
             /* No event type info -> is it even an input device? */
             log_warning("failed to probe event types: " << errnoString());
         } else if (!bitIsSet(types, EV_ABS)) {
             /* No EV_ABS events -> not a multitouch input device */
-        } else if (ioctl(fd, EVIOCGBIT(EV_ABS, ABS_CNT), memset(codes, 0, sizeof codes)) == -1) {
+        } else if (inputDeviceIoctl(fd, EVIOCGBIT(EV_ABS, ABS_CNT), memset(codes, 0, sizeof codes)) == -1) {
             /* No EV_ABS info -> further probing is useless */
             log_warning("failed to probe EV_ABS event codes: " << errnoString());
         } else if (!bitIsSet(codes, ABS_MT_POSITION_X)) {
@@ -323,7 +328,7 @@ bool MultiTouch::isMultiTouchDevice(int fd)
             memset(&info, 0, sizeof info);
             memset(&event, 0, sizeof event);
             for (int i = 0; lut[i] != -1; ++i) {
-                if (ioctl(fd, EVIOCGABS(lut[i]), &info) == 0) {
+                if (inputDeviceIoctl(fd, EVIOCGABS(lut[i]), &info) == 0) {
                     event.type  = EV_ABS;
                     event.code  = lut[i];
                     event.value = info.value;
@@ -336,15 +341,17 @@ bool MultiTouch::isMultiTouchDevice(int fd)
     return m_fd == fd && m_type != Type::None;
 }
 
-void MultiTouch::inputEvent(int fd, const input_event &event)
+void MultiTouch::inputFrame(int fd, const input_event *events, int count)
 {
     if (isMultiTouchDevice(fd)) {
         switch (m_type) {
         case Type::ProtocolA:
-            handleProtocolA(event);
+            for (int i = 0; i < count; ++i)
+                handleProtocolA(events[i]);
             break;
         case Type::ProtocolB:
-            handleProtocolB(event);
+            for (int i = 0; i < count; ++i)
+                handleProtocolB(events[i]);
             break;
         default:
             break;
@@ -37,6 +37,8 @@
 #ifndef SAILFISH_MINUI_MULTITOUCH_H
 #define SAILFISH_MINUI_MULTITOUCH_H
 
+#include <stdint.h>
+
 extern "C" struct input_event;
 
 namespace Sailfish { namespace MinUi {
@@ -44,13 +46,13 @@ namespace Sailfish { namespace MinUi {
 class MultiTouch
 {
 public:
-    typedef void (*EventCallback)(int x, int y, void *callbackData);
+    typedef void (*EventCallback)(int x, int y, int64_t time, void *callbackData);
 
     MultiTouch(EventCallback fingerPressed,
                EventCallback fingerMoved,
                EventCallback fingerLifted,
                void *callbackData);
-    void inputEvent(int fd, const input_event &event);
+    void inputFrame(int fd, const input_event *events, int count);
     int multitouchFd() const;
 
 private:
@@ -147,6 +149,9 @@ private:
     /** Tracking id of the 1st detected finger */
     int        m_touch_id = -1;
 
+    /** Timestamp of the last SYN_REPORT in microseconds */
+    int64_t    m_time = 0;
+
     /** Callback for finger pressed notifications */
     EventCallback m_fingerPressed;
 
@@ -160,8 +165,8 @@ private:
     void *m_callbackData;
 
     void updateTouching(bool touching);
-    void evaluateTouchingA();
-    void evaluateTouchingB();
+    void evaluateTouchingA(const input_event &event);
+    void evaluateTouchingB(const input_event &event);
     void handleProtocolA(const input_event &event);
     void handleProtocolB(const input_event &event);
     bool isMultiTouchDevice(int fd);
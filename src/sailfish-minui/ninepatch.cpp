@@ -0,0 +1,151 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "ninepatch.h"
+
+#include "logging.h"
+#include "surface.h"
+
+namespace Sailfish { namespace MinUi {
+
+/*!
+    \class Sailfish::MinUi::NinePatch
+    \brief A single color image which stretches to any size.
+
+    The center column and row of the image are repeated to fill the width and height of the item
+    and the corners and edges either side of them are drawn unscaled, so a single small image
+    can be the background of items of any size.
+*/
+
+/*!
+    Constructs a nine patch from a graphic resource identified by \a name.
+
+    The item initially has the size of the image.
+
+    If a \a parent argument is supplied the new item will be appended as a child of that item.
+*/
+NinePatch::NinePatch(const char *name, Item *parent)
+    : ResizeableItem(parent)
+{
+    gr_surface surface = nullptr;
+    const int result = res_create_alpha_surface(name, &surface);
+    if (result != 0) {
+        log_err("Failed to load nine patch " << name << " " << result);
+    }
+
+    m_implicitWidth = gr_get_width(surface);
+    m_implicitHeight = gr_get_height(surface);
+    m_source = encodeAlphaMask(surface);
+
+    freeSurface(surface);
+
+    resize(m_implicitWidth, m_implicitHeight);
+}
+
+/*!
+    Destroys a nine patch.
+*/
+NinePatch::~NinePatch()
+{
+    freeAlphaMask(m_source);
+    freeAlphaMask(m_mask);
+}
+
+/*!
+    \fn Sailfish::MinUi::NinePatch::implicitWidth() const
+
+    Returns the width of the image of a nine patch.
+*/
+
+/*!
+    \fn Sailfish::MinUi::NinePatch::implicitHeight() const
+
+    Returns the height of the image of a nine patch.
+*/
+
+/*!
+    Composites a nine patch stretched to its current size into the alpha surface \a target at
+    \a x, \a y with the given \a opacity.
+*/
+void NinePatch::composite(GRSurface *target, int x, int y, double opacity) const
+{
+    compositeAlpha(target, x, y, mask(), opacity);
+}
+
+/*!
+    \fn Sailfish::MinUi::NinePatch::color() const
+
+    Returns the color of a nine patch.
+*/
+
+/*!
+    Sets the \a color of a nine patch.
+*/
+void NinePatch::setColor(Color color)
+{
+    m_color = color;
+    invalidate(Draw);
+}
+
+/*!
+    Returns the image stretched to the current size, stretching it again if the size has changed.
+*/
+const AlphaMask *NinePatch::mask() const
+{
+    if (!m_source) {
+        return nullptr;
+    } else if (!m_mask || m_mask->width != width() || m_mask->height != height()) {
+        freeAlphaMask(m_mask);
+        m_mask = stretchAlphaMask(m_source, width(), height());
+    }
+    return m_mask;
+}
+
+/*!
+    Draws a nine patch at the absolute position x, y, with the given accumulative \a opacity.
+*/
+void NinePatch::draw(int x, int y, double opacity)
+{
+    const uint8_t alpha = m_color.a * opacity;
+    if (alpha != 0) {
+        if (const AlphaMask * const stretched = mask()) {
+            setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+            drawAlphaMask(x, y, stretched);
+        }
+    }
+}
+
+}}
@@ -0,0 +1,76 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_NINEPATCH_H
+#define SAILFISH_MINUI_NINEPATCH_H
+
+#include <sailfish-minui/item.h>
+
+namespace Sailfish { namespace MinUi {
+
+struct AlphaMask;
+
+class NinePatch : public ResizeableItem
+{
+public:
+    explicit NinePatch(const char *name, Item *parent = nullptr);
+    ~NinePatch();
+
+    bool isValid() const { return m_source; }
+
+    int implicitWidth() const { return m_implicitWidth; }
+    int implicitHeight() const { return m_implicitHeight; }
+
+    void composite(GRSurface *target, int x, int y, double opacity = 1.) const;
+
+    Color color() const { return m_color; }
+    void setColor(Color color);
+
+protected:
+    void draw(int x, int y, double opacity) override;
+
+private:
+    inline const AlphaMask *mask() const;
+
+    AlphaMask *m_source = nullptr;
+    mutable AlphaMask *m_mask = nullptr;
+    Color m_color;
+    int m_implicitWidth = 0;
+    int m_implicitHeight = 0;
+};
+}}
+
+#endif
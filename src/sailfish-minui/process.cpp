@@ -0,0 +1,423 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "process.h"
+#include "logging.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/syscall.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+namespace Sailfish { namespace MinUi {
+
+/*!
+    \class Sailfish::MinUi::Process
+    \brief Runs an external program without blocking the event loop.
+
+    The program is spawned with posix_spawn() in its own process group with standard input
+    connected to /dev/null.  Standard output and standard error are read through non-blocking
+    pipes watched by the event loop and delivered a line at a time to the \l onStandardOutput()
+    and \l onStandardError() callbacks.  Exit is detected through a pidfd notifier, or by
+    polling on kernels which don't support pidfds, and no threads are used.
+
+    A process which runs longer than the \l timeout() or is canceled is first sent SIGTERM, and
+    if it hasn't exited after the \l killTimeout() it is sent SIGKILL.
+*/
+
+/*!
+    \enum Sailfish::MinUi::Process::Result
+
+    \value Exited The process exited by itself, \l exitCode() holds its exit status.
+    \value Crashed The process was terminated by a signal it wasn't sent by us, \l exitSignal()
+    holds the signal number.
+    \value TimedOut The process was terminated because it exceeded the \l timeout().
+    \value Canceled The process was terminated by \l cancel().
+*/
+
+/*!
+    Constructs a new process which is watched by an \a eventLoop.
+*/
+Process::Process(EventLoop *eventLoop)
+    : m_eventLoop(eventLoop)
+{
+}
+
+/*!
+    Destroys a process.
+
+    If the process is still running it is killed and reaped, the finished callback is not
+    invoked.
+*/
+Process::~Process()
+{
+    if (m_pid > 0) {
+        signal(SIGKILL);
+        while (::waitpid(m_pid, nullptr, 0) < 0 && errno == EINTR) {
+        }
+        release();
+    }
+}
+
+/*!
+    Starts a program with the given \a arguments, the first of which is the program to run.
+    If the program name doesn't contain a slash it is searched for in PATH.
+
+    Returns false if the process could not be started in which case \l error() holds the error
+    number, or if it is already running.
+*/
+bool Process::start(const std::vector<std::string> &arguments)
+{
+    if (m_pid > 0) {
+        log_warning("Process: Cannot start " << (arguments.empty() ? "" : arguments.front()) << ", already running.");
+        return false;
+    } else if (arguments.empty()) {
+        m_error = EINVAL;
+        return false;
+    }
+
+    m_exitCode = 0;
+    m_exitSignal = 0;
+    m_error = 0;
+    m_result = Exited;
+
+    int pipes[ChannelCount][2];
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        // Only the parent's end is non-blocking, the program inherits an ordinary pipe.
+        if (::pipe2(pipes[channel], O_CLOEXEC) != 0) {
+            m_error = errno;
+            for (int i = 0; i < channel; ++i) {
+                ::close(pipes[i][0]);
+                ::close(pipes[i][1]);
+            }
+            return false;
+        }
+        ::fcntl(pipes[channel][0], F_SETFL, O_NONBLOCK);
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, pipes[StandardOutput][1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, pipes[StandardError][1], STDERR_FILENO);
+
+    sigset_t mask;
+    sigemptyset(&mask);
+
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGHUP);
+    sigaddset(&defaults, SIGINT);
+    sigaddset(&defaults, SIGQUIT);
+    sigaddset(&defaults, SIGPIPE);
+    sigaddset(&defaults, SIGTERM);
+
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(
+                &attributes, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+    posix_spawnattr_setpgroup(&attributes, 0);
+    posix_spawnattr_setsigmask(&attributes, &mask);
+    posix_spawnattr_setsigdefault(&attributes, &defaults);
+
+    std::vector<char *> argv;
+    argv.reserve(arguments.size() + 1);
+    for (const std::string &argument : arguments) {
+        argv.push_back(const_cast<char *>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+    const int result = ::posix_spawnp(&pid, argv.front(), &actions, &attributes, argv.data(), environ);
+
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        ::close(pipes[channel][1]);
+        if (result != 0) {
+            ::close(pipes[channel][0]);
+        }
+    }
+
+    if (result != 0) {
+        m_error = result;
+        return false;
+    }
+
+    m_pid = pid;
+
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        m_buffers[channel].clear();
+        m_fds[channel] = pipes[channel][0];
+        m_eventLoop->addNotifierCallback(m_fds[channel], [this, channel](int, uint32_t) {
+            readChannel(channel);
+            return true;
+        });
+    }
+
+#if defined(__NR_pidfd_open)
+    m_pidFd = ::syscall(__NR_pidfd_open, pid, 0);
+#endif
+    if (m_pidFd >= 0) {
+        ::fcntl(m_pidFd, F_SETFD, FD_CLOEXEC);
+        m_eventLoop->addNotifierCallback(m_pidFd, [this](int, uint32_t) {
+            checkExited();
+            return true;
+        });
+    } else {
+        m_pollTimer = m_eventLoop->createTimer(50, [this]() {
+            checkExited();
+        });
+    }
+
+    if (m_timeout > 0) {
+        m_timeoutTimer = m_eventLoop->createTimer(m_timeout, [this]() {
+            terminate(TimedOut);
+        });
+    }
+
+    return true;
+}
+
+/*!
+    Cancels a running process.
+
+    The process is sent SIGTERM and if it hasn't exited after the \l killTimeout() SIGKILL.
+    The finished callback is invoked with a Canceled result once it has exited.
+*/
+void Process::cancel()
+{
+    terminate(Canceled);
+}
+
+/*!
+    Sets the maximum time in milliseconds a process may run for before it is terminated to
+    \a timeout.  A timeout of 0 allows it to run indefinitely, which is the default.
+
+    The timeout applies to processes started after it is set.
+*/
+void Process::setTimeout(int timeout)
+{
+    m_timeout = timeout;
+}
+
+/*!
+    Sets the time in milliseconds a process is given to exit after being sent SIGTERM before
+    it is sent SIGKILL to \a timeout.  The default is 3 seconds.
+*/
+void Process::setKillTimeout(int timeout)
+{
+    m_killTimeout = timeout;
+}
+
+/*!
+    Sets a \a callback which is invoked with each line the process writes to its standard
+    output.  The line terminator is not included.
+
+    Lines longer than 64 KiB are split, and an unterminated final line is delivered when the
+    process exits.
+*/
+void Process::onStandardOutput(const std::function<void(const std::string &line)> &callback)
+{
+    m_output[StandardOutput] = callback;
+}
+
+/*!
+    Sets a \a callback which is invoked with each line the process writes to its standard
+    error.
+*/
+void Process::onStandardError(const std::function<void(const std::string &line)> &callback)
+{
+    m_output[StandardError] = callback;
+}
+
+/*!
+    Sets a \a callback which is invoked with the result when a process has exited.
+*/
+void Process::onFinished(const std::function<void(Result result)> &callback)
+{
+    m_finished = callback;
+}
+
+void Process::readChannel(int channel)
+{
+    char buffer[ReadSize];
+
+    // Bound the work per wake up so a chatty process can't starve the rest of the event loop,
+    // the notifier is level triggered and will fire again for anything left over.
+    for (int i = 0; i < 16 && m_fds[channel] >= 0; ++i) {
+        const ssize_t size = ::read(m_fds[channel], buffer, sizeof(buffer));
+        if (size > 0) {
+            m_buffers[channel].append(buffer, size);
+            emitLines(channel, false);
+        } else if (size == 0) {
+            emitLines(channel, true);
+            closeChannel(channel);
+        } else if (errno != EINTR) {
+            break;
+        }
+    }
+}
+
+void Process::closeChannel(int channel)
+{
+    if (m_fds[channel] >= 0) {
+        m_eventLoop->removeNotifier(m_fds[channel]);
+        ::close(m_fds[channel]);
+        m_fds[channel] = -1;
+    }
+}
+
+void Process::emitLines(int channel, bool flush)
+{
+    std::string &buffer = m_buffers[channel];
+
+    size_t start = 0;
+    for (size_t end; (end = buffer.find('\n', start)) != std::string::npos; start = end + 1) {
+        size_t length = end - start;
+        if (length > 0 && buffer[end - 1] == '\r') {
+            --length;
+        }
+        if (m_output[channel]) {
+            m_output[channel](buffer.substr(start, length));
+        }
+    }
+    buffer.erase(0, start);
+
+    if (!buffer.empty() && (flush || buffer.size() >= MaximumLineLength)) {
+        const std::string line = std::move(buffer);
+        buffer.clear();
+        if (m_output[channel]) {
+            m_output[channel](line);
+        }
+    }
+}
+
+void Process::terminate(Result result)
+{
+    if (m_pid <= 0 || m_result != Exited) {
+        return;
+    }
+
+    m_result = result;
+
+    m_eventLoop->cancelTimer(m_timeoutTimer);
+    m_timeoutTimer = 0;
+
+    signal(SIGTERM);
+
+    m_killTimer = m_eventLoop->createTimer(m_killTimeout, [this]() {
+        m_eventLoop->cancelTimer(m_killTimer);
+        m_killTimer = 0;
+
+        log_warning("Process: " << m_pid << " did not exit after SIGTERM, sending SIGKILL.");
+        signal(SIGKILL);
+    });
+}
+
+void Process::signal(int signal)
+{
+    // The process isn't reaped until it's seen to exit so its pid and process group can't be
+    // reused before then.  If the program moved itself to another group signal it directly.
+    if (::kill(-m_pid, signal) != 0) {
+        ::kill(m_pid, signal);
+    }
+}
+
+void Process::checkExited()
+{
+    int status = 0;
+    const pid_t pid = ::waitpid(m_pid, &status, WNOHANG);
+
+    if (pid == 0 || (pid < 0 && errno == EINTR)) {
+        return;
+    } else if (pid < 0) {
+        // The process was reaped elsewhere, most likely because SIGCHLD is ignored.
+        m_error = errno;
+        m_exitCode = -1;
+    } else if (WIFEXITED(status)) {
+        m_exitCode = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        m_exitSignal = WTERMSIG(status);
+        if (m_result == Exited) {
+            m_result = Crashed;
+        }
+    }
+
+    // Deliver whatever output is already buffered, descendants which still hold the pipes open
+    // aren't waited for.
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        readChannel(channel);
+        emitLines(channel, true);
+    }
+
+    m_pid = 0;
+    release();
+
+    if (m_finished) {
+        m_finished(m_result);
+    }
+}
+
+void Process::release()
+{
+    for (int channel = 0; channel < ChannelCount; ++channel) {
+        closeChannel(channel);
+    }
+
+    if (m_pidFd >= 0) {
+        m_eventLoop->removeNotifier(m_pidFd);
+        ::close(m_pidFd);
+        m_pidFd = -1;
+    }
+
+    for (int *timer : { &m_pollTimer, &m_timeoutTimer, &m_killTimer }) {
+        if (*timer) {
+            m_eventLoop->cancelTimer(*timer);
+            *timer = 0;
+        }
+    }
+}
+
+}}
@@ -0,0 +1,124 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_PROCESS_H
+#define SAILFISH_MINUI_PROCESS_H
+
+#include <sailfish-minui/eventloop.h>
+
+#include <string>
+
+#include <sys/types.h>
+
+namespace Sailfish { namespace MinUi {
+
+class Process
+{
+public:
+    enum Result {
+        Exited,
+        Crashed,
+        TimedOut,
+        Canceled
+    };
+
+    explicit Process(EventLoop *eventLoop = EventLoop::instance());
+    Process(const Process &) = delete;
+    ~Process();
+
+    Process &operator =(const Process &) = delete;
+
+    bool start(const std::vector<std::string> &arguments);
+    void cancel();
+
+    bool isRunning() const { return m_pid > 0; }
+    pid_t pid() const { return m_pid; }
+
+    int exitCode() const { return m_exitCode; }
+    int exitSignal() const { return m_exitSignal; }
+    int error() const { return m_error; }
+
+    int timeout() const { return m_timeout; }
+    void setTimeout(int timeout);
+
+    int killTimeout() const { return m_killTimeout; }
+    void setKillTimeout(int timeout);
+
+    void onStandardOutput(const std::function<void(const std::string &line)> &callback);
+    void onStandardError(const std::function<void(const std::string &line)> &callback);
+    void onFinished(const std::function<void(Result result)> &callback);
+
+private:
+    enum Channel {
+        StandardOutput,
+        StandardError,
+        ChannelCount
+    };
+
+    enum {
+        ReadSize = 4096,
+        MaximumLineLength = 64 * 1024
+    };
+
+    inline void readChannel(int channel);
+    inline void closeChannel(int channel);
+    inline void emitLines(int channel, bool flush);
+    inline void terminate(Result result);
+    inline void signal(int signal);
+    inline void checkExited();
+    inline void release();
+
+    std::function<void(const std::string &line)> m_output[ChannelCount];
+    std::function<void(Result result)> m_finished;
+    std::string m_buffers[ChannelCount];
+    EventLoop * const m_eventLoop;
+    pid_t m_pid = 0;
+    int m_fds[ChannelCount] = { -1, -1 };
+    int m_pidFd = -1;
+    int m_pollTimer = 0;
+    int m_timeoutTimer = 0;
+    int m_killTimer = 0;
+    int m_timeout = 0;
+    int m_killTimeout = 3000;
+    int m_exitCode = 0;
+    int m_exitSignal = 0;
+    int m_error = 0;
+    Result m_result = Exited;
+};
+
+}}
+
+#endif
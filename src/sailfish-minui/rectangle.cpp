@@ -35,6 +35,8 @@
 ****************************************************************************************/
 #include "rectangle.h"
 
+#include "surface.h"
+
 namespace Sailfish { namespace MinUi {
 
 /*!
@@ -81,8 +83,8 @@ void Rectangle::draw(int x, int y, double opacity)
 {
     const uint8_t alpha = m_color.a * opacity;
     if (alpha != 0) {
-        gr_color(m_color.r, m_color.g, m_color.b, alpha);
-        gr_fill(x, y, x + width(), y + height());
+        setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+        fillRect(x, y, x + width(), y + height());
     }
 }
 
@@ -0,0 +1,242 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "renderthread.h"
+#include "eventloop.h"
+#include "logging.h"
+
+#include <minui/minui.h>
+
+#include <sys/eventfd.h>
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace Sailfish { namespace MinUi {
+
+RenderThread *RenderThread::s_instance = nullptr;
+
+/*!
+    \class Sailfish::MinUi::RenderThread
+    \brief Rasterizes and flips frames on a thread of their own.
+
+    The event loop thread records each frame into snapshot() and submits it, and the render thread
+    draws the damage of the most recently submitted snapshot and flips while the event loop carries
+    on handling input.  A snapshot submitted while the previous one is still pending replaces it, so
+    a slow flip costs frames rather than input latency.
+
+    Surfaces released with freeSurface() while the thread is running are freed by the render thread
+    once no snapshot which may draw them remains.
+*/
+/*
+    Starts a render thread which posts to \a eventLoop to call \a flipped each time it flips a
+    frame.
+*/
+RenderThread::RenderThread(EventLoop *eventLoop, const std::function<void()> &flipped)
+    : m_eventLoop(eventLoop)
+    , m_flipped(flipped)
+    , m_flipFd(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (m_flipFd < 0) {
+        log_err("RenderThread: Failed to create flip descriptor. " << strerror(errno));
+    } else {
+        m_eventLoop->addNotifierCallback(m_flipFd, [this](int, uint32_t) {
+            uint64_t count = 0;
+            while (::read(m_flipFd, &count, sizeof(count)) < 0 && errno == EINTR) {
+            }
+            if (count > 0 && m_flipped) {
+                m_flipped();
+            }
+            return true;
+        });
+    }
+
+    s_instance = this;
+
+    m_thread = std::thread([this]() { run(); });
+}
+
+/*
+    Finishes drawing any submitted frame and stops the render thread.
+*/
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+
+    s_instance = nullptr;
+
+    for (const DeferredSurface &deferred : m_deferred) {
+        release(deferred);
+    }
+
+    if (m_flipFd >= 0) {
+        m_eventLoop->removeNotifier(m_flipFd);
+        ::close(m_flipFd);
+    }
+}
+
+/*
+    Hands the frame recorded into the snapshot over to the render thread to draw within
+    \a bounds and flip.  The \a frame number identifies the frame in the display list log.
+*/
+void RenderThread::submit(const ClipRect &bounds, int frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        // If the last snapshot hasn't been taken yet it's superseded by this one.
+        m_pending.swap(m_recording);
+        m_pendingBounds = bounds;
+        m_pendingFrame = frame;
+        m_hasPending = true;
+        ++m_submitted;
+    }
+    m_condition.notify_all();
+}
+
+/*
+    Blocks until every submitted frame has been flipped.
+*/
+void RenderThread::finish()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return !m_hasPending && !m_busy; });
+}
+
+/*
+    Causes the next frames to be drawn in full, for when the contents of the framebuffers are
+    unknown.
+*/
+void RenderThread::invalidateAll()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_invalidateAll = true;
+}
+
+/*
+    Frees a \a surface once the snapshots which may draw it have been drawn.
+*/
+void RenderThread::deferFree(gr_surface surface)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // The snapshot being recorded may already have drawn the surface so it has to be
+    // freed after the one following it.
+    m_deferred.push_back({ surface, nullptr, m_submitted });
+}
+
+/*
+    Frees an alpha \a mask once the snapshots which may draw it have been drawn.
+*/
+void RenderThread::deferFree(AlphaMask *mask)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_deferred.push_back({ nullptr, mask, m_submitted });
+}
+
+/*
+    Frees the deferred surfaces which were freed before the snapshot with the given \a sequence
+    number was recorded.
+*/
+void RenderThread::freeSurfaces(uint64_t sequence)
+{
+    auto it = m_deferred.begin();
+    for (; it != m_deferred.end() && it->sequence < sequence; ++it) {
+        release(*it);
+    }
+    m_deferred.erase(m_deferred.begin(), it);
+}
+
+/*
+    Frees a \a deferred surface or mask.
+*/
+void RenderThread::release(const DeferredSurface &deferred)
+{
+    if (deferred.surface) {
+        res_free_surface(deferred.surface);
+    } else {
+        free(deferred.mask);
+    }
+}
+
+void RenderThread::run()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_condition.wait(lock, [this]() { return m_hasPending || m_quit; });
+        if (!m_hasPending) {
+            return;
+        }
+
+        m_rendering.swap(m_pending);
+        const ClipRect bounds = m_pendingBounds;
+        const int frame = m_pendingFrame;
+        const bool invalidateAll = m_invalidateAll;
+        const uint64_t sequence = m_submitted - 1;
+        m_hasPending = false;
+        m_invalidateAll = false;
+        m_busy = true;
+
+        lock.unlock();
+
+        if (invalidateAll) {
+            m_renderer.invalidateAll();
+        }
+        m_renderer.draw(&m_rendering, bounds, frame);
+        gr_flip();
+
+        const uint64_t count = 1;
+        if (m_flipFd >= 0 && ::write(m_flipFd, &count, sizeof(count)) != sizeof(count)) {
+            log_err("RenderThread: Failed to signal flip. " << strerror(errno));
+        }
+
+        lock.lock();
+
+        freeSurfaces(sequence);
+        m_busy = false;
+        m_condition.notify_all();
+    }
+}
+
+} }
@@ -0,0 +1,106 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_RENDERTHREAD_H
+#define SAILFISH_MINUI_RENDERTHREAD_H
+
+#include "displaylist.h"
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Sailfish { namespace MinUi {
+
+class EventLoop;
+
+class RenderThread
+{
+public:
+    RenderThread(EventLoop *eventLoop, const std::function<void()> &flipped);
+    ~RenderThread();
+
+    static RenderThread *instance() { return s_instance; }
+
+    DisplayList *snapshot() { return &m_recording; }
+    void submit(const ClipRect &bounds, int frame);
+
+    void finish();
+    void invalidateAll();
+
+    void deferFree(gr_surface surface);
+    void deferFree(AlphaMask *mask);
+
+private:
+    inline void run();
+    inline void freeSurfaces(uint64_t sequence);
+
+    struct DeferredSurface
+    {
+        gr_surface surface;
+        AlphaMask *mask;
+        uint64_t sequence;
+    };
+
+    static inline void release(const DeferredSurface &deferred);
+
+    static RenderThread *s_instance;
+
+    EventLoop * const m_eventLoop;
+    const std::function<void()> m_flipped;
+    DisplayListRenderer m_renderer;
+    DisplayList m_recording;
+    DisplayList m_pending;
+    DisplayList m_rendering;
+    std::vector<DeferredSurface> m_deferred;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    ClipRect m_pendingBounds = { 0, 0, 0, 0 };
+    uint64_t m_submitted = 0;
+    int m_pendingFrame = 0;
+    const int m_flipFd;
+    bool m_invalidateAll = false;
+    bool m_hasPending = false;
+    bool m_busy = false;
+    bool m_quit = false;
+};
+
+} }
+
+#endif
@@ -3,41 +3,70 @@ TARGET = sailfish-minui
 PUBLIC_HEADERS += \
     busyindicator.h \
     button.h \
+    clock.h \
     display.h \
     eventloop.h \
+    fileio.h \
+    flickable.h \
     icon.h \
     image.h \
+    inputrecorder.h \
     item.h \
     keyboard.h \
+    keymap.h \
     keypad.h \
     label.h \
+    latencytracer.h \
     linkedlist.h \
+    listview.h \
     menu.h \
+    ninepatch.h \
     pagestack.h \
+    process.h \
     progressbar.h \
     rectangle.h \
+    task.h \
     textfield.h \
     textinput.h \
-    ui.h
+    touchresampler.h \
+    ui.h \
+    watchdog.h \
+    wordpredictor.h
 
 SOURCES +=  \
     busyindicator.cpp \
     button.cpp \
     display.cpp \
+    displaylist.cpp \
     eventloop.cpp \
+    fileio.cpp \
+    flickable.cpp \
     icon.cpp \
     image.cpp \
+    inputdevice.cpp \
+    inputrecorder.cpp \
     item.cpp \
     keyboard.cpp \
+    keymap.cpp \
     keypad.cpp \
     label.cpp \
+    latencytracer.cpp \
+    listview.cpp \
     menu.cpp \
     multitouch.cpp \
+    ninepatch.cpp \
     pagestack.cpp \
+    process.cpp \
     progressbar.cpp \
     rectangle.cpp \
+    renderthread.cpp \
+    surface.cpp \
     textfield.cpp \
-    textinput.cpp
+    textinput.cpp \
+    touchresampler.cpp \
+    watchdog.cpp \
+    wordpredictor.cpp \
+    workerpool.cpp
 
 keypadbuttons.ids = \
     sailfish-minui-bt-ok \
@@ -67,6 +96,7 @@ include (../../sailfish-minui-lib.pri)
 include($$SAILFISH_SOURCE_ROOT/src/sailfish-minui-label-tool/sailfish-minui-resources.prf)
 
 PKGCONFIG += minui
+LIBS += -lpthread
 QMAKE_PKGCONFIG_NAME = sailfish-minui
 QMAKE_PKGCONFIG_DESCRIPTION = Minimal UI C++ library
 QMAKE_PKGCONFIG_LIBDIR = $$target.path
@@ -0,0 +1,1363 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "surface.h"
+#include "displaylist.h"
+#include "renderthread.h"
+#include "workerpool.h"
+#include "logging.h"
+
+#include <algorithm>
+
+#include <linux/fb.h>
+#include <sys/ioctl.h>
+
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+
+namespace Sailfish { namespace MinUi {
+
+// A render thread replays frames with its own clip and color while the next is recorded.
+static thread_local ClipRect currentClip = { INT_MIN, INT_MIN, INT_MAX, INT_MAX };
+static thread_local uint8_t currentColor[4] = { 0, 0, 0, 255 };
+
+static void record(DisplayList *list, DisplayList::Command &command, const char *text = nullptr)
+{
+    memcpy(command.color, currentColor, sizeof(currentColor));
+    list->append(command, text);
+}
+
+/*!
+    \class Sailfish::MinUi::ClipRect
+    \brief A rectangle in window coordinates with an exclusive right and bottom.
+    */
+
+    /*!
+    Returns the rectangle the draw functions are clipped to.
+*/
+const ClipRect &clipRect()
+{
+    return currentClip;
+}
+
+/*!
+    Sets the \a rect the draw functions are clipped to.
+
+    The window sets this to its bounds at the start of a draw and items which clip intersect it
+    with their own bounds while they and their children draw.
+*/
+void setClipRect(const ClipRect &rect)
+{
+    currentClip = rect;
+}
+
+/*!
+    Sets the \a red, \a green, \a blue and \a alpha color of the draw functions like gr_color().
+*/
+void setDrawColor(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha)
+{
+    currentColor[0] = red;
+    currentColor[1] = green;
+    currentColor[2] = blue;
+    currentColor[3] = alpha;
+
+    if (!DisplayList::recording()) {
+        gr_color(red, green, blue, alpha);
+    }
+}
+
+/*!
+    Fills the whole target with the current color like gr_clear().
+*/
+void clearWindow()
+{
+    if (DisplayList * const list = DisplayList::recording()) {
+        DisplayList::Command command = {};
+        command.type = DisplayList::Clear;
+        record(list, command);
+    } else {
+        gr_clear();
+    }
+}
+
+/*!
+    Fills the rectangle \a left, \a top, \a right, \a bottom with the current color like gr_fill()
+    within the clip.
+*/
+void fillRect(int left, int top, int right, int bottom)
+{
+    if (DisplayList * const list = DisplayList::recording()) {
+        DisplayList::Command command = {};
+        command.type = DisplayList::Fill;
+        command.x = left;
+        command.y = top;
+        command.width = right - left;
+        command.height = bottom - top;
+        record(list, command);
+        return;
+    }
+
+    const ClipRect rect = currentClip.intersected({ left, top, right, bottom });
+    if (!rect.isEmpty()) {
+        gr_fill(rect.left, rect.top, rect.right, rect.bottom);
+    }
+}
+
+/*!
+    Draws an alpha \a surface at \a x, \a y in the current color like gr_texticon() within the
+    clip.
+*/
+void drawTextIcon(int x, int y, const GRSurface *surface)
+{
+    if (DisplayList * const list = DisplayList::recording()) {
+        DisplayList::Command command = {};
+        command.type = DisplayList::TextIcon;
+        command.x = x;
+        command.y = y;
+        command.width = surface->width;
+        command.height = surface->height;
+        command.surface = *surface;
+        record(list, command);
+        return;
+    }
+
+    const ClipRect bounds = { x, y, x + surface->width, y + surface->height };
+    if (currentClip.contains(bounds)) {
+        gr_texticon(x, y, const_cast<GRSurface *>(surface));
+    } else if (currentClip.intersects(bounds)) {
+        const ClipRect rect = currentClip.intersected(bounds);
+        GRSurface visible = subSurface(
+                    surface, rect.left - x, rect.top - y, rect.right - rect.left, rect.bottom - rect.top);
+        gr_texticon(rect.left, rect.top, &visible);
+    }
+}
+
+/*!
+    Copies the rectangle \a sourceX, \a sourceY, \a width, \a height of an RGB \a source surface to
+    \a x, \a y like gr_blit_rgb() within the clip.
+*/
+void blitRgb(const GRSurface *source, int sourceX, int sourceY, int width, int height, int x, int y)
+{
+    if (DisplayList * const list = DisplayList::recording()) {
+        DisplayList::Command command = {};
+        command.type = DisplayList::BlitRgb;
+        command.x = x;
+        command.y = y;
+        command.sourceX = sourceX;
+        command.sourceY = sourceY;
+        command.width = width;
+        command.height = height;
+        command.surface = *source;
+        record(list, command);
+        return;
+    }
+
+    const ClipRect rect = currentClip.intersected({ x, y, x + width, y + height });
+    if (!rect.isEmpty()) {
+        gr_blit_rgb(
+                    const_cast<GRSurface *>(source),
+                    sourceX + rect.left - x,
+                    sourceY + rect.top - y,
+                    rect.right - rect.left,
+                    rect.bottom - rect.top,
+                    rect.left,
+                    rect.top);
+    }
+}
+
+/*!
+    \class Sailfish::MinUi::AlphaMask
+    \brief A run length encoded single channel alpha mask.
+
+    Each row is a sequence of runs starting with a byte which gives the kind of run in its top two
+    bits and its length less one in the low six bits.  Transparent runs are skipped when drawn and
+    opaque runs are filled, so only literal runs, which are followed by an alpha value for each
+    pixel, are blended.  The runs of every row follow the offsets of the rows, and the mask is a
+    single allocation of size bytes.
+    */
+
+    /*!
+    Draws an alpha \a mask at \a x, \a y in the current color within the clip.
+
+    The result is the same as drawing the decoded surface with drawTextIcon().
+*/
+void drawAlphaMask(int x, int y, const AlphaMask *mask)
+{
+    if (DisplayList * const list = DisplayList::recording()) {
+        DisplayList::Command command = {};
+        command.type = DisplayList::Mask;
+        command.x = x;
+        command.y = y;
+        command.width = mask->width;
+        command.height = mask->height;
+        command.mask = mask;
+        record(list, command);
+        return;
+    }
+
+    const ClipRect rect = currentClip.intersected({ x, y, x + mask->width, y + mask->height });
+    if (rect.isEmpty()) {
+        return;
+    }
+
+    for (int row = rect.top; row < rect.bottom; ++row) {
+        const uint8_t *run = mask->row(row - y);
+
+        // Adjacent opaque runs are joined into a single fill.
+        int fillLeft = 0;
+        int fillRight = 0;
+
+        for (int left = x; left < rect.right;) {
+            const int kind = *run & AlphaMask::KindMask;
+            const int length = (*run & ~AlphaMask::KindMask) + 1;
+            const int right = left + length;
+            const int visibleLeft = std::max(left, rect.left);
+            const int visibleRight = std::min(right, rect.right);
+
+            ++run;
+
+            if (kind != AlphaMask::Opaque || visibleLeft != fillRight) {
+                if (fillLeft < fillRight) {
+                    gr_fill(fillLeft, row, fillRight, row + 1);
+                }
+                fillLeft = visibleLeft;
+                fillRight = visibleLeft;
+            }
+
+            if (visibleLeft >= visibleRight) {
+                // Outside the clip.
+            } else if (kind == AlphaMask::Opaque) {
+                fillRight = visibleRight;
+            } else if (kind == AlphaMask::Literal) {
+                GRSurface span;
+                span.width = visibleRight - visibleLeft;
+                span.height = 1;
+                span.row_bytes = length;
+                span.pixel_bytes = 1;
+                span.data = const_cast<uint8_t *>(run) + visibleLeft - left;
+                gr_texticon(visibleLeft, row, &span);
+            }
+
+            if (kind == AlphaMask::Literal) {
+                run += length;
+            }
+            left = right;
+        }
+
+        if (fillLeft < fillRight) {
+            gr_fill(fillLeft, row, fillRight, row + 1);
+        }
+    }
+}
+
+static int alphaKind(uint8_t alpha)
+{
+    return alpha == 0
+            ? AlphaMask::Transparent
+            : alpha == 255 ? AlphaMask::Opaque : AlphaMask::Literal;
+}
+
+/*!
+    Encodes an alpha \a surface as an alpha mask.
+
+    Returns null if the surface isn't an alpha surface.
+*/
+AlphaMask *encodeAlphaMask(const GRSurface *surface)
+{
+    if (!surface || surface->pixel_bytes != 1) {
+        return nullptr;
+    }
+
+    std::vector<uint32_t> offsets(surface->height);
+    std::vector<uint8_t> runs;
+
+    for (int row = 0; row < surface->height; ++row) {
+        const unsigned char * const in = surface->data + (row * surface->row_bytes);
+
+        offsets[row] = runs.size();
+
+        for (int column = 0; column < surface->width;) {
+            const int kind = alphaKind(in[column]);
+            const int limit = std::min<int>(surface->width - column, AlphaMask::MaximumRunLength);
+
+            int length = 1;
+            if (kind != AlphaMask::Literal) {
+                while (length < limit && in[column + length] == in[column]) {
+                    ++length;
+                }
+            } else {
+                // A single transparent or opaque pixel costs no more as part of a literal run.
+                while (length < limit
+                        && (alphaKind(in[column + length]) == AlphaMask::Literal
+                            || (column + length + 1 < surface->width
+                                && in[column + length + 1] != in[column + length]))) {
+                    ++length;
+                }
+            }
+
+            runs.push_back(kind | (length - 1));
+            if (kind == AlphaMask::Literal) {
+                runs.insert(runs.end(), in + column, in + column + length);
+            }
+            column += length;
+        }
+    }
+
+    const size_t offsetBytes = offsets.size() * sizeof(uint32_t);
+    const size_t size = sizeof(AlphaMask) + offsetBytes + runs.size();
+
+    AlphaMask * const mask = static_cast<AlphaMask *>(malloc(size));
+    if (!mask) {
+        log_err("Failed to allocate a " << size << " byte alpha mask");
+        return nullptr;
+    }
+
+    mask->width = surface->width;
+    mask->height = surface->height;
+    mask->size = size;
+
+    unsigned char * const data = reinterpret_cast<unsigned char *>(mask + 1);
+    memcpy(data, offsets.data(), offsetBytes);
+    memcpy(data + offsetBytes, runs.data(), runs.size());
+
+    return mask;
+}
+
+/*!
+    Decodes an alpha \a mask into a new alpha surface.
+*/
+gr_surface decodeAlphaMask(const AlphaMask *mask)
+{
+    gr_surface surface = createAlphaSurface(mask->width, mask->height);
+    if (!surface) {
+        return nullptr;
+    }
+
+    for (int row = 0; row < mask->height; ++row) {
+        const uint8_t *run = mask->row(row);
+        unsigned char *out = surface->data + (row * surface->row_bytes);
+
+        for (int column = 0; column < mask->width;) {
+            const int kind = *run & AlphaMask::KindMask;
+            const int length = (*run & ~AlphaMask::KindMask) + 1;
+
+            ++run;
+
+            if (kind == AlphaMask::Opaque) {
+                memset(out + column, 255, length);
+            } else if (kind == AlphaMask::Literal) {
+                memcpy(out + column, run, length);
+                run += length;
+            }
+            column += length;
+        }
+    }
+
+    return surface;
+}
+
+/*
+    Returns the source index of a \a target index when stretching a \a sourceSize to a
+    \a targetSize by repeating the center index.
+*/
+static int stretchedIndex(int target, int sourceSize, int targetSize)
+{
+    const int center = sourceSize / 2;
+    const int end = targetSize - (sourceSize - center - 1);
+
+    return target < std::min(center, end)
+            ? target
+            : target >= end ? target - targetSize + sourceSize : center;
+}
+
+/*!
+    Stretches an alpha \a mask to a new \a width and \a height by repeating its center column and
+    row.
+
+    The pixels either side of the center are copied unscaled, or cropped if the new size is smaller
+    than the mask.  Returns null if the new size is empty.
+*/
+AlphaMask *stretchAlphaMask(const AlphaMask *mask, int width, int height)
+{
+    if (width <= 0 || height <= 0 || mask->width <= 0 || mask->height <= 0) {
+        return nullptr;
+    }
+
+    gr_surface source = decodeAlphaMask(mask);
+    gr_surface target = createAlphaSurface(width, height);
+    AlphaMask *stretched = nullptr;
+
+    if (source && target) {
+        std::vector<int> columns(width);
+        for (int column = 0; column < width; ++column) {
+            columns[column] = stretchedIndex(column, source->width, width);
+        }
+
+        for (int row = 0; row < height; ++row) {
+            const unsigned char *in = source->data
+                    + (stretchedIndex(row, source->height, height) * source->row_bytes);
+            unsigned char *out = target->data + (row * target->row_bytes);
+            for (int column = 0; column < width; ++column) {
+                out[column] = in[columns[column]];
+            }
+        }
+
+        stretched = encodeAlphaMask(target);
+    }
+
+    res_free_surface(source);
+    res_free_surface(target);
+
+    return stretched;
+}
+
+/*!
+    Releases an alpha \a mask once any frames which drew it have been rendered.
+*/
+void freeAlphaMask(AlphaMask *mask)
+{
+    if (mask) {
+        DisplayListRenderer::maskFreed(mask);
+        if (RenderThread * const thread = RenderThread::instance()) {
+            thread->deferFree(mask);
+        } else {
+            free(mask);
+        }
+    }
+}
+
+/*!
+    Copies the rectangle \a sourceX, \a sourceY, \a width, \a height of a \a source surface in the
+    native pixel format to \a x, \a y like gr_blit() within the clip.
+
+    The source must have been converted to nativePixelFormat() by convertSurface() so every row is
+    copied without conversion.
+*/
+void blitSurface(const GRSurface *source, int sourceX, int sourceY, int width, int height, int x, int y)
+{
+    if (DisplayList * const list = DisplayList::recording()) {
+        DisplayList::Command command = {};
+        command.type = DisplayList::Blit;
+        command.x = x;
+        command.y = y;
+        command.sourceX = sourceX;
+        command.sourceY = sourceY;
+        command.width = width;
+        command.height = height;
+        command.surface = *source;
+        record(list, command);
+        return;
+    }
+
+    const ClipRect rect = currentClip.intersected({ x, y, x + width, y + height });
+    if (!rect.isEmpty()) {
+        gr_blit(
+                    const_cast<GRSurface *>(source),
+                    sourceX + rect.left - x,
+                    sourceY + rect.top - y,
+                    rect.right - rect.left,
+                    rect.bottom - rect.top,
+                    rect.left,
+                    rect.top);
+    }
+}
+
+static const struct {
+    PixelFormat format;
+    const char *name;
+} pixelFormatNames[] = {
+    { PixelFormat::RGBX8888, "RGBX_8888" },
+    { PixelFormat::BGRA8888, "BGRA_8888" },
+    { PixelFormat::ABGR8888, "ABGR_8888" },
+    { PixelFormat::RGB565, "RGB_565" }
+};
+
+/*!
+    \enum Sailfish::MinUi::PixelFormat
+    \brief The layouts of the framebuffer pixels minui draws to.
+
+    The names give the order of the channels in memory.
+    */
+
+    /*!
+    Returns the name of a pixel \a format as used by the SAILFISH_MINUI_PIXEL_FORMAT environment
+    variable.
+*/
+const char *pixelFormatName(PixelFormat format)
+{
+    for (const auto &entry : pixelFormatNames) {
+        if (entry.format == format) {
+            return entry.name;
+        }
+    }
+    return "Unknown";
+}
+
+static PixelFormat framebufferPixelFormat()
+{
+    static const char * const devices[] = { "/dev/graphics/fb0", "/dev/fb0" };
+
+    for (const char *device : devices) {
+        const int fd = ::open(device, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        fb_var_screeninfo info;
+        const int result = ::ioctl(fd, FBIOGET_VSCREENINFO, &info);
+        ::close(fd);
+
+        if (result < 0) {
+            continue;
+        } else if (info.bits_per_pixel == 16) {
+            return PixelFormat::RGB565;
+        } else if (info.bits_per_pixel == 32) {
+            // The offsets are bit positions within a little endian word.
+            switch (info.red.offset) {
+            case 0:
+                return PixelFormat::RGBX8888;
+            case 16:
+                return PixelFormat::BGRA8888;
+            case 24:
+                return PixelFormat::ABGR8888;
+            default:
+                break;
+            }
+        }
+        log_warning("Unrecognized framebuffer pixel layout " << info.bits_per_pixel << " bpp");
+        return PixelFormat::Unknown;
+    }
+    return PixelFormat::Unknown;
+}
+
+/*!
+    Returns the layout of the framebuffer pixels.
+
+    The format is read from the SAILFISH_MINUI_PIXEL_FORMAT environment variable, which takes the
+    names minui is configured with such as RGBX_8888, or else from the channel offsets the
+    framebuffer device reports.  Returns PixelFormat::Unknown if neither is available.
+*/
+PixelFormat nativePixelFormat()
+{
+    static const PixelFormat format = []() {
+        if (const char * const env = getenv("SAILFISH_MINUI_PIXEL_FORMAT")) {
+            for (const auto &entry : pixelFormatNames) {
+                if (strcmp(env, entry.name) == 0) {
+                    return entry.format;
+                }
+            }
+            log_warning("Unknown pixel format " << env);
+            return PixelFormat::Unknown;
+        }
+        return framebufferPixelFormat();
+    }();
+    return format;
+}
+
+/*!
+    Returns the number of bytes in a pixel of a \a format.
+*/
+int pixelBytes(PixelFormat format)
+{
+    switch (format) {
+    case PixelFormat::RGBX8888:
+    case PixelFormat::BGRA8888:
+    case PixelFormat::ABGR8888:
+        return 4;
+    case PixelFormat::RGB565:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+template <PixelFormat Format, bool Premultiply>
+static void convertRows(GRSurface *target, const GRSurface *source)
+{
+    const int sourceBytes = source->pixel_bytes;
+
+    for (int row = 0; row < source->height; ++row) {
+        const unsigned char *in = source->data + (row * source->row_bytes);
+        unsigned char *out = target->data + (row * target->row_bytes);
+
+        for (int column = 0; column < source->width; ++column, in += sourceBytes) {
+            const int alpha = sourceBytes == 4 ? in[3] : 255;
+            int red = in[0];
+            int green = in[1];
+            int blue = in[2];
+            if (Premultiply) {
+                red = (red * alpha + 127) / 255;
+                green = (green * alpha + 127) / 255;
+                blue = (blue * alpha + 127) / 255;
+            }
+
+            switch (Format) {
+            case PixelFormat::RGBX8888:
+                *out++ = red;
+                *out++ = green;
+                *out++ = blue;
+                *out++ = 255;
+                break;
+            case PixelFormat::BGRA8888:
+                *out++ = blue;
+                *out++ = green;
+                *out++ = red;
+                *out++ = alpha;
+                break;
+            case PixelFormat::ABGR8888:
+                *out++ = alpha;
+                *out++ = blue;
+                *out++ = green;
+                *out++ = red;
+                break;
+            case PixelFormat::RGB565: {
+                const uint16_t pixel = ((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3);
+                memcpy(out, &pixel, sizeof(pixel));
+                out += sizeof(pixel);
+                break;
+            }
+            default:
+                break;
+            }
+        }
+    }
+}
+
+template <PixelFormat Format>
+static void convertRows(GRSurface *target, const GRSurface *source, bool premultiply)
+{
+    if (premultiply && source->pixel_bytes == 4) {
+        convertRows<Format, true>(target, source);
+    } else {
+        convertRows<Format, false>(target, source);
+    }
+}
+
+/*!
+    Converts the pixels of an RGB or RGBA display surface \a source into a \a target surface of the
+    same size in another pixel \a format.
+
+    If \a premultiply is true the color channels are multiplied by the alpha of a source with four
+    channels.  Formats without alpha ignore it.
+*/
+void convertPixels(GRSurface *target, PixelFormat format, const GRSurface *source, bool premultiply)
+{
+    if (source->pixel_bytes != 3 && source->pixel_bytes != 4) {
+        return;
+    }
+
+    // Each format is a separate loop so the channel order is fixed at compile time.
+    switch (format) {
+    case PixelFormat::RGBX8888:
+        convertRows<PixelFormat::RGBX8888>(target, source, premultiply);
+        break;
+    case PixelFormat::BGRA8888:
+        convertRows<PixelFormat::BGRA8888>(target, source, premultiply);
+        break;
+    case PixelFormat::ABGR8888:
+        convertRows<PixelFormat::ABGR8888>(target, source, premultiply);
+        break;
+    case PixelFormat::RGB565:
+        convertRows<PixelFormat::RGB565>(target, source, premultiply);
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+    Returns true if an RGB or RGBA display \a surface has no translucent pixels.
+
+    Only opaque surfaces may be converted for blitSurface(), which copies pixels over the
+    framebuffer rather than blending them.
+*/
+bool isOpaque(const GRSurface *surface)
+{
+    if (surface->pixel_bytes == 3) {
+        return true;
+    } else if (surface->pixel_bytes != 4) {
+        return false;
+    }
+
+    for (int row = 0; row < surface->height; ++row) {
+        const unsigned char *in = surface->data + (row * surface->row_bytes) + 3;
+        for (int column = 0; column < surface->width; ++column, in += 4) {
+            if (*in != 255) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*!
+    Allocates a copy of an RGB or RGBA display surface \a source converted to a pixel \a format,
+    multiplying the color channels by the alpha if \a premultiply is true.  Returns null if the
+    format is unknown.
+
+    The surface header and pixels are a single allocation so it may be released with freeSurface().
+*/
+gr_surface convertSurface(const GRSurface *source, PixelFormat format, bool premultiply)
+{
+    const int bytes = pixelBytes(format);
+    if (bytes == 0 || !source || (source->pixel_bytes != 3 && source->pixel_bytes != 4)) {
+        return nullptr;
+    }
+
+    const int rowBytes = source->width * bytes;
+    GRSurface * const surface = static_cast<GRSurface *>(
+                malloc(sizeof(GRSurface) + (size_t(rowBytes) * source->height)));
+    if (!surface) {
+        log_err("Failed to allocate a " << source->width << "x" << source->height << " surface");
+        return nullptr;
+    }
+
+    surface->width = source->width;
+    surface->height = source->height;
+    surface->row_bytes = rowBytes;
+    surface->pixel_bytes = bytes;
+    surface->data = reinterpret_cast<unsigned char *>(surface + 1);
+
+    convertPixels(surface, format, source, premultiply);
+
+    return surface;
+}
+
+/*!
+    Releases a \a surface like res_free_surface().
+
+    Surfaces which may have been drawn must be released with this so that retained rendering
+    doesn't mistake a new surface allocated at the same address for an unchanged one.
+*/
+void freeSurface(gr_surface surface)
+{
+    if (surface) {
+        DisplayListRenderer::surfaceFreed(surface);
+        if (RenderThread * const thread = RenderThread::instance()) {
+            thread->deferFree(surface);
+        } else {
+            res_free_surface(surface);
+        }
+    }
+}
+
+/*!
+    Allocates a zero filled surface of \a width and \a height with \a pixelBytes bytes in each
+    pixel.
+
+    The surface header and pixels are a single allocation so it may be released with
+    res_free_surface() like surfaces loaded from resources.
+*/
+gr_surface createSurface(int width, int height, int pixelBytes)
+{
+    width = std::max(0, width);
+    height = std::max(0, height);
+
+    GRSurface * const surface = static_cast<GRSurface *>(
+                calloc(1, sizeof(GRSurface) + (size_t(width) * height * pixelBytes)));
+    if (surface) {
+        surface->width = width;
+        surface->height = height;
+        surface->row_bytes = width * pixelBytes;
+        surface->pixel_bytes = pixelBytes;
+        surface->data = reinterpret_cast<unsigned char *>(surface + 1);
+    }
+    return surface;
+}
+
+/*!
+    Allocates a zero filled single channel alpha surface of \a width and \a height.
+
+    The surface header and pixels are a single allocation so it may be released with
+    res_free_surface() like surfaces loaded from resources.
+*/
+gr_surface createAlphaSurface(int width, int height)
+{
+    return createSurface(width, height, 1);
+}
+
+/*
+    Adds the channels of a pixel to a \a sum of each channel.
+*/
+static void addPixel(int *sum, const unsigned char *pixel, int pixelBytes)
+{
+    if (pixelBytes == 2) {
+        uint16_t value;
+        memcpy(&value, pixel, sizeof(value));
+        sum[0] += (value >> 11) & 0x1f;
+        sum[1] += (value >> 5) & 0x3f;
+        sum[2] += value & 0x1f;
+    } else {
+        for (int channel = 0; channel < pixelBytes; ++channel) {
+            sum[channel] += pixel[channel];
+        }
+    }
+}
+
+/*
+    Writes the average of \a count pixels with the given \a sum of each channel to \a pixel.
+*/
+static void averagePixel(unsigned char *pixel, const int *sum, int count, int pixelBytes)
+{
+    if (pixelBytes == 2) {
+        const uint16_t value = (((sum[0] + (count / 2)) / count) << 11)
+                | (((sum[1] + (count / 2)) / count) << 5)
+                | ((sum[2] + (count / 2)) / count);
+        memcpy(pixel, &value, sizeof(value));
+    } else {
+        for (int channel = 0; channel < pixelBytes; ++channel) {
+            pixel[channel] = (sum[channel] + (count / 2)) / count;
+        }
+    }
+}
+
+/*!
+    Allocates a copy of a \a source surface resized to \a width and \a height with a box filter.
+
+    Each pixel is the average of the source pixels it covers, so reducing a surface by more than
+    half loses none of them and enlarging it repeats pixels.  Surfaces with two bytes in a pixel
+    are taken to be RGB565 and the bytes of other surfaces are averaged separately.
+*/
+gr_surface scaleSurface(const GRSurface *source, int width, int height)
+{
+    if (!source || width <= 0 || height <= 0 || source->width <= 0 || source->height <= 0
+            || source->pixel_bytes < 1 || source->pixel_bytes > 4) {
+        return nullptr;
+    }
+
+    const int pixelBytes = source->pixel_bytes;
+    gr_surface target = createSurface(width, height, pixelBytes);
+    if (!target) {
+        log_err("Failed to allocate a " << width << "x" << height << " surface");
+        return nullptr;
+    }
+
+    std::vector<int> columns(width + 1);
+    for (int column = 0; column <= width; ++column) {
+        columns[column] = (column * source->width) / width;
+    }
+
+    for (int row = 0; row < height; ++row) {
+        const int top = (row * source->height) / height;
+        const int bottom = std::max(top + 1, ((row + 1) * source->height) / height);
+        unsigned char *out = target->data + (row * target->row_bytes);
+
+        for (int column = 0; column < width; ++column, out += pixelBytes) {
+            const int left = columns[column];
+            const int right = std::max(left + 1, columns[column + 1]);
+
+            int sum[4] = {};
+            for (int y = top; y < bottom; ++y) {
+                const unsigned char *in = source->data + (y * source->row_bytes) + (left * pixelBytes);
+                for (int x = left; x < right; ++x, in += pixelBytes) {
+                    addPixel(sum, in, pixelBytes);
+                }
+            }
+            averagePixel(out, sum, (bottom - top) * (right - left), pixelBytes);
+        }
+    }
+
+    return target;
+}
+
+/*!
+    \class Sailfish::MinUi::MipCache
+    \brief Successive halvings of the size of a surface for scaling it.
+
+    Each level is filtered from the level above it the first time it is needed and kept, and a
+    surface of any size is then filtered from the smallest level which is at least as large, so
+    scaling down never reads more than four times the pixels written.
+    */
+
+    /*!
+    Constructs a cache of scaled copies of a \a base surface.
+
+    The base surface is not owned by the cache.
+*/
+MipCache::MipCache(const GRSurface *base)
+    : m_base(base)
+{
+}
+
+MipCache::~MipCache()
+{
+    for (gr_surface level : m_levels) {
+        if (level) {
+            res_free_surface(level);
+        }
+    }
+}
+
+/*
+    Returns a new surface with the base surface scaled to \a width and \a height, or null if
+    the size is empty.
+*/
+gr_surface MipCache::scaled(int width, int height)
+{
+    if (!m_base || width <= 0 || height <= 0) {
+        return nullptr;
+    }
+
+    const GRSurface *source = m_base;
+    for (gr_surface &level : m_levels) {
+        if (source->width / 2 < width || source->height / 2 < height) {
+            break;
+        } else if (!level && !(level = scaleSurface(source, source->width / 2, source->height / 2))) {
+            break;
+        }
+        source = level;
+    }
+
+    return scaleSurface(source, width, height);
+}
+
+/*!
+    Returns a view of the rectangle \a x, \a y, \a width, \a height of a \a surface clipped to its
+    bounds.
+
+    The view shares the pixels of the surface and has no width or height if the rectangle is
+    outside the surface.
+*/
+GRSurface subSurface(const GRSurface *surface, int x, int y, int width, int height)
+{
+    const int left = std::max(0, x);
+    const int top = std::max(0, y);
+    const int right = std::min(surface->width, x + width);
+    const int bottom = std::min(surface->height, y + height);
+
+    GRSurface view = *surface;
+    view.width = std::max(0, right - left);
+    view.height = std::max(0, bottom - top);
+    view.data = surface->data + (top * surface->row_bytes) + (left * surface->pixel_bytes);
+    if (view.width == 0 || view.height == 0) {
+        view.width = 0;
+        view.height = 0;
+        view.data = surface->data;
+    }
+    return view;
+}
+
+/*!
+    Composites an alpha \a source surface with the given \a opacity over the alpha surface
+    \a target at \a x, \a y.
+
+    Pixels falling outside the target are clipped.
+*/
+void compositeAlpha(GRSurface *target, int x, int y, const GRSurface *source, double opacity)
+{
+    if (!source || source->pixel_bytes != 1) {
+        return;
+    } else if (MaskRasterizer * const rasterizer = MaskRasterizer::recording(target)) {
+        rasterizer->composite(x, y, source, opacity);
+        return;
+    }
+
+    const int sourceX = std::max(0, -x);
+    const int sourceY = std::max(0, -y);
+    const int width = std::min(source->width, target->width - x) - sourceX;
+    const int height = std::min(source->height, target->height - y) - sourceY;
+    const int scale = int(opacity * 256);
+
+    for (int row = 0; row < height; ++row) {
+        const unsigned char *in = source->data
+                + ((sourceY + row) * source->row_bytes) + sourceX;
+        unsigned char *out = target->data
+                + ((y + sourceY + row) * target->row_bytes) + x + sourceX;
+        for (int column = 0; column < width; ++column) {
+            const int alpha = (in[column] * scale) >> 8;
+            out[column] = alpha + out[column] - ((alpha * out[column]) / 255);
+        }
+    }
+}
+
+/*!
+    Composites an alpha \a mask with the given \a opacity over the alpha surface \a target at
+    \a x, \a y.
+
+    The result is the same as compositing the decoded surface.
+*/
+void compositeAlpha(GRSurface *target, int x, int y, const AlphaMask *mask, double opacity)
+{
+    if (!mask) {
+        return;
+    } else if (MaskRasterizer * const rasterizer = MaskRasterizer::recording(target)) {
+        rasterizer->composite(x, y, mask, opacity);
+        return;
+    }
+
+    const int left = std::max(0, -x);
+    const int right = std::min(mask->width, target->width - x);
+    const int top = std::max(0, -y);
+    const int bottom = std::min(mask->height, target->height - y);
+    const int scale = int(opacity * 256);
+    const int opaque = (255 * scale) >> 8;
+
+    for (int row = top; row < bottom; ++row) {
+        const uint8_t *run = mask->row(row);
+        unsigned char *out = target->data + ((y + row) * target->row_bytes) + x;
+
+        for (int column = 0; column < right;) {
+            const int kind = *run & AlphaMask::KindMask;
+            const int length = (*run & ~AlphaMask::KindMask) + 1;
+            const int end = std::min(column + length, right);
+
+            ++run;
+
+            if (kind == AlphaMask::Opaque) {
+                for (int i = std::max(column, left); i < end; ++i) {
+                    out[i] = opaque + out[i] - ((opaque * out[i]) / 255);
+                }
+            } else if (kind == AlphaMask::Literal) {
+                for (int i = std::max(column, left); i < end; ++i) {
+                    const int alpha = (run[i - column] * scale) >> 8;
+                    out[i] = alpha + out[i] - ((alpha * out[i]) / 255);
+                }
+                run += length;
+            }
+            column += length;
+        }
+    }
+}
+
+static thread_local MaskRasterizer *recordingMask = nullptr;
+
+/*!
+    \class Sailfish::MinUi::MaskRasterizer
+    \brief Composites into an alpha surface on all cores.
+
+    While a mask rasterizer exists the compositeAlpha() and compositeText() calls made on the same
+    thread with its target are recorded rather than executed, and \l rasterize() then splits the
+    target into horizontal bands which are composited in parallel on the worker pool.  Every band
+    composites the commands which intersect it in the order they were recorded so the result is
+    identical to compositing them one at a time.
+    */
+
+    /*!
+    Constructs a mask rasterizer which records composites into a \a target surface.
+*/
+MaskRasterizer::MaskRasterizer(GRSurface *target)
+    : m_target(target)
+    , m_previous(recordingMask)
+{
+    recordingMask = this;
+}
+
+MaskRasterizer::~MaskRasterizer()
+{
+    rasterize();
+}
+
+/*
+    Returns the rasterizer recording composites into \a target if there is one.
+*/
+MaskRasterizer *MaskRasterizer::recording(const GRSurface *target)
+{
+    for (MaskRasterizer *rasterizer = recordingMask; rasterizer; rasterizer = rasterizer->m_previous) {
+        if (rasterizer->m_target == target) {
+            return rasterizer;
+        }
+    }
+    return nullptr;
+}
+
+/*
+    Records a composite of \a source at \a x, \a y with the given \a opacity.
+*/
+void MaskRasterizer::composite(int x, int y, const GRSurface *source, double opacity)
+{
+    if (x < m_target->width
+            && y < m_target->height
+            && x + source->width > 0
+            && y + source->height > 0) {
+        m_commands.push_back({ *source, nullptr, x, y, opacity });
+    }
+}
+
+/*
+    Records a composite of an alpha \a mask at \a x, \a y with the given \a opacity.
+*/
+void MaskRasterizer::composite(int x, int y, const AlphaMask *mask, double opacity)
+{
+    if (x < m_target->width
+            && y < m_target->height
+            && x + mask->width > 0
+            && y + mask->height > 0) {
+        // Only the size of the source of a mask command is used.
+        GRSurface bounds = {};
+        bounds.width = mask->width;
+        bounds.height = mask->height;
+        m_commands.push_back({ bounds, mask, x, y, opacity });
+    }
+}
+
+/*
+    Stops recording and composites the recorded commands into the target.
+*/
+void MaskRasterizer::rasterize()
+{
+    if (recordingMask == this) {
+        recordingMask = m_previous;
+    }
+
+    if (m_commands.empty()) {
+        return;
+    }
+
+    WorkerPool * const pool = WorkerPool::instance();
+    const int bandCount = std::max(1, std::min(
+                pool->threadCount(), int(m_target->height / MinimumBandHeight)));
+    const int bandHeight = (m_target->height + bandCount - 1) / bandCount;
+
+    pool->run(bandCount, [this, bandHeight](int index) {
+        const int top = index * bandHeight;
+        GRSurface band = subSurface(m_target, 0, top, m_target->width, bandHeight);
+
+        for (const Command &command : m_commands) {
+            if (command.y >= top + band.height || command.y + command.source.height <= top) {
+                // Outside the band.
+            } else if (command.mask) {
+                compositeAlpha(&band, command.x, command.y - top, command.mask, command.opacity);
+            } else {
+                compositeAlpha(&band, command.x, command.y - top, &command.source, command.opacity);
+            }
+        }
+    });
+
+    m_commands.clear();
+}
+
+/*
+    The glyphs gr_text() draws are the first row of the font resource with a fixed width cell
+    for each printable ASCII character starting with space.
+*/
+enum {
+    FirstGlyph = ' ',
+    GlyphCount = 96
+};
+
+static const GRSurface *fontGlyphs(int *width, int *height)
+{
+    static gr_surface glyphs = nullptr;
+    static bool loaded = false;
+
+    if (!loaded) {
+        loaded = true;
+
+        const int result = res_create_alpha_surface("font", &glyphs);
+        if (result != 0) {
+            log_warning("Font glyphs are unavailable for cached rendering " << result);
+            glyphs = nullptr;
+        }
+    }
+
+    gr_font_size(width, height);
+
+    return glyphs && *width * GlyphCount <= glyphs->width && *height <= glyphs->height
+            ? glyphs
+            : nullptr;
+}
+
+/*!
+    Draws \a text at \a x, \a y in the current color like gr_text() within the clip, in a \a bold
+    font if requested.
+
+    Characters partially outside the clip are drawn from the font glyphs if they are available and
+    omitted otherwise.
+*/
+void drawText(int x, int y, const char *text, bool bold)
+{
+    int fontWidth;
+    int fontHeight;
+    gr_font_size(&fontWidth, &fontHeight);
+
+    const int length = strlen(text);
+
+    if (DisplayList * const list = DisplayList::recording()) {
+        DisplayList::Command command = {};
+        command.type = DisplayList::Text;
+        command.bold = bold;
+        command.x = x;
+        command.y = y;
+        command.width = length * fontWidth;
+        command.height = fontHeight;
+        command.textLength = length;
+        record(list, command, text);
+        return;
+    }
+
+    const ClipRect bounds = { x, y, x + (length * fontWidth), y + fontHeight };
+    if (currentClip.contains(bounds)) {
+        gr_text(x, y, text, bold);
+        return;
+    } else if (!currentClip.intersects(bounds)) {
+        return;
+    }
+
+    // Draw the characters which are wholly visible a run at a time and those which are
+    // partially visible from the glyphs.
+    const GRSurface * const glyphs = fontGlyphs(&fontWidth, &fontHeight);
+    char run[64];
+    int runStart = x;
+    int runLength = 0;
+    for (int i = 0; i <= length; ++i) {
+        const int left = x + (i * fontWidth);
+        const ClipRect cell = { left, y, left + fontWidth, y + fontHeight };
+        const bool visible = i < length && currentClip.contains(cell);
+
+        if (runLength > 0 && (!visible || runLength == int(sizeof(run)) - 1)) {
+            run[runLength] = '\0';
+            gr_text(runStart, y, run, bold);
+            runLength = 0;
+        }
+
+        if (visible) {
+            if (runLength == 0) {
+                runStart = left;
+            }
+            run[runLength++] = text[i];
+        } else if (i < length && glyphs && currentClip.intersects(cell)) {
+            const int index = static_cast<unsigned char>(text[i]) - FirstGlyph;
+            if (index > 0 && index < GlyphCount) {
+                const GRSurface glyph = subSurface(glyphs, index * fontWidth, 0, fontWidth, fontHeight);
+                drawTextIcon(left, y, &glyph);
+            }
+        }
+    }
+}
+
+/*!
+    Returns true if the font glyphs used by gr_text() are available for rendering into surfaces.
+*/
+bool hasFontGlyphs()
+{
+    int width;
+    int height;
+    return fontGlyphs(&width, &height);
+}
+
+/*!
+    Renders \a text with the given \a opacity into an alpha surface \a target the same as
+    LiteralLabel draws it.
+
+    Characters are spaced at three quarters of the font width centered horizontally on \a x and
+    vertically on \a y.  Returns false if the font glyphs can't be loaded.
+*/
+bool compositeText(GRSurface *target, int x, int y, const std::string &text, double opacity)
+{
+    int fontWidth;
+    int fontHeight;
+    const GRSurface * const glyphs = fontGlyphs(&fontWidth, &fontHeight);
+    if (!glyphs) {
+        return false;
+    }
+
+    const float charDistance = fontWidth * 0.75;
+    int left = x - int(charDistance * text.size()) / 2;
+    const int top = y - (fontHeight / 2);
+
+    for (char c : text) {
+        const int index = static_cast<unsigned char>(c) - FirstGlyph;
+        if (index >= 0 && index < GlyphCount) {
+            const GRSurface glyph = subSurface(glyphs, index * fontWidth, 0, fontWidth, fontHeight);
+            compositeAlpha(target, left, top, &glyph, opacity);
+        }
+        left += charDistance;
+    }
+    return true;
+}
+
+/*!
+    Draws an alpha \a surface at \a x, \a y in a \a color with the given \a opacity.
+*/
+void drawAlphaSurface(int x, int y, const GRSurface *surface, Color color, double opacity)
+{
+    const uint8_t alpha = color.a * opacity;
+    if (alpha != 0 && surface->width > 0 && surface->height > 0) {
+        setDrawColor(color.r, color.g, color.b, alpha);
+        drawTextIcon(x, y, surface);
+    }
+}
+
+static void drawRegion(
+        int x, int y, const GRSurface *surface, int left, int top, int right, int bottom,
+        Color color, double opacity)
+{
+    if (right > left && bottom > top) {
+        const GRSurface region = subSurface(surface, left, top, right - left, bottom - top);
+        drawAlphaSurface(x + left, y + top, &region, color, opacity);
+    }
+}
+
+/*!
+    Draws an alpha \a surface at \a x, \a y in one \a color except for the rectangle
+    \a highlightX, \a highlightY, \a highlightWidth, \a highlightHeight which is drawn in
+    \a highlightColor, with the given \a opacity.
+*/
+void drawAlphaSurface(
+        int x,
+        int y,
+        const GRSurface *surface,
+        Color color,
+        int highlightX,
+        int highlightY,
+        int highlightWidth,
+        int highlightHeight,
+        Color highlightColor,
+        double opacity)
+{
+    const int left = std::max(0, highlightX);
+    const int top = std::max(0, highlightY);
+    const int right = std::min(surface->width, highlightX + highlightWidth);
+    const int bottom = std::min(surface->height, highlightY + highlightHeight);
+
+    if (left >= right || top >= bottom) {
+        drawAlphaSurface(x, y, surface, color, opacity);
+        return;
+    }
+
+    // Above, below, and either side of the highlight.
+    drawRegion(x, y, surface, 0, 0, surface->width, top, color, opacity);
+    drawRegion(x, y, surface, 0, bottom, surface->width, surface->height, color, opacity);
+    drawRegion(x, y, surface, 0, top, left, bottom, color, opacity);
+    drawRegion(x, y, surface, right, top, surface->width, bottom, color, opacity);
+
+    drawRegion(x, y, surface, left, top, right, bottom, highlightColor, opacity);
+}
+
+}}
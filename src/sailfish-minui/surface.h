@@ -0,0 +1,229 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_SURFACE_H
+#define SAILFISH_MINUI_SURFACE_H
+
+#include <sailfish-minui/item.h>
+
+#include <string>
+#include <vector>
+
+namespace Sailfish { namespace MinUi {
+
+struct ClipRect
+{
+    int left;
+    int top;
+    int right;
+    int bottom;
+
+    bool isEmpty() const { return left >= right || top >= bottom; }
+
+    bool intersects(const ClipRect &rect) const
+    {
+        return left < rect.right && rect.left < right && top < rect.bottom && rect.top < bottom;
+    }
+
+    bool contains(const ClipRect &rect) const
+    {
+        return left <= rect.left && top <= rect.top && right >= rect.right && bottom >= rect.bottom;
+    }
+
+    ClipRect intersected(const ClipRect &rect) const
+    {
+        return {
+            left > rect.left ? left : rect.left,
+            top > rect.top ? top : rect.top,
+            right < rect.right ? right : rect.right,
+            bottom < rect.bottom ? bottom : rect.bottom
+        };
+    }
+};
+
+const ClipRect &clipRect();
+
+void setClipRect(const ClipRect &rect);
+
+void setDrawColor(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha);
+
+void clearWindow();
+
+void fillRect(int left, int top, int right, int bottom);
+
+void drawTextIcon(int x, int y, const GRSurface *surface);
+
+void drawText(int x, int y, const char *text, bool bold);
+
+void blitRgb(const GRSurface *source, int sourceX, int sourceY, int width, int height, int x, int y);
+
+struct AlphaMask
+{
+    enum : uint8_t {
+        Transparent = 0x00,
+        Opaque = 0x40,
+        Literal = 0x80,
+        KindMask = 0xc0,
+        MaximumRunLength = 64
+    };
+
+    int width;
+    int height;
+    size_t size;
+
+    const uint32_t *rowOffsets() const { return reinterpret_cast<const uint32_t *>(this + 1); }
+    const uint8_t *row(int index) const
+    {
+        return reinterpret_cast<const uint8_t *>(rowOffsets() + height) + rowOffsets()[index];
+    }
+};
+
+void drawAlphaMask(int x, int y, const AlphaMask *mask);
+
+AlphaMask *encodeAlphaMask(const GRSurface *surface);
+
+gr_surface decodeAlphaMask(const AlphaMask *mask);
+
+AlphaMask *stretchAlphaMask(const AlphaMask *mask, int width, int height);
+
+void freeAlphaMask(AlphaMask *mask);
+
+void blitSurface(const GRSurface *source, int sourceX, int sourceY, int width, int height, int x, int y);
+
+enum class PixelFormat
+{
+    Unknown,
+    RGBX8888,
+    BGRA8888,
+    ABGR8888,
+    RGB565
+};
+
+const char *pixelFormatName(PixelFormat format);
+
+PixelFormat nativePixelFormat();
+
+int pixelBytes(PixelFormat format);
+
+void convertPixels(GRSurface *target, PixelFormat format, const GRSurface *source, bool premultiply);
+
+bool isOpaque(const GRSurface *surface);
+
+gr_surface convertSurface(const GRSurface *source, PixelFormat format, bool premultiply);
+
+void freeSurface(gr_surface surface);
+
+gr_surface createSurface(int width, int height, int pixelBytes);
+
+gr_surface createAlphaSurface(int width, int height);
+
+gr_surface scaleSurface(const GRSurface *source, int width, int height);
+
+class MipCache
+{
+public:
+    explicit MipCache(const GRSurface *base);
+    ~MipCache();
+
+    gr_surface scaled(int width, int height);
+
+private:
+    enum {
+        MaximumLevels = 8
+    };
+
+    const GRSurface * const m_base;
+    gr_surface m_levels[MaximumLevels] = {};
+};
+
+GRSurface subSurface(const GRSurface *surface, int x, int y, int width, int height);
+
+void compositeAlpha(GRSurface *target, int x, int y, const GRSurface *source, double opacity = 1.);
+
+void compositeAlpha(GRSurface *target, int x, int y, const AlphaMask *mask, double opacity = 1.);
+
+class MaskRasterizer
+{
+public:
+    explicit MaskRasterizer(GRSurface *target);
+    ~MaskRasterizer();
+
+    void composite(int x, int y, const GRSurface *source, double opacity);
+    void composite(int x, int y, const AlphaMask *mask, double opacity);
+    void rasterize();
+
+    static MaskRasterizer *recording(const GRSurface *target);
+
+private:
+    enum {
+        MinimumBandHeight = 32
+    };
+
+    struct Command
+    {
+        GRSurface source;
+        const AlphaMask *mask;
+        int x;
+        int y;
+        double opacity;
+    };
+
+    GRSurface * const m_target;
+    MaskRasterizer * const m_previous;
+    std::vector<Command> m_commands;
+};
+
+bool compositeText(GRSurface *target, int x, int y, const std::string &text, double opacity = 1.);
+
+bool hasFontGlyphs();
+
+void drawAlphaSurface(int x, int y, const GRSurface *surface, Color color, double opacity);
+
+void drawAlphaSurface(
+        int x,
+        int y,
+        const GRSurface *surface,
+        Color color,
+        int highlightX,
+        int highlightY,
+        int highlightWidth,
+        int highlightHeight,
+        Color highlightColor,
+        double opacity);
+
+}}
+
+#endif
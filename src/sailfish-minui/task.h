@@ -0,0 +1,293 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_TASK_H
+#define SAILFISH_MINUI_TASK_H
+
+#if !defined(__cpp_impl_coroutine)
+#error "sailfish-minui/task.h requires a compiler with C++20 coroutine support"
+#endif
+
+#include <sailfish-minui/eventloop.h>
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <utility>
+
+namespace Sailfish { namespace MinUi {
+
+/*!
+    \class Sailfish::MinUi::FramePool
+    \brief A recycling allocator for coroutine frames.
+
+    Frames are rounded up to a multiple of Granularity bytes and freed frames are kept on a per
+    size free list for reuse, so a sequence which repeatedly starts the same coroutines only
+    touches the heap for its first iteration.  Frames larger than the largest size class are
+    allocated from the heap directly.
+
+    The pool is per thread, frames must be freed on the thread which allocated them.
+*/
+class FramePool
+{
+public:
+    enum {
+        Granularity = 64,
+        SizeClasses = 16
+    };
+
+    static void *allocate(std::size_t size)
+    {
+        const std::size_t index = sizeClass(size);
+        if (index < SizeClasses && s_free[index]) {
+            Block * const block = s_free[index];
+            s_free[index] = block->next;
+            return block;
+        }
+        return ::operator new(index < SizeClasses ? (index + 1) * Granularity : size);
+    }
+
+    static void deallocate(void *pointer, std::size_t size)
+    {
+        const std::size_t index = sizeClass(size);
+        if (index < SizeClasses) {
+            Block * const block = static_cast<Block *>(pointer);
+            block->next = s_free[index];
+            s_free[index] = block;
+        } else {
+            ::operator delete(pointer);
+        }
+    }
+
+private:
+    struct Block { Block *next; };
+
+    static std::size_t sizeClass(std::size_t size) { return (size + Granularity - 1) / Granularity - 1; }
+
+    static inline thread_local Block *s_free[SizeClasses] = {};
+};
+
+template <typename T = void> class Task;
+
+namespace TaskPrivate {
+
+template <typename T> auto awaiter(T &&value, int) -> decltype(awaitable(std::forward<T>(value)))
+{
+    return awaitable(std::forward<T>(value));
+}
+
+template <typename T> T &&awaiter(T &&value, long)
+{
+    return std::forward<T>(value);
+}
+
+class FinalAwaiter
+{
+public:
+    bool await_ready() noexcept { return false; }
+    template <typename Promise> std::coroutine_handle<> await_suspend(
+            std::coroutine_handle<Promise> handle) noexcept;
+    void await_resume() noexcept {}
+};
+
+class PromiseBase
+{
+public:
+    void *operator new(std::size_t size) { return FramePool::allocate(size); }
+    void operator delete(void *pointer, std::size_t size) { FramePool::deallocate(pointer, size); }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    FinalAwaiter final_suspend() noexcept { return FinalAwaiter(); }
+
+    void unhandled_exception() noexcept { std::terminate(); }
+
+    // Lets types which can't be awaited directly such as a MinDBus::PendingCall pointer provide
+    // an awaiter through an awaitable() function found by argument dependent lookup.
+    template <typename T> decltype(auto) await_transform(T &&value)
+    {
+        return awaiter(std::forward<T>(value), 0);
+    }
+
+private:
+    template <typename> friend class Sailfish::MinUi::Task;
+    friend class FinalAwaiter;
+
+    std::coroutine_handle<> m_continuation;
+    bool m_detached = false;
+};
+
+template <typename T> class Promise : public PromiseBase
+{
+public:
+    Task<T> get_return_object() noexcept;
+
+    template <typename Value> void return_value(Value &&value) { m_value = std::forward<Value>(value); }
+
+    T &&result() { return std::move(m_value); }
+
+private:
+    T m_value {};
+};
+
+template <> class Promise<void> : public PromiseBase
+{
+public:
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void result() {}
+};
+
+}
+
+/*!
+    \class Sailfish::MinUi::Task
+    \brief A coroutine which produces a result of type T.
+
+    A task is created suspended.  It may either be awaited from another coroutine, in which case
+    it runs until it completes and the awaiting coroutine is resumed with its result, or it may
+    be started with start() which hands the task over to the event loop.
+
+    Within a task \c co_await may be applied to the EventLoop::sleep() and EventLoop::readable()
+    awaitables, other tasks, and MinDBus method calls.  Coroutine frames are allocated from the
+    FramePool.
+
+    \code
+    MinUi::Task<> unlock(MinUi::EventLoop *loop, MinDBus::Object *mce)
+    {
+        auto reply = co_await mce->call<const char *>("get_display_status");
+        if (reply.isError()) {
+            co_return;
+        }
+        co_await loop->sleep(200);
+        ...
+    }
+
+    unlock(&eventLoop, &mce).start();
+    \endcode
+*/
+template <typename T> class Task
+{
+public:
+    typedef TaskPrivate::Promise<T> promise_type;
+
+    Task() = default;
+    Task(const Task &task) = delete;
+    Task(Task &&task) noexcept : m_handle(task.m_handle) { task.m_handle = nullptr; }
+    ~Task() { if (m_handle) { m_handle.destroy(); } }
+
+    Task &operator =(const Task &task) = delete;
+    Task &operator =(Task &&task) noexcept
+    {
+        std::swap(m_handle, task.m_handle);
+        return *this;
+    }
+
+    /*!
+        Returns true if the task has run to completion.
+    */
+    bool isFinished() const { return !m_handle || m_handle.done(); }
+
+    /*!
+        Schedules the task to be run by the event \a loop and releases ownership of it.
+
+        The task will be destroyed when it completes, its result is discarded.
+    */
+    void start(EventLoop *loop = EventLoop::instance())
+    {
+        if (!m_handle) {
+            return;
+        }
+
+        std::coroutine_handle<promise_type> handle = m_handle;
+        m_handle = nullptr;
+
+        handle.promise().m_detached = true;
+        loop->singleShot([handle]() {
+            handle.resume();
+        });
+    }
+
+    bool await_ready() const noexcept { return isFinished(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+    {
+        m_handle.promise().m_continuation = continuation;
+        return m_handle;
+    }
+
+    T await_resume() { return m_handle.promise().result(); }
+
+private:
+    friend class TaskPrivate::Promise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace TaskPrivate {
+
+template <typename Promise> std::coroutine_handle<> FinalAwaiter::await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept
+{
+    PromiseBase &promise = handle.promise();
+    if (promise.m_continuation) {
+        return promise.m_continuation;
+    } else if (promise.m_detached) {
+        handle.destroy();
+    }
+    return std::noop_coroutine();
+}
+
+template <typename T> Task<T> Promise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+}
+
+}}
+
+#endif
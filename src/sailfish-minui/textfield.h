@@ -54,6 +54,7 @@ public:
 
     std::string text() const { return m_input.text(); }
     void setText(const std::string &text) { m_input.setText(text); }
+    int length() const { return m_input.length(); }
     void backspace() { m_input.backspace(); }
 
     bool isBold() const { return m_input.isBold(); }
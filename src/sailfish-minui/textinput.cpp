@@ -36,9 +36,11 @@
 
 #include "textinput.h"
 #include "eventloop.h"
+#include "surface.h"
 
 #include <linux/input.h>
 
+#include <algorithm>
 #include <iostream>
 
 namespace Sailfish { namespace MinUi {
@@ -46,6 +48,12 @@ namespace Sailfish { namespace MinUi {
 /*!
   ` \class Sailfish::MinUi::TextInput
     \brief An undecorated latin text input field.
+
+    The text is held in a gap buffer with the gap at the cursor so insertions and deletions
+    at the cursor don't move the rest of the text, and the display text is kept in a parallel
+    buffer where only the characters that changed are updated.  Drawing only touches the
+    characters which fit in the input, so the cost of a key press doesn't grow with the length
+    of the text.
 */
 
 /*!
@@ -72,23 +80,61 @@ TextInput::~TextInput()
 }
 
 /*!
-    \fn Sailfish::MinUi::TextInput::text() const
-
     Returns the current \a text content of a text input.
 */
+std::string TextInput::text() const
+{
+    std::string text;
+    text.reserve(length());
+    text.append(m_buffer.begin(), m_buffer.begin() + m_gapStart);
+    text.append(m_buffer.begin() + m_gapEnd, m_buffer.end());
+    return text;
+}
 
 /*!
     Sets the \a text content of a text input.
+
+    The cursor is moved to the end of the text.
 */
 void TextInput::setText(const std::string &text)
 {
     if (int(text.length()) <= m_maximumLength) {
-        m_text = text;
+        m_buffer.assign(text.begin(), text.end());
+        m_displayBuffer.resize(m_buffer.size());
+        m_gapStart = m_buffer.size();
+        m_gapEnd = m_buffer.size();
+        m_firstVisible = 0;
+
         textChanged(Assignment);
+        updateDisplayText(0, length());
         invalidate(Draw | State);
     }
 }
 
+/*!
+    \fn int Sailfish::MinUi::TextInput::length() const
+
+    Returns the number of characters in the text.
+*/
+
+/*!
+    \fn int Sailfish::MinUi::TextInput::cursorPosition() const
+
+    Returns the position of the cursor, the number of characters before it.
+*/
+
+/*!
+    Moves the cursor to \a position.
+*/
+void TextInput::setCursorPosition(int position)
+{
+    position = std::max(0, std::min(position, length()));
+    if (m_gapStart != position) {
+        moveGap(position);
+        invalidate(Draw);
+    }
+}
+
 /*!
     \fn Sailfish::MinUi::TextInput::color() const
 
@@ -187,14 +233,52 @@ void TextInput::setRightMargin(int margin)
 }
 
 /*!
-    Removes the last character from the input text.
+    Inserts \a text at the cursor position and moves the cursor to the end of it.
+
+    The text is truncated if it would exceed the maximum length.
+*/
+void TextInput::insert(const std::string &text)
+{
+    const int count = std::min<int>(text.length(), m_maximumLength - length());
+    if (count <= 0) {
+        return;
+    }
+
+    reserveGap(count);
+
+    const int position = m_gapStart;
+    std::copy(text.begin(), text.begin() + count, m_buffer.begin() + m_gapStart);
+    m_gapStart += count;
+
+    textEdited(position, 0, count);
+    textChanged(Insertion);
+    updateDisplayText(position, count);
+    invalidate(State);
+}
+
+/*!
+    Removes the character before the cursor.
 */
 void TextInput::backspace()
 {
-    if (m_text.length() > 0) {
-        m_text.resize(m_text.length() - 1);
+    if (m_gapStart > 0) {
+        --m_gapStart;
+        textEdited(m_gapStart, 1, 0);
         textChanged(Deletion);
-        invalidate(State);
+        invalidate(Draw | State);
+    }
+}
+
+/*!
+    Removes the character after the cursor.
+*/
+void TextInput::deleteForward()
+{
+    if (m_gapEnd < int(m_buffer.size())) {
+        ++m_gapEnd;
+        textEdited(m_gapStart, 1, 0);
+        textChanged(Deletion);
+        invalidate(Draw | State);
     }
 }
 
@@ -222,11 +306,40 @@ void TextInput::onCanceled(const std::function<void()> &callback)
 }
 
 /*!
-    Transforms input \a text into a string suitable for display and returns it.
+    Returns the character displayed for the text \a character at \a position.
 */
-std::string TextInput::displayText(const std::string &text)
+char TextInput::displayCharacter(int position, char character) const
 {
-    return text;
+    (void)position;
+    return character;
+}
+
+/*!
+    Updates the display text of \a count characters from \a position.
+
+    Subclasses which change how characters are displayed should call this with the range of
+    characters affected.
+*/
+void TextInput::updateDisplayText(int position, int count)
+{
+    const int end = std::min(position + count, length());
+    for (position = std::max(0, position); position < end; ++position) {
+        const int index = bufferIndex(position);
+        m_displayBuffer[index] = displayCharacter(position, m_buffer[index]);
+    }
+    invalidate(Draw);
+}
+
+/*!
+    Notifies that \a removed characters at \a position were replaced by \a inserted characters.
+
+    This is called before textChanged() for insertions and deletions.
+*/
+void TextInput::textEdited(int position, int removed, int inserted)
+{
+    (void)position;
+    (void)removed;
+    (void)inserted;
 }
 
 /*!
@@ -241,47 +354,86 @@ void TextInput::textChanged(Reason reason)
 
 /*!
     Draws input text at the absolute position x, y, with the given accumulative \a opacity.
+
+    If the text doesn't fit it is scrolled to keep the cursor visible and the characters at a
+    clipped edge are faded out.
 */
 void TextInput::draw(int x, int y, double opacity)
 {
     const uint8_t alpha = m_color.a * opacity;
-    if (alpha != 0) {
-        const int availableWidth = width() - m_leftMargin - m_rightMargin;
-        const int characterCount = m_displayText.length();
-        const int visibleCharacterCount = availableWidth / m_fontWidth;
-        const int fadedCharacterCount = std::min(2, std::max(0, characterCount - visibleCharacterCount));
-        const int croppedCharacterCount = std::max(0, characterCount - visibleCharacterCount + fadedCharacterCount);
-
-        if (fadedCharacterCount > 0 || m_horizontalAlignment == HorizontalAlignment::Right) {
-            x += m_leftMargin + availableWidth - ((characterCount - croppedCharacterCount) * m_fontWidth);
-        } else if (m_horizontalAlignment == HorizontalAlignment::Left) {
-            x += m_leftMargin;
-        } else {
-            x += std::max(m_leftMargin, (width() - (std::min(visibleCharacterCount, characterCount) * m_fontWidth)) / 2);
+    const int availableWidth = width() - m_leftMargin - m_rightMargin;
+    const int visibleCharacterCount = availableWidth / m_fontWidth;
+    if (alpha == 0 || visibleCharacterCount <= 0) {
+        return;
+    }
+
+    const int characterCount = length();
+    const int cursor = cursorPosition();
+
+    if (characterCount <= visibleCharacterCount) {
+        m_firstVisible = 0;
+    } else {
+        m_firstVisible = std::max(0, std::min(m_firstVisible, characterCount - visibleCharacterCount));
+        if (cursor - FadedCharacterCount < m_firstVisible) {
+            m_firstVisible = std::max(0, cursor - FadedCharacterCount);
+        } else if (cursor + FadedCharacterCount > m_firstVisible + visibleCharacterCount) {
+            m_firstVisible = std::min(
+                        characterCount - visibleCharacterCount,
+                        cursor + FadedCharacterCount - visibleCharacterCount);
         }
+    }
 
-        gr_color(m_color.r, m_color.g, m_color.b, alpha);
-        gr_text(x, y, m_displayText.data() + croppedCharacterCount, m_bold);
+    const int drawnCount = std::min(visibleCharacterCount, characterCount);
+    const int leftFadedCount = m_firstVisible > 0
+            ? std::min<int>(FadedCharacterCount, drawnCount)
+            : 0;
+    const int rightFadedCount = m_firstVisible + drawnCount < characterCount
+            ? std::min<int>(FadedCharacterCount, drawnCount - leftFadedCount)
+            : 0;
+
+    if (characterCount > visibleCharacterCount || m_horizontalAlignment == HorizontalAlignment::Right) {
+        x += m_leftMargin + availableWidth - (drawnCount * m_fontWidth);
+    } else if (m_horizontalAlignment == HorizontalAlignment::Left) {
+        x += m_leftMargin;
+    } else {
+        x += std::max(m_leftMargin, (width() - (drawnCount * m_fontWidth)) / 2);
+    }
 
-        for (int i = 1; i <= fadedCharacterCount; ++i) {
-            x -= m_fontWidth;
+    m_visibleText.clear();
+    for (int i = m_firstVisible + leftFadedCount; i < m_firstVisible + drawnCount - rightFadedCount; ++i) {
+        m_visibleText.push_back(m_displayBuffer[bufferIndex(i)]);
+    }
 
-            gr_color(m_color.r, m_color.g, m_color.b, (alpha * (3 - i)) / 3);
+    setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+    drawText(x + (leftFadedCount * m_fontWidth), y, m_visibleText.c_str(), m_bold);
 
-            char fadedText[2] = "\0";
-            fadedText[0] = m_displayText[croppedCharacterCount - i];
+    for (int i = 1; i <= leftFadedCount; ++i) {
+        const char fadedText[2] = { m_displayBuffer[bufferIndex(m_firstVisible + leftFadedCount - i)], '\0' };
 
-            gr_text(x, y, fadedText, m_bold);
-        }
+        setDrawColor(m_color.r, m_color.g, m_color.b, (alpha * (3 - i)) / 3);
+        drawText(x + ((leftFadedCount - i) * m_fontWidth), y, fadedText, m_bold);
+    }
+    for (int i = 1; i <= rightFadedCount; ++i) {
+        const int position = m_firstVisible + drawnCount - rightFadedCount + i - 1;
+        const char fadedText[2] = { m_displayBuffer[bufferIndex(position)], '\0' };
+
+        setDrawColor(m_color.r, m_color.g, m_color.b, (alpha * (3 - i)) / 3);
+        drawText(x + ((position - m_firstVisible) * m_fontWidth), y, fadedText, m_bold);
+    }
+
+    // The cursor is implicit when it is at the end of the text.
+    if (cursor < characterCount && hasInputFocus()) {
+        const int cursorX = x + ((cursor - m_firstVisible) * m_fontWidth);
+        setDrawColor(m_color.r, m_color.g, m_color.b, alpha);
+        fillRect(cursorX, y, cursorX + std::max(1, m_fontWidth / 8), y + m_fontHeight);
     }
 }
 
 /*!
-    Updates the display text.
+    Notifies the parent of a change in the text.
 */
 void TextInput::updateState(bool)
 {
-    m_displayText = displayText(m_text);
     invalidate(Draw);
     invalidateParent(State);
 }
@@ -297,7 +449,7 @@ bool TextInput::keyPress(int code, const char character)
     case KEY_ENTER:
         textChanged(Accepted);
         if (m_accepted) {
-            m_accepted(m_text);
+            m_accepted(text());
         }
         return true;
     case KEY_ESC:
@@ -309,17 +461,79 @@ bool TextInput::keyPress(int code, const char character)
     case KEY_BACKSPACE:
         backspace();
         return true;
+    case KEY_DELETE:
+        deleteForward();
+        return true;
+    case KEY_LEFT:
+        setCursorPosition(cursorPosition() - 1);
+        return true;
+    case KEY_RIGHT:
+        setCursorPosition(cursorPosition() + 1);
+        return true;
+    case KEY_HOME:
+        setCursorPosition(0);
+        return true;
+    case KEY_END:
+        setCursorPosition(length());
+        return true;
     default:
-        if (character >= 0x20 && character <= 0x7e && int(m_text.length() + 1) < m_maximumLength) {
-            m_text.push_back(character);
-            textChanged(Insertion);
-            invalidate(State);
+        if (character >= 0x20 && character <= 0x7e && length() + 1 < m_maximumLength) {
+            insert(std::string(1, character));
             return true;
         }
     }
     return false;
 }
 
+/*
+    Moves the gap to \a position moving the characters between it and the current position
+    across.
+*/
+void TextInput::moveGap(int position)
+{
+    if (position < m_gapStart) {
+        const int count = m_gapStart - position;
+        std::copy_backward(m_buffer.begin() + position, m_buffer.begin() + m_gapStart, m_buffer.begin() + m_gapEnd);
+        std::copy_backward(m_displayBuffer.begin() + position, m_displayBuffer.begin() + m_gapStart, m_displayBuffer.begin() + m_gapEnd);
+        m_gapStart -= count;
+        m_gapEnd -= count;
+    } else if (position > m_gapStart) {
+        const int count = position - m_gapStart;
+        std::copy(m_buffer.begin() + m_gapEnd, m_buffer.begin() + m_gapEnd + count, m_buffer.begin() + m_gapStart);
+        std::copy(m_displayBuffer.begin() + m_gapEnd, m_displayBuffer.begin() + m_gapEnd + count, m_displayBuffer.begin() + m_gapStart);
+        m_gapStart += count;
+        m_gapEnd += count;
+    }
+}
+
+/*
+    Grows the gap so at least \a count characters can be inserted.
+*/
+void TextInput::reserveGap(int count)
+{
+    if (m_gapEnd - m_gapStart >= count) {
+        return;
+    }
+
+    const int size = m_buffer.size();
+    const int tailLength = size - m_gapEnd;
+    const int newSize = std::max(std::max(16, size * 2), (size - (m_gapEnd - m_gapStart)) + count);
+
+    m_buffer.resize(newSize);
+    m_displayBuffer.resize(newSize);
+    std::copy_backward(m_buffer.begin() + m_gapEnd, m_buffer.begin() + size, m_buffer.end());
+    std::copy_backward(m_displayBuffer.begin() + m_gapEnd, m_displayBuffer.begin() + size, m_displayBuffer.end());
+    m_gapEnd = newSize - tailLength;
+}
+
+/*
+    Returns the index in the buffers of the character at \a position.
+*/
+int TextInput::bufferIndex(int position) const
+{
+    return position < m_gapStart ? position : position + (m_gapEnd - m_gapStart);
+}
+
 /*!
     \class Sailfish::MinUi::PasswordInput
     \brief An undecorated latin password input field.
@@ -356,7 +570,6 @@ void PasswordInput::setEchoDelay(int delay)
 {
     m_echoDelay = delay;
     finishEcho();
-    invalidate(Draw | State);
 }
 
 void PasswordInput::setMaskingEnabled(bool enabled)
@@ -367,27 +580,30 @@ void PasswordInput::setMaskingEnabled(bool enabled)
 
     m_maskingEnabled = enabled;
     finishEcho();
-    invalidate(Draw | State);
+    updateDisplayText(0, length());
 }
 
 /*!
-    Masks password \a text and returns the result.
+    Returns a mask for the password \a character at \a position unless it was just entered.
 */
-std::string PasswordInput::displayText(const std::string &text)
+char PasswordInput::displayCharacter(int position, char character) const
 {
-    if (!m_maskingEnabled) {
-        return text;
-    }
+    return m_maskingEnabled && position != m_echoPosition ? '*' : character;
+}
 
-    std::string copy = text;
-    const size_t length = m_maskTimerId > 0
-            ? (text.length() > 0 ? text.length() - 1 : 0)
-            : text.length();
-    for (size_t i = 0; i < length; ++i) {
-        copy[i] = '*';
+/*!
+    Tracks the position of an echoed character as text before it is inserted or \a removed at
+    \a position.
+*/
+void PasswordInput::textEdited(int position, int removed, int inserted)
+{
+    if (m_echoPosition < position) {
+        return;
+    } else if (m_echoPosition < position + removed) {
+        m_echoPosition = -1;
+    } else {
+        m_echoPosition += inserted - removed;
     }
-
-    return copy;
 }
 
 /*!
@@ -398,9 +614,10 @@ void PasswordInput::textChanged(Reason reason)
     finishEcho();
 
     if (reason == Insertion && m_echoDelay > 0) {
+        // The display text of the inserted characters is updated after this returns.
+        m_echoPosition = cursorPosition() - 1;
         m_maskTimerId = eventLoop()->createTimer(m_echoDelay, [this]() {
             finishEcho();
-            invalidate(State);
         });
     }
 
@@ -416,6 +633,11 @@ void PasswordInput::finishEcho()
         eventLoop()->cancelTimer(m_maskTimerId);
         m_maskTimerId = 0;
     }
+    if (m_echoPosition >= 0) {
+        const int position = m_echoPosition;
+        m_echoPosition = -1;
+        updateDisplayText(position, 1);
+    }
 }
 
 }}
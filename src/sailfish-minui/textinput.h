@@ -39,6 +39,9 @@
 
 #include <sailfish-minui/item.h>
 
+#include <string>
+#include <vector>
+
 namespace Sailfish { namespace MinUi {
 
 class TextInput : public ResizeableItem
@@ -55,9 +58,14 @@ public:
     explicit TextInput(Item *parent = nullptr);
     ~TextInput();
 
-    std::string text() const { return m_text; }
+    std::string text() const;
     void setText(const std::string &text);
 
+    int length() const { return int(m_buffer.size()) - (m_gapEnd - m_gapStart); }
+
+    int cursorPosition() const { return m_gapStart; }
+    void setCursorPosition(int position);
+
     Color color() const { return m_color; }
     void setColor(Color color);
 
@@ -76,7 +84,9 @@ public:
     int rightMargin() const { return m_rightMargin; }
     void setRightMargin(int margin);
 
+    void insert(const std::string &text);
     void backspace();
+    void deleteForward();
 
     void onTextChanged(const std::function<void(TextInput::Reason reason)> &callback);
     void onAccepted(const std::function<void(const std::string &text)> &callback);
@@ -86,7 +96,9 @@ public:
     using Item::acceptsInputFocus;
 
 protected:
-    virtual std::string displayText(const std::string &text);
+    virtual char displayCharacter(int position, char character) const;
+    void updateDisplayText(int position, int count);
+    virtual void textEdited(int position, int removed, int inserted);
     virtual void textChanged(Reason reason);
 
     void draw(int dx, int dy, double opacity) override;
@@ -95,11 +107,22 @@ protected:
     bool keyPress(int code, const char character) override;
 
 private:
+    enum { FadedCharacterCount = 2 };
+
+    inline void moveGap(int position);
+    inline void reserveGap(int count);
+    inline int bufferIndex(int position) const;
+
     std::function<void(const std::string &text)> m_accepted;
     std::function<void()> m_canceled;
     std::function<void(Reason reason)> m_textChanged;
-    std::string m_text;
-    std::string m_displayText;
+    // The text and display text share a gap at the cursor position.
+    std::vector<char> m_buffer;
+    std::vector<char> m_displayBuffer;
+    std::string m_visibleText;
+    int m_gapStart = 0;
+    int m_gapEnd = 0;
+    int m_firstVisible = 0;
     Color m_color;
     int m_maximumLength = 4096;
     int m_fontWidth;
@@ -123,7 +146,8 @@ public:
     void setMaskingEnabled(bool enabled);
 
 protected:
-    std::string displayText(const std::string &text) override;
+    char displayCharacter(int position, char character) const override;
+    void textEdited(int position, int removed, int inserted) override;
     void textChanged(Reason reason) override;
 
 private:
@@ -131,6 +155,7 @@ private:
 
     int m_echoDelay = 100;
     int m_maskTimerId = 0;
+    int m_echoPosition = -1;
     bool m_maskingEnabled = true;
 };
 
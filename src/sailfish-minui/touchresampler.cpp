@@ -0,0 +1,254 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "touchresampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Sailfish { namespace MinUi {
+
+/*!
+    \class Sailfish::MinUi::TouchResampler
+    \brief Resamples touch positions to the time of a frame and predicts their movement.
+
+    Touch panels report positions at a rate unrelated to the display refresh so the latest
+    sample can be anything up to a full report interval old when a frame is drawn, and how old
+    varies from frame to frame.  A resampler installed on a window with
+    \l Window::setTouchResampler() instead positions a moved touch where it was estimated to
+    be when the window is updated for the next frame less the \l resampleLatency(),
+    interpolating between samples where possible and extrapolating from them where not.  A non-zero
+    \l predictionHorizon() extrapolates further ahead to hide some of the display latency.
+
+    Extrapolation and velocity estimates use a least squares fit of position against time over
+    the most recent samples, quadratic if there are enough samples to estimate acceleration and
+    linear otherwise.
+*/
+
+/*!
+    Constructs a touch resampler.
+*/
+TouchResampler::TouchResampler()
+{
+}
+
+/*!
+    \fn int Sailfish::MinUi::TouchResampler::resampleLatency() const
+
+    Returns the delay in milliseconds subtracted from the time a move is handled to get the
+    time positions are resampled at.
+
+    The default is 5 milliseconds, which keeps most resampled positions between real samples.
+*/
+
+/*!
+    Sets the resample \a latency in milliseconds.
+*/
+void TouchResampler::setResampleLatency(int latency)
+{
+    m_resampleLatency = std::max(0, latency);
+}
+
+/*!
+    \fn int Sailfish::MinUi::TouchResampler::predictionHorizon() const
+
+    Returns how many milliseconds ahead of the resample time touch positions are predicted.
+
+    The default is 0, no prediction.
+*/
+
+/*!
+    Sets the prediction \a horizon in milliseconds.
+*/
+void TouchResampler::setPredictionHorizon(int horizon)
+{
+    m_predictionHorizon = std::max(0, horizon);
+}
+
+/*!
+    Returns the estimated position at \a time in microseconds on the clock of the touch
+    \a history, shifted by the resample latency and prediction horizon.
+
+    Positions past the last sample are extrapolated no further than the prediction horizon
+    plus the mean interval between the recent samples, as a move is normally handled within a
+    report interval of its sample.
+*/
+TouchResampler::Point TouchResampler::resample(
+        const Window::TouchHistory &history, int64_t time) const
+{
+    Point point;
+    if (history.empty()) {
+        return point;
+    }
+
+    const Window::TouchSample &last = history.back();
+    time += (int64_t(m_predictionHorizon) - m_resampleLatency) * 1000;
+
+    if (time <= last.time) {
+        for (size_t i = history.size() - 1; i > 0; --i) {
+            const Window::TouchSample &previous = history[i - 1];
+            const Window::TouchSample &next = history[i];
+            if (previous.time <= time) {
+                const double alpha = next.time > previous.time
+                        ? double(time - previous.time) / (next.time - previous.time)
+                        : 1.;
+                point.x = int(std::lround(previous.x + (next.x - previous.x) * alpha));
+                point.y = int(std::lround(previous.y + (next.y - previous.y) * alpha));
+                return point;
+            }
+        }
+        point.x = history.front().x;
+        point.y = history.front().y;
+        return point;
+    }
+
+    const Fit fit = this->fit(history, 2);
+    const int64_t limit = (int64_t(m_predictionHorizon) * 1000) + fit.interval;
+    const double t = std::min<int64_t>(time - last.time, limit) / 1000000.;
+
+    // The fit is relative to the last sample so only the change in position is taken from it,
+    // keeping a resting touch exactly where it was reported.
+    const double dx = (fit.x[1] * t) + (fit.x[2] * t * t);
+    const double dy = (fit.y[1] * t) + (fit.y[2] * t * t);
+
+    point.x = int(std::lround(last.x + dx));
+    point.y = int(std::lround(last.y + dy));
+    return point;
+}
+
+/*!
+    Returns the estimated velocity in pixels per second at the time of the last sample of a
+    touch \a history.
+*/
+TouchResampler::Velocity TouchResampler::velocity(
+        const Window::TouchHistory &history) const
+{
+    const Fit fit = this->fit(history, 2);
+
+    Velocity velocity;
+    velocity.x = float(fit.x[1]);
+    velocity.y = float(fit.y[1]);
+    return velocity;
+}
+
+/*
+    Fits polynomials of up to \a degree to the x and y positions of the recent samples in
+    \a history against their time in seconds relative to the last sample.
+*/
+TouchResampler::Fit TouchResampler::fit(
+        const Window::TouchHistory &history, int degree) const
+{
+    Fit fit;
+    if (history.empty()) {
+        return fit;
+    }
+
+    const Window::TouchSample &last = history.back();
+
+    size_t first = history.size() - 1;
+    while (first > 0
+           && history.size() - first < FitSamples
+           && last.time - history[first - 1].time <= FitDuration) {
+        --first;
+    }
+
+    const int count = int(history.size() - first);
+    degree = std::min(degree, count - 1);
+
+    if (count > 1) {
+        fit.interval = (last.time - history[first].time) / (count - 1);
+    }
+
+    // Accumulate the normal equations for both axes at once.
+    const int size = degree + 1;
+    double matrix[3][3] = {};
+    double xVector[3] = {};
+    double yVector[3] = {};
+
+    for (size_t i = first; i < history.size(); ++i) {
+        const double t = (history[i].time - last.time) / 1000000.;
+        double powers[5] = { 1., t, t * t, t * t * t, t * t * t * t };
+        for (int row = 0; row < size; ++row) {
+            for (int column = 0; column < size; ++column) {
+                matrix[row][column] += powers[row + column];
+            }
+            xVector[row] += powers[row] * (history[i].x - last.x);
+            yVector[row] += powers[row] * (history[i].y - last.y);
+        }
+    }
+
+    // Gaussian elimination with partial pivoting, dropping to a lower degree if the samples
+    // are too close together in time to distinguish the higher order terms.
+    for (int pivot = 0; pivot < size; ++pivot) {
+        int best = pivot;
+        for (int row = pivot + 1; row < size; ++row) {
+            if (std::fabs(matrix[row][pivot]) > std::fabs(matrix[best][pivot])) {
+                best = row;
+            }
+        }
+        if (std::fabs(matrix[best][pivot]) < 1e-12) {
+            return degree > 0 ? this->fit(history, degree - 1) : fit;
+        }
+        std::swap(matrix[pivot], matrix[best]);
+        std::swap(xVector[pivot], xVector[best]);
+        std::swap(yVector[pivot], yVector[best]);
+
+        for (int row = pivot + 1; row < size; ++row) {
+            const double factor = matrix[row][pivot] / matrix[pivot][pivot];
+            for (int column = pivot; column < size; ++column) {
+                matrix[row][column] -= factor * matrix[pivot][column];
+            }
+            xVector[row] -= factor * xVector[pivot];
+            yVector[row] -= factor * yVector[pivot];
+        }
+    }
+
+    for (int row = size - 1; row >= 0; --row) {
+        double x = xVector[row];
+        double y = yVector[row];
+        for (int column = row + 1; column < size; ++column) {
+            x -= matrix[row][column] * fit.x[column];
+            y -= matrix[row][column] * fit.y[column];
+        }
+        fit.x[row] = x / matrix[row][row];
+        fit.y[row] = y / matrix[row][row];
+    }
+    fit.degree = degree;
+
+    return fit;
+}
+
+}}
@@ -0,0 +1,92 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_TOUCHRESAMPLER_H
+#define SAILFISH_MINUI_TOUCHRESAMPLER_H
+
+#include <sailfish-minui/item.h>
+
+namespace Sailfish { namespace MinUi {
+
+class TouchResampler
+{
+public:
+    struct Point
+    {
+        int x = 0;
+        int y = 0;
+    };
+
+    struct Velocity
+    {
+        float x = 0;
+        float y = 0;
+    };
+
+    TouchResampler();
+
+    int resampleLatency() const { return m_resampleLatency; }
+    void setResampleLatency(int latency);
+
+    int predictionHorizon() const { return m_predictionHorizon; }
+    void setPredictionHorizon(int horizon);
+
+    Point resample(const Window::TouchHistory &history, int64_t time) const;
+    Velocity velocity(const Window::TouchHistory &history) const;
+
+private:
+    enum {
+        FitDuration = 100000,
+        FitSamples = 20
+    };
+
+    struct Fit
+    {
+        double x[3] = {};
+        double y[3] = {};
+        int64_t interval = 0;
+        int degree = -1;
+    };
+
+    inline Fit fit(const Window::TouchHistory &history, int degree) const;
+
+    int m_resampleLatency = 5;
+    int m_predictionHorizon = 0;
+};
+
+}}
+
+#endif
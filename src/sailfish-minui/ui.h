@@ -45,6 +45,7 @@
 #include <sailfish-minui/keypad.h>
 #include <sailfish-minui/label.h>
 #include <sailfish-minui/menu.h>
+#include <sailfish-minui/ninepatch.h>
 #include <sailfish-minui/pagestack.h>
 #include <sailfish-minui/progressbar.h>
 #include <sailfish-minui/textfield.h>
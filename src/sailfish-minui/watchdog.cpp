@@ -0,0 +1,395 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "watchdog.h"
+#include "logging.h"
+
+#include <chrono>
+
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+namespace Sailfish { namespace MinUi {
+
+enum { MaximumFrames = 64 };
+
+static void *backtraceFrames[MaximumFrames];
+static std::atomic<int> backtraceFrameCount(-1);
+static std::atomic<uint64_t> backtraceSequence(0);
+static std::atomic<uint64_t> *activeSequence = nullptr;
+
+static void backtraceSignalHandler(int)
+{
+    if (activeSequence) {
+        backtraceSequence.store(activeSequence->load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    backtraceFrameCount.store(backtrace(backtraceFrames, MaximumFrames), std::memory_order_release);
+}
+
+static int backtraceSignal()
+{
+    return SIGRTMIN + 1;
+}
+
+static int64_t monotonicTime()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return (time.tv_sec * INT64_C(1000000)) + (time.tv_nsec / 1000);
+}
+
+/*!
+    \class Sailfish::MinUi::Watchdog
+    \brief Times event loop callbacks and records those which stall the event loop.
+
+    A watchdog installed on an event loop with \l EventLoop::setWatchdog() measures how long
+    each timer, single shot, notifier, input event, dispatch and window update takes.  Any
+    which take longer than the \l budget() are recorded with their kind, the timer id or
+    descriptor and the owning object, logged and passed to the \l onStall() callback.
+
+    If a single callback runs for longer than the \l hardLimit() a monitor thread interrupts
+    the event loop thread to capture a symbolised backtrace of where it is stuck, this is
+    logged immediately so there's a record even if the callback never returns and it is
+    attached to the stall when it does.  The interrupt will cut short a sleep in the stalled
+    callback.
+
+    Durations are measured in microseconds of real time regardless of the clock installed on
+    the event loop.  The watchdog must be constructed on the event loop thread.
+*/
+
+/*!
+    \enum Sailfish::MinUi::Watchdog::Kind
+
+    \value Timer A timer expired, the id is the timer id.
+    \value SingleShot A single shot callback.
+    \value Notifier A descriptor notifier, the id is the descriptor.
+    \value Input An input event, the id is the input device descriptor.
+    \value Dispatch A call to EventLoop::dispatch().
+    \value Update A window update, the owner is the window.
+    \value Terminated The handling of SIGTERM.
+*/
+
+/*!
+    Constructs a watchdog which records callbacks taking longer than \a budget milliseconds
+    and captures a backtrace of those taking longer than \a hardLimit milliseconds.
+*/
+Watchdog::Watchdog(int budget, int hardLimit)
+    : m_loopThread(pthread_self())
+    , m_sequence(0)
+    , m_startTime(0)
+    , m_activeKind(0)
+    , m_activeId(-1)
+    , m_hardLimit(int64_t(hardLimit) * 1000)
+    , m_budget(int64_t(budget) * 1000)
+{
+    // The first call to backtrace() loads the unwinder which isn't safe to do in a signal handler.
+    void *frame;
+    backtrace(&frame, 1);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = backtraceSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(backtraceSignal(), &action, nullptr);
+
+    activeSequence = &m_sequence;
+
+    m_thread = std::thread([this]() { monitor(); });
+}
+
+/*!
+    Destroys a watchdog.
+*/
+Watchdog::~Watchdog()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+
+    activeSequence = nullptr;
+}
+
+/*!
+    Sets the time in milliseconds a callback may run for before it is recorded as a stall to
+    \a budget.
+*/
+void Watchdog::setBudget(int budget)
+{
+    m_budget = int64_t(budget) * 1000;
+}
+
+/*!
+    Sets the time in milliseconds a callback may run for before a backtrace is captured to
+    \a limit.  A limit of 0 disables backtrace capture.
+*/
+void Watchdog::setHardLimit(int limit)
+{
+    m_hardLimit = int64_t(limit) * 1000;
+    m_condition.notify_all();
+}
+
+/*!
+    \fn Sailfish::MinUi::Watchdog::Statistics Sailfish::MinUi::Watchdog::statistics(Kind kind) const
+
+    Returns the number of callbacks of a \a kind that have run, how many of those stalled,
+    and their total and maximum durations in microseconds.
+*/
+
+/*!
+    \fn const std::vector<Stall> &Sailfish::MinUi::Watchdog::stalls() const
+
+    Returns the most recent stalls, oldest first.  At most 64 stalls are retained.
+*/
+
+/*!
+    Clears all recorded statistics and stalls.
+*/
+void Watchdog::clear()
+{
+    m_stalls.clear();
+    for (Statistics &statistics : m_statistics) {
+        statistics = Statistics();
+    }
+}
+
+/*!
+    Logs a summary of the statistics for each kind of callback.
+*/
+void Watchdog::logStatistics() const
+{
+    for (int kind = 0; kind < KindCount; ++kind) {
+        const Statistics &statistics = m_statistics[kind];
+        if (statistics.count > 0) {
+            log_warning("Watchdog: " << kindName(Kind(kind))
+                    << " count " << statistics.count
+                    << " stalls " << statistics.stallCount
+                    << " mean " << (statistics.totalDuration / int64_t(statistics.count)) << " us"
+                    << " max " << statistics.maximumDuration << " us");
+        }
+    }
+}
+
+/*!
+    Sets a \a callback which is invoked on the event loop thread after a stall has been
+    recorded.
+*/
+void Watchdog::onStall(const std::function<void(const Stall &stall)> &callback)
+{
+    m_stallCallback = callback;
+}
+
+/*!
+    Returns a printable name for a \a kind of callback.
+*/
+const char *Watchdog::kindName(Kind kind)
+{
+    switch (kind) {
+    case Timer: return "timer";
+    case SingleShot: return "single shot";
+    case Notifier: return "notifier";
+    case Input: return "input";
+    case Dispatch: return "dispatch";
+    case Update: return "update";
+    case Terminated: return "terminated";
+    default: return "unknown";
+    }
+}
+
+/*!
+    Marks the start of a callback of a \a kind with an \a id, \a owner and \a name.
+
+    Nested callbacks are attributed to the outermost.  This is normally called through a
+    \l Scope.
+*/
+void Watchdog::begin(Kind kind, int id, const void *owner, const char *name)
+{
+    if (m_depth++ > 0) {
+        return;
+    }
+
+    m_owner = owner;
+    m_name = name;
+    m_activeKind.store(kind, std::memory_order_relaxed);
+    m_activeId.store(id, std::memory_order_relaxed);
+    m_startTime.store(monotonicTime(), std::memory_order_relaxed);
+
+    // An odd sequence number indicates a callback is running.
+    m_sequence.fetch_add(1, std::memory_order_release);
+}
+
+/*!
+    Marks the end of the callback started by the last call to \l begin().
+*/
+void Watchdog::end()
+{
+    if (--m_depth > 0) {
+        return;
+    }
+
+    const int64_t startTime = m_startTime.load(std::memory_order_relaxed);
+    const int64_t duration = monotonicTime() - startTime;
+    const uint64_t sequence = m_sequence.fetch_add(1, std::memory_order_release);
+    const Kind kind = Kind(m_activeKind.load(std::memory_order_relaxed));
+
+    Statistics &statistics = m_statistics[kind];
+    ++statistics.count;
+    statistics.totalDuration += duration;
+    statistics.maximumDuration = std::max(statistics.maximumDuration, duration);
+
+    if (duration <= m_budget) {
+        return;
+    }
+
+    ++statistics.stallCount;
+
+    Stall stall = { kind, m_activeId.load(std::memory_order_relaxed), m_owner, m_name, startTime, duration, std::string() };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_backtraceSequence == sequence) {
+            stall.backtrace.swap(m_backtrace);
+        }
+    }
+
+    log_warning("Watchdog: " << kindName(kind)
+            << (stall.name ? " " : "") << (stall.name ? stall.name : "")
+            << " id " << stall.id
+            << " owner " << stall.owner
+            << " blocked the event loop for " << (duration / 1000) << " ms");
+
+    if (m_stalls.size() >= MaximumStalls) {
+        m_stalls.erase(m_stalls.begin());
+    }
+    m_stalls.push_back(stall);
+
+    if (m_stallCallback) {
+        m_stallCallback(m_stalls.back());
+    }
+}
+
+void Watchdog::monitor()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    uint64_t captured = 0;
+    while (!m_quit) {
+        const int64_t limit = m_hardLimit.load(std::memory_order_relaxed);
+
+        m_condition.wait_for(lock, std::chrono::microseconds(limit > 0 ? std::max<int64_t>(limit / 4, 10000) : 1000000));
+
+        const uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+        if (m_quit || limit <= 0 || !(sequence & 1) || sequence == captured) {
+            continue;
+        }
+
+        const int64_t elapsed = monotonicTime() - m_startTime.load(std::memory_order_relaxed);
+        if (elapsed < limit || m_sequence.load(std::memory_order_acquire) != sequence) {
+            continue;
+        }
+
+        captured = sequence;
+
+        const int kind = m_activeKind.load(std::memory_order_relaxed);
+        const int id = m_activeId.load(std::memory_order_relaxed);
+
+        lock.unlock();
+        std::string backtrace = captureBacktrace();
+        lock.lock();
+
+        // Discard the backtrace if the callback returned before it was captured.
+        if (!backtrace.empty() && backtraceSequence.load(std::memory_order_relaxed) == sequence) {
+            log_warning("Watchdog: " << kindName(Kind(kind)) << " id " << id
+                    << " has blocked the event loop for over " << (elapsed / 1000) << " ms\n"
+                    << backtrace.substr(0, backtrace.size() - 1));
+
+            m_backtrace.swap(backtrace);
+            m_backtraceSequence = sequence;
+        }
+    }
+}
+
+std::string Watchdog::captureBacktrace()
+{
+    backtraceFrameCount.store(-1, std::memory_order_relaxed);
+
+    if (pthread_kill(m_loopThread, backtraceSignal()) != 0) {
+        return std::string();
+    }
+
+    int count = -1;
+    for (int i = 0; i < 200 && (count = backtraceFrameCount.load(std::memory_order_acquire)) < 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (count <= 0) {
+        return std::string();
+    }
+
+    std::string backtrace;
+
+    // The first frame is the signal handler.
+    char ** const symbols = backtrace_symbols(backtraceFrames, count);
+    for (int i = 1; i < count && symbols; ++i) {
+        std::string symbol = symbols[i];
+
+        // Symbols are formatted as module(function+offset) [address].
+        const size_t begin = symbol.find('(');
+        const size_t end = symbol.find('+', begin);
+        if (begin != std::string::npos && end != std::string::npos && end > begin + 1) {
+            const std::string mangled = symbol.substr(begin + 1, end - begin - 1);
+            int status = 0;
+            if (char * const demangled = abi::__cxa_demangle(mangled.c_str(), nullptr, nullptr, &status)) {
+                symbol.replace(begin + 1, end - begin - 1, demangled);
+                free(demangled);
+            }
+        }
+
+        backtrace += "  #" + std::to_string(i - 1) + " " + symbol + "\n";
+    }
+    free(symbols);
+
+    return backtrace;
+}
+
+}}
@@ -0,0 +1,167 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_WATCHDOG_H
+#define SAILFISH_MINUI_WATCHDOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <stdint.h>
+
+namespace Sailfish { namespace MinUi {
+
+class Watchdog
+{
+public:
+    enum Kind {
+        Timer,
+        SingleShot,
+        Notifier,
+        Input,
+        Dispatch,
+        Update,
+        Terminated,
+        KindCount
+    };
+
+    struct Stall
+    {
+        Kind kind;
+        int id;
+        const void *owner;
+        const char *name;
+        int64_t time;
+        int64_t duration;
+        std::string backtrace;
+    };
+
+    struct Statistics
+    {
+        uint64_t count = 0;
+        uint64_t stallCount = 0;
+        int64_t totalDuration = 0;
+        int64_t maximumDuration = 0;
+    };
+
+    class Scope
+    {
+    public:
+        Scope(Watchdog *watchdog, Kind kind, int id = -1, const void *owner = nullptr, const char *name = nullptr)
+            : m_watchdog(watchdog)
+        {
+            if (m_watchdog) {
+                m_watchdog->begin(kind, id, owner, name);
+            }
+        }
+
+        ~Scope()
+        {
+            if (m_watchdog) {
+                m_watchdog->end();
+            }
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator =(const Scope &) = delete;
+
+    private:
+        Watchdog * const m_watchdog;
+    };
+
+    explicit Watchdog(int budget = 50, int hardLimit = 1000);
+    Watchdog(const Watchdog &) = delete;
+    ~Watchdog();
+
+    Watchdog &operator =(const Watchdog &) = delete;
+
+    int budget() const { return m_budget / 1000; }
+    void setBudget(int budget);
+
+    int hardLimit() const { return m_hardLimit / 1000; }
+    void setHardLimit(int limit);
+
+    Statistics statistics(Kind kind) const { return m_statistics[kind]; }
+    const std::vector<Stall> &stalls() const { return m_stalls; }
+    void clear();
+
+    void logStatistics() const;
+
+    void onStall(const std::function<void(const Stall &stall)> &callback);
+
+    static const char *kindName(Kind kind);
+
+    void begin(Kind kind, int id, const void *owner, const char *name);
+    void end();
+
+private:
+    enum { MaximumStalls = 64 };
+
+    inline void monitor();
+    inline std::string captureBacktrace();
+
+    std::function<void(const Stall &stall)> m_stallCallback;
+    std::vector<Stall> m_stalls;
+    Statistics m_statistics[KindCount];
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::string m_backtrace;
+    uint64_t m_backtraceSequence = 0;
+    bool m_quit = false;
+
+    const pthread_t m_loopThread;
+    std::atomic<uint64_t> m_sequence;
+    std::atomic<int64_t> m_startTime;
+    std::atomic<int> m_activeKind;
+    std::atomic<int> m_activeId;
+    std::atomic<int64_t> m_hardLimit;
+    int64_t m_budget;
+    const void *m_owner = nullptr;
+    const char *m_name = nullptr;
+    int m_depth = 0;
+};
+
+}}
+
+#endif
@@ -0,0 +1,408 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "wordpredictor.h"
+#include "wordgraph.h"
+#include "logging.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+
+namespace Sailfish { namespace MinUi {
+
+static char lower(char character)
+{
+    return character >= 'A' && character <= 'Z' ? character - 'A' + 'a' : character;
+}
+
+/*!
+    \class Sailfish::MinUi::WordGraphHeader
+    \brief The header of a compiled word graph file.
+
+    A word graph is a minimized directed acyclic word graph, a trie with identical suffix sub-trees
+    merged, written by the sailfish-minui-wordgraph-tool and memory mapped by WordPredictor.
+
+    The file is a WordGraphHeader followed by nodeCount WordGraphNodes and edgeCount WordGraphEdges
+    in native byte order.  The edges of a node are contiguous and sorted by label so they can be
+    binary searched.  Every node records the greatest weight of any word completed in or below it so
+    the most likely completions of a prefix can be found best first.
+*/
+/*!
+    \class Sailfish::MinUi::WordPredictor
+    \brief Predicts the completion of a partially entered word.
+
+    Candidates come from a word graph compiled from a word list by the
+    sailfish-minui-wordgraph-tool and memory mapped read only, so it is shared between
+    processes and paged in on demand.  The entered word is fed in a character at a time with
+    append() and backspace(), each of which follows a single edge of the graph and then
+    searches below it for the most probable completions best first.  All the state of the
+    search is allocated up front so no memory is allocated per character.
+
+    Matching is case insensitive, candidates have the case of the entered prefix followed by
+    the completion as it appears in the graph.
+*/
+
+/*!
+    Constructs a word predictor with no word graph.
+*/
+WordPredictor::WordPredictor()
+{
+}
+
+/*!
+    Destroys a word predictor.
+*/
+WordPredictor::~WordPredictor()
+{
+    unload();
+}
+
+/*!
+    Maps the word graph file at \a path.
+
+    Returns false if the file can't be mapped or isn't a valid word graph.
+*/
+bool WordPredictor::load(const char *path)
+{
+    unload();
+
+    const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        log_err("WordPredictor: failed to open " << path << " " << strerror(errno));
+        return false;
+    }
+
+    struct stat status;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size >= off_t(sizeof(WordGraphHeader))) {
+        data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+        log_err("WordPredictor: failed to map " << path);
+        return false;
+    }
+
+    const size_t size = status.st_size;
+    const WordGraphHeader * const header = static_cast<const WordGraphHeader *>(data);
+    const WordGraphNode * const nodes = reinterpret_cast<const WordGraphNode *>(header + 1);
+    const WordGraphEdge * const edges = reinterpret_cast<const WordGraphEdge *>(nodes + header->nodeCount);
+
+    bool valid = memcmp(header->magic, wordGraphMagic, sizeof(wordGraphMagic)) == 0
+            && header->version == WordGraphHeader::Version
+            && header->root < header->nodeCount
+            && header->nodeCount <= size / sizeof(WordGraphNode)
+            && header->edgeCount <= size / sizeof(WordGraphEdge)
+            && sizeof(WordGraphHeader)
+                + (size_t(header->nodeCount) * sizeof(WordGraphNode))
+                + (size_t(header->edgeCount) * sizeof(WordGraphEdge)) <= size;
+
+    // Check every index once so lookups needn't.
+    for (uint32_t i = 0; valid && i < header->nodeCount; ++i) {
+        valid = nodes[i].firstEdge <= header->edgeCount
+                && nodes[i].edgeCount <= header->edgeCount - nodes[i].firstEdge;
+    }
+    for (uint32_t i = 0; valid && i < header->edgeCount; ++i) {
+        valid = edges[i].target < header->nodeCount;
+    }
+
+    if (!valid) {
+        log_err("WordPredictor: " << path << " is not a valid word graph");
+        munmap(data, size);
+        return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_nodes = nodes;
+    m_edges = edges;
+    m_nodeCount = header->nodeCount;
+    m_root = header->root;
+
+    reset();
+
+    return true;
+}
+
+/*!
+    Unmaps the word graph.
+*/
+void WordPredictor::unload()
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_nodes = nullptr;
+    m_edges = nullptr;
+    m_nodeCount = 0;
+    m_root = NoNode;
+
+    reset();
+}
+
+/*!
+    \fn bool Sailfish::MinUi::WordPredictor::isLoaded() const
+
+    Returns true if a word graph is loaded.
+*/
+
+/*!
+    \fn int Sailfish::MinUi::WordPredictor::candidateLimit() const
+
+    Returns the maximum number of candidates produced.  The default is 3.
+*/
+
+/*!
+    Sets the maximum number of candidates produced to \a limit.
+*/
+void WordPredictor::setCandidateLimit(int limit)
+{
+    m_candidateLimit = std::max(0, std::min<int>(limit, MaximumCandidates));
+    updateCandidates();
+}
+
+/*!
+    Clears the entered word.
+*/
+void WordPredictor::reset()
+{
+    m_typedLength = 0;
+    m_prefixLength = 0;
+    m_prefix[0] = '\0';
+    m_path[0] = m_root;
+    m_candidateCount = 0;
+}
+
+/*!
+    Appends a \a character to the entered word.
+
+    Spaces and control characters end the word.
+*/
+void WordPredictor::append(char character)
+{
+    if (static_cast<unsigned char>(character) <= ' ') {
+        reset();
+        return;
+    }
+
+    ++m_typedLength;
+    if (m_typedLength > MaximumWordLength) {
+        m_candidateCount = 0;
+        return;
+    }
+
+    const uint32_t node = m_path[m_prefixLength];
+    m_prefix[m_prefixLength] = character;
+    ++m_prefixLength;
+    m_prefix[m_prefixLength] = '\0';
+    m_path[m_prefixLength] = node != NoNode ? findChild(node, lower(character)) : uint32_t(NoNode);
+
+    updateCandidates();
+}
+
+/*!
+    Removes the last character of the entered word.
+*/
+void WordPredictor::backspace()
+{
+    if (m_typedLength == 0) {
+        return;
+    }
+
+    --m_typedLength;
+    if (m_typedLength < m_prefixLength) {
+        --m_prefixLength;
+        m_prefix[m_prefixLength] = '\0';
+    }
+
+    updateCandidates();
+}
+
+/*!
+    \fn const char *Sailfish::MinUi::WordPredictor::prefix() const
+
+    Returns the entered word.
+*/
+
+/*!
+    \fn int Sailfish::MinUi::WordPredictor::candidateCount() const
+
+    Returns the number of completions of the entered word.
+*/
+
+/*!
+    \fn const char *Sailfish::MinUi::WordPredictor::candidate(int index) const
+
+    Returns the completion at \a index, the most probable first.
+*/
+
+uint32_t WordPredictor::findChild(uint32_t node, char label) const
+{
+    const WordGraphEdge * const begin = m_edges + m_nodes[node].firstEdge;
+    const WordGraphEdge * const end = begin + m_nodes[node].edgeCount;
+    const WordGraphEdge * const edge = std::lower_bound(
+                begin, end, static_cast<uint8_t>(label), [](const WordGraphEdge &edge, uint8_t label) {
+        return edge.label < label;
+    });
+
+    return edge != end && edge->label == static_cast<uint8_t>(label) ? edge->target : uint32_t(NoNode);
+}
+
+/*
+    Searches the graph below the entered word for the most probable completions.
+
+    Entries for graph nodes are prioritized by the greatest weight below them, and a node
+    which ends a word adds a word entry prioritized by that word's weight, so words are popped
+    in order of descending weight.
+*/
+void WordPredictor::updateCandidates()
+{
+    m_candidateCount = 0;
+    m_entryCount = 0;
+    m_queueLength = 0;
+
+    const uint32_t start = m_prefixLength > 0 && m_typedLength == m_prefixLength
+            ? m_path[m_prefixLength]
+            : uint32_t(NoNode);
+    if (start == NoNode || m_candidateLimit == 0) {
+        return;
+    }
+
+    pushEntry({ start, m_nodes[start].maximumWeight, -1, 0, '\0', false });
+
+    while (m_queueLength > 0 && m_candidateCount < m_candidateLimit) {
+        const int index = popEntry();
+        const SearchEntry entry = m_entries[index];
+
+        if (entry.word) {
+            char * const candidate = m_candidates[m_candidateCount++];
+            memcpy(candidate, m_prefix, m_prefixLength);
+            candidate[m_prefixLength + entry.depth] = '\0';
+
+            int position = m_prefixLength + entry.depth;
+            for (int i = entry.parent; i >= 0 && m_entries[i].parent >= 0; i = m_entries[i].parent) {
+                candidate[--position] = m_entries[i].label;
+            }
+            continue;
+        }
+
+        const WordGraphNode &node = m_nodes[entry.node];
+        if (node.weight > 0 && entry.depth > 0) {
+            pushEntry({ entry.node, node.weight, int16_t(index), entry.depth, '\0', true });
+        }
+
+        if (m_prefixLength + entry.depth < MaximumWordLength) {
+            const WordGraphEdge *edge = m_edges + node.firstEdge;
+            for (uint32_t i = 0; i < node.edgeCount; ++i, ++edge) {
+                if (!pushEntry({
+                        edge->target,
+                        m_nodes[edge->target].maximumWeight,
+                        int16_t(index),
+                        uint8_t(entry.depth + 1),
+                        char(edge->label),
+                        false })) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*
+    Returns true if the entry at queue position \a left should be popped before \a right,
+    the heavier first and the first pushed if equal.
+*/
+bool WordPredictor::higherPriority(int left, int right) const
+{
+    const SearchEntry &leftEntry = m_entries[m_queue[left]];
+    const SearchEntry &rightEntry = m_entries[m_queue[right]];
+    return leftEntry.weight != rightEntry.weight
+            ? leftEntry.weight > rightEntry.weight
+            : m_queue[left] < m_queue[right];
+}
+
+bool WordPredictor::pushEntry(const SearchEntry &entry)
+{
+    if (m_entryCount == SearchCapacity) {
+        return false;
+    }
+
+    m_entries[m_entryCount] = entry;
+
+    int position = m_queueLength++;
+    m_queue[position] = m_entryCount++;
+    while (position > 0 && higherPriority(position, (position - 1) / 2)) {
+        std::swap(m_queue[position], m_queue[(position - 1) / 2]);
+        position = (position - 1) / 2;
+    }
+    return true;
+}
+
+int WordPredictor::popEntry()
+{
+    const int index = m_queue[0];
+    m_queue[0] = m_queue[--m_queueLength];
+
+    for (int position = 0;;) {
+        const int left = (2 * position) + 1;
+        const int right = left + 1;
+        int highest = position;
+        if (left < m_queueLength && higherPriority(left, highest)) {
+            highest = left;
+        }
+        if (right < m_queueLength && higherPriority(right, highest)) {
+            highest = right;
+        }
+        if (highest == position) {
+            break;
+        }
+        std::swap(m_queue[position], m_queue[highest]);
+        position = highest;
+    }
+    return index;
+}
+
+}}
@@ -0,0 +1,124 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#ifndef SAILFISH_MINUI_WORDPREDICTOR_H
+#define SAILFISH_MINUI_WORDPREDICTOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace Sailfish { namespace MinUi {
+
+struct WordGraphEdge;
+struct WordGraphNode;
+
+class WordPredictor
+{
+public:
+    enum {
+        MaximumWordLength = 48,
+        MaximumCandidates = 8
+    };
+
+    WordPredictor();
+    ~WordPredictor();
+
+    WordPredictor(const WordPredictor &) = delete;
+    WordPredictor &operator =(const WordPredictor &) = delete;
+
+    bool load(const char *path);
+    void unload();
+    bool isLoaded() const { return m_nodes; }
+
+    int candidateLimit() const { return m_candidateLimit; }
+    void setCandidateLimit(int limit);
+
+    void reset();
+    void append(char character);
+    void backspace();
+
+    const char *prefix() const { return m_prefix; }
+    int prefixLength() const { return m_prefixLength; }
+
+    int candidateCount() const { return m_candidateCount; }
+    const char *candidate(int index) const { return m_candidates[index]; }
+
+private:
+    enum {
+        SearchCapacity = 1024,
+        NoNode = 0xffffffff
+    };
+
+    struct SearchEntry
+    {
+        uint32_t node;
+        uint32_t weight;
+        int16_t parent;
+        uint8_t depth;
+        char label;
+        bool word;
+    };
+
+    inline uint32_t findChild(uint32_t node, char label) const;
+    inline void updateCandidates();
+    inline bool pushEntry(const SearchEntry &entry);
+    inline int popEntry();
+    inline bool higherPriority(int left, int right) const;
+
+    void *m_data = nullptr;
+    size_t m_size = 0;
+    const WordGraphNode *m_nodes = nullptr;
+    const WordGraphEdge *m_edges = nullptr;
+    uint32_t m_nodeCount = 0;
+    uint32_t m_root = NoNode;
+
+    int m_candidateLimit = 3;
+    int m_candidateCount = 0;
+    int m_prefixLength = 0;
+    int m_typedLength = 0;
+    char m_prefix[MaximumWordLength + 1] = {};
+    uint32_t m_path[MaximumWordLength + 1] = {};
+    char m_candidates[MaximumCandidates][MaximumWordLength + 1] = {};
+
+    SearchEntry m_entries[SearchCapacity];
+    int16_t m_queue[SearchCapacity];
+    int m_entryCount = 0;
+    int m_queueLength = 0;
+};
+
+}}
+
+#endif
@@ -0,0 +1,147 @@
+/****************************************************************************************
+** Copyright (c) 2026 Jolla Ltd.
+**
+** All rights reserved.
+**
+** This file is part of Sailfish Minui package.
+**
+** You may use this file under the terms of BSD license as follows:
+**
+** Redistribution and use in source and binary forms, with or without
+** modification, are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+**    list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice,
+**    this list of conditions and the following disclaimer in the documentation
+**    and/or other materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its
+**    contributors may be used to endorse or promote products derived from
+**    this software without specific prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+** AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+** IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+** DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+** FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+** DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+** SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+** CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+** OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+** OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+**
+****************************************************************************************/
+
+#include "workerpool.h"
+
+#include <algorithm>
+
+namespace Sailfish { namespace MinUi {
+
+/*!
+    \class Sailfish::MinUi::WorkerPool
+    \brief A pool of threads for splitting CPU bound work across cores.
+
+    The pool is started on first use with a thread for each core but the first, and the thread
+    calling run() does a share of the work too.
+*/
+/*
+    Returns the worker pool, starting it if it hasn't been used before.
+*/
+WorkerPool *WorkerPool::instance()
+{
+    static WorkerPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return &pool;
+}
+
+WorkerPool::WorkerPool(int threads)
+{
+    m_threads.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        m_threads.emplace_back([this]() { work(); });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_condition.notify_all();
+
+    for (std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+/*
+    Calls \a job with every index from 0 to \a count - 1, spread across the pool's threads, and
+    returns when all the calls have returned.
+
+    The order the indices are run in and the thread they're run on is unspecified.
+*/
+void WorkerPool::run(int count, const std::function<void(int index)> &job)
+{
+    if (count <= 0) {
+        return;
+    } else if (count == 1 || m_threads.empty()) {
+        for (int i = 0; i < count; ++i) {
+            job(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    m_job = &job;
+    m_count = count;
+    m_next = 0;
+    m_remaining = count;
+    m_condition.notify_all();
+
+    while (runNext(lock)) {
+    }
+
+    m_finished.wait(lock, [this]() { return m_remaining == 0; });
+    m_job = nullptr;
+}
+
+/*
+    Runs the next index of the current job, returning false if none remain.
+*/
+bool WorkerPool::runNext(std::unique_lock<std::mutex> &lock)
+{
+    if (!m_job || m_next >= m_count) {
+        return false;
+    }
+
+    const std::function<void(int index)> &job = *m_job;
+    const int index = m_next++;
+
+    lock.unlock();
+    job(index);
+    lock.lock();
+
+    if (--m_remaining == 0) {
+        m_finished.notify_all();
+    }
+    return true;
+}
+
+void WorkerPool::work()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_condition.wait(lock, [this]() { return m_quit || (m_job && m_next < m_count); });
+        if (m_quit) {
+            return;
+        }
+        runNext(lock);
+    }
+}
+
+} }
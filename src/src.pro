@@ -4,8 +4,10 @@ SUBDIRS += \
     gallery \
     sailfish-mindbus \
     sailfish-minui \
+    sailfish-minui-blit-benchmark \
     sailfish-minui-dbus \
-    sailfish-minui-label-tool
+    sailfish-minui-label-tool \
+    sailfish-minui-wordgraph-tool
 
 gallery.depends = \
     sailfish-minui \
@@ -14,5 +16,11 @@ gallery.depends = \
 sailfish-minu.depends = \
     sailfish-minui-label-tool
 
+sailfish-minui-blit-benchmark.depends = \
+    sailfish-minui
+
 sailfish-minui-dbus.depends = \
     sailfish-mindbus sailfish-minui
+
+sailfish-minui-wordgraph-tool.depends = \
+    sailfish-minui